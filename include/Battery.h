@@ -0,0 +1,44 @@
+#pragma once
+
+// Mesure de la batterie : plusieurs lectures de l'ADC dont les valeurs aberrantes
+// sont écartées, pourcentage lu dans une table de décharge calculée à la
+// compilation, et tensions des derniers jours pour prévoir l'autonomie restante.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stdint.h>
+#include <time.h>
+
+#define BATTERY_SAMPLES 16
+#define BATTERY_HISTORY_VERSION 1
+#define BATTERY_HISTORY_SIZE 14
+
+struct BatteryStatus
+{
+  int millivolts; // 0 si la lecture est invalide (alimentation USB sans batterie)
+  int percentage;
+  int daysLeft;   // prévision, -1 si inconnue
+};
+
+// Tension moyenne des lectures brutes proches de leur médiane. raw est trié.
+int batteryMillivolts(int *raw, int count);
+int batteryPercentage(int millivolts);
+
+// Une tension par jour environ, conservée en mémoire RTC
+struct BatteryHistory
+{
+  uint16_t version;
+  uint8_t count; // mesures enregistrées, au plus BATTERY_HISTORY_SIZE
+  uint8_t next;  // emplacement de la prochaine mesure
+  uint32_t times[BATTERY_HISTORY_SIZE];
+  uint16_t millivolts[BATTERY_HISTORY_SIZE];
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+// Enregistre la mesure si la précédente date d'environ un jour. Une tension
+// nettement plus haute (recharge, batterie changée) repart d'un historique vide.
+// true si la mesure a été enregistrée.
+bool batteryHistoryAdd(BatteryHistory &history, time_t now, int millivolts);
+
+// Jours avant batterie vide selon la pente de décharge des derniers jours, -1
+// tant qu'elle n'est pas mesurable
+int batteryForecastDays(const BatteryHistory &history);
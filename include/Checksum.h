@@ -0,0 +1,37 @@
+#pragma once
+
+// FNV-1a 32 bits : suffisant pour détecter une mémoire RTC corrompue
+// ou un contenu d'écran identique d'un réveil à l'autre. CRC-32 pour ce qui
+// est relu hors de la carte (journal d'événements), vérifiable avec zlib.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FNV1A_INIT 2166136261u
+
+inline uint32_t fnv1a(const void *data, size_t length, uint32_t hash = FNV1A_INIT)
+{
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < length; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// CRC-32 IEEE 802.3, le même que zlib.crc32
+inline uint32_t crc32(const void *data, size_t length)
+{
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < length; i++)
+  {
+    crc ^= bytes[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Dérive de l'horloge RTC apprise d'une synchro NTP à l'autre.
+// L'heure est corrigée à chaque réveil et le NTP n'est refait que lorsque
+// l'erreur estimée dépasse un seuil ou que la dernière synchro est trop ancienne.
+
+#include <stdint.h>
+#include <time.h>
+
+#define CLOCK_DRIFT_VERSION 1
+
+struct ClockDrift
+{
+  uint16_t version;
+  uint8_t samples;       // mesures de dérive effectuées
+  time_t lastSync;       // heure NTP de la dernière synchro
+  time_t lastCorrection; // heure corrigée lors de la dernière correction
+  float driftPpm;        // > 0 : l'horloge RTC avance
+  float uncertaintyPpm;  // erreur de l'estimation constatée à la dernière synchro
+  float pendingSeconds;  // fraction de correction pas encore appliquée
+  uint32_t checksum;     // doit rester le dernier champ
+};
+
+bool clockDriftIsValid(const ClockDrift &drift);
+
+// Secondes à ajouter à l'horloge RTC pour compenser la dérive depuis la dernière correction
+long clockDriftCorrection(ClockDrift &drift, time_t rtcNow);
+
+// Erreur estimée en secondes, très grande tant que la dérive n'a pas été mesurée
+float clockDriftPredictedError(const ClockDrift &drift, time_t now);
+bool clockDriftNeedsSync(const ClockDrift &drift, time_t now, long maxErrorSeconds, long maxAgeSeconds);
+
+// Durée à programmer sur le timer RTC pour dormir realSeconds secondes réelles
+uint64_t clockDriftSleepSeconds(const ClockDrift &drift, uint64_t realSeconds);
+
+// expected : heure RTC (corrigée) attendue au moment où l'heure NTP a été lue
+void clockDriftOnSync(ClockDrift &drift, time_t expected, time_t ntpTime);
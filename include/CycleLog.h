@@ -0,0 +1,79 @@
+#pragma once
+
+// Journal des derniers réveils conservé en mémoire RTC : durée de chaque phase,
+// tas et pile, octets reçus, source des couleurs, issues du WiFi, du NTP et des
+// appels, sommeil choisi et tension batterie, pour savoir où passent les
+// millisecondes éveillées. Chaque réveil validé est aussi résumé en flash (EventLog.h).
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stdint.h>
+#include <time.h>
+
+#define CYCLE_LOG_VERSION 7
+#define CYCLE_LOG_SIZE 16
+#define CYCLE_HTTP_CODES 4    // premiers codes d'erreur de la source interrogée en dernier
+#define CYCLE_WIFI_FAILED 0xFF
+
+enum CyclePhase
+{
+  CYCLE_BOOT,         // du reset à l'entrée dans runWakeCycle
+  CYCLE_ADC,
+  CYCLE_PANEL_INIT,
+  CYCLE_WIFI,
+  CYCLE_NTP,
+  CYCLE_API,
+  CYCLE_RENDER,
+  CYCLE_PANEL_UPDATE,
+  CYCLE_SLEEP,        // choix du réveil suivant jusqu'au deep sleep
+  CYCLE_PHASE_COUNT
+};
+
+extern const char *cyclePhaseNames[CYCLE_PHASE_COUNT];
+
+enum CycleNtp
+{
+  CYCLE_NTP_NONE,    // réveil sans WiFi
+  CYCLE_NTP_SKIPPED, // heure RTC suffisante
+  CYCLE_NTP_SYNCED,
+  CYCLE_NTP_FAILED,  // heure RTC utilisée si elle est plausible
+};
+
+struct CycleRecord
+{
+  uint32_t wakeTime;                      // heure du réveil, 0 si inconnue
+  uint16_t phaseMs[CYCLE_PHASE_COUNT];
+  uint16_t parkedMs;                      // part de panel_update passée en sommeil léger
+  uint16_t batteryMv;
+  uint32_t freeHeap;                      // en fin de cycle
+  uint32_t minFreeHeap;                   // plus bas niveau du cycle
+  uint16_t stackFree;                     // pile jamais utilisée pendant le cycle
+  uint32_t apiBytes;                      // corps de réponse reçus de l'API ou du hub
+  uint32_t sleepSeconds;                  // deep sleep programmé, dérive corrigée
+  int16_t httpCodes[CYCLE_HTTP_CODES];    // errorCodes du dernier appel, 0 sans appel
+  uint8_t wifi;                           // ConnectPath + 1, 0 sans WiFi, CYCLE_WIFI_FAILED
+  uint8_t ntp;                            // CycleNtp
+  uint8_t failures;                       // échecs consécutifs en fin de cycle
+  uint8_t wakeCause;                      // WakeCause de ce réveil
+  uint8_t nextWake;                       // WakeReason du réveil suivant
+  uint8_t source;                         // TempoSource des couleurs affichées
+};
+
+struct CycleLog
+{
+  uint16_t version;
+  uint8_t next;  // emplacement du réveil en cours
+  uint8_t count; // réveils enregistrés, au plus CYCLE_LOG_SIZE
+  CycleRecord records[CYCLE_LOG_SIZE];
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+// Remet le journal à zéro s'il est corrompu et prépare l'emplacement du réveil en cours
+CycleRecord &cycleLogBegin(CycleLog &log);
+// Valide le réveil en cours, qui devient le plus récent
+void cycleLogCommit(CycleLog &log);
+// Réveil validé le plus récent, nullptr si aucun. Utilisable pendant le réveil en cours.
+const CycleRecord *cycleLogLast(const CycleLog &log);
+unsigned long cycleRecordTotalMs(const CycleRecord &record);
+
+// Ligne CSV i (0 : en-tête, puis du plus ancien au plus récent), false au-delà
+bool cycleLogCsvLine(const CycleLog &log, int index, char *buffer, int size);
@@ -0,0 +1,74 @@
+#pragma once
+
+// Journal d'événements en flash : un enregistrement de taille fixe par réveil,
+// ajouté au bout du fichier courant, jamais réécrit. Quand le fichier courant est
+// plein, le plus ancien est effacé et prend sa suite : la place occupée reste
+// bornée et un seul fichier est effacé à la fois. LittleFS répartit déjà l'usure
+// sur les blocs de la partition. Chaque enregistrement porte un numéro de
+// séquence et un CRC-32 : celui qu'une coupure d'alimentation a tronqué est ignoré.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CycleLog.h"
+#include "Hal.h"
+
+#define EVENT_RECORD_VERSION 1
+#define EVENT_RECORD_SIZE 40
+#define EVENT_LOG_FILES 8
+#define EVENT_FILE_RECORDS 128 // 5 Ko par fichier, les 896 à 1024 derniers réveils
+#define EVENT_HEX_LEN (3 + 2 * EVENT_RECORD_SIZE + 1) // "ev " puis les octets en hexadécimal
+
+// Octets dans l'ordre de la mémoire de l'ESP32 (petit-boutiste), décodés tels
+// quels par tools/event_log.py
+struct EventRecord
+{
+  uint32_t sequence;  // croissant depuis la création du journal
+  uint32_t wakeTime;  // heure du réveil, 0 si inconnue
+  uint32_t apiBytes;
+  uint32_t sleepSeconds;
+  int16_t httpCodes[CYCLE_HTTP_CODES];
+  uint16_t awakeMs;
+  uint16_t batteryMv;
+  uint8_t version;
+  uint8_t wakeCause;  // WakeCause
+  uint8_t failures;   // counterRetry en fin de réveil
+  uint8_t ntp;        // CycleNtp
+  uint8_t wifi;       // ConnectPath + 1, 0 sans WiFi, CYCLE_WIFI_FAILED
+  uint8_t source;     // TempoSource
+  uint8_t nextWake;   // WakeReason
+  uint8_t reserved;
+  uint32_t crc;       // CRC-32 des octets qui précèdent
+};
+
+static_assert(sizeof(EventRecord) == EVENT_RECORD_SIZE, "format du journal en flash");
+
+// Position d'écriture gardée en mémoire RTC, vérifiée contre la taille du fichier
+struct EventCursor
+{
+  uint32_t sequence; // du prochain enregistrement
+  uint16_t count;    // enregistrements déjà dans le fichier courant
+  uint8_t file;
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+// Lecture du plus ancien enregistrement au plus récent
+struct EventLogReader
+{
+  int remaining;   // fichiers encore à lire
+  int file;
+  size_t index;    // prochain enregistrement du fichier
+  size_t count;    // enregistrements complets du fichier
+  int skipped;     // enregistrements au CRC faux
+};
+
+void eventRecordFromCycle(EventRecord &event, const CycleRecord &record);
+// Numérote l'enregistrement, calcule son CRC et l'ajoute. Après une perte de la
+// mémoire RTC, la position est retrouvée dans les fichiers.
+bool eventLogAppend(LogFiles &files, EventCursor &cursor, EventRecord &event);
+void eventLogRewind(LogFiles &files, EventCursor &cursor, EventLogReader &reader);
+// false une fois le plus récent lu
+bool eventLogNext(LogFiles &files, EventLogReader &reader, EventRecord &event);
+// "ev 0a000000..." : la ligne envoyée sur le port série
+void eventRecordHex(const EventRecord &event, char *buffer, size_t size);
@@ -0,0 +1,38 @@
+#pragma once
+
+// Comparaison de deux images 1 bit (format GFXcanvas1 : lignes de (w+7)/8 octets,
+// bit de poids fort à gauche) et choix du type de rafraîchissement e-ink.
+
+#include <stdint.h>
+
+#define FRAME_MAX_RECTS 4
+
+struct FrameRect
+{
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+};
+
+enum RefreshKind
+{
+  REFRESH_NONE,    // image identique : l'écran garde son contenu
+  REFRESH_PARTIAL, // uniquement les rectangles modifiés
+  REFRESH_FULL,    // rafraîchissement complet, efface les fantômes
+};
+
+// Ce qui doit survivre au deep sleep pour décider du prochain rafraîchissement
+struct RefreshMemory
+{
+  bool frameValid;        // l'image précédente correspond à l'écran
+  uint16_t partialCount;  // rafraîchissements partiels depuis le dernier complet
+};
+
+// Retourne le nombre de rectangles (au plus maxRects), alignés sur 8 pixels en x
+int frameDiff(const uint8_t *previous, const uint8_t *current, int width, int height,
+              FrameRect *rects, int maxRects);
+
+RefreshKind chooseRefresh(const RefreshMemory &memory, const FrameRect *rects, int count,
+                          int width, int height, int fullRefreshEvery);
+void recordRefresh(RefreshMemory &memory, RefreshKind kind);
@@ -0,0 +1,227 @@
+#pragma once
+
+// Tracé 1 bit au format GFXcanvas1 (voir FrameDiff.h), utilisable à la compilation.
+// Lignes, cercles et rectangles arrondis suivent les algorithmes d'Adafruit_GFX :
+// une image calculée ici est identique au pixel près à celle du canvas.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stdint.h>
+
+#define FRAME_WIDTH 250
+#define FRAME_HEIGHT 122
+#define FRAME_ROW_BYTES ((FRAME_WIDTH + 7) / 8)
+#define FRAME_BYTES (FRAME_ROW_BYTES * FRAME_HEIGHT)
+
+struct FrameBitmap
+{
+  uint8_t bytes[FRAME_BYTES];
+};
+
+// Opérations d'écriture, pour comparer les façons de dessiner une image
+struct RasterOps
+{
+  unsigned long pixels; // pixels écrits un par un
+  unsigned long spans;  // segments horizontaux écrits octet par octet
+  unsigned long bytes;  // octets copiés ou remplis en bloc
+};
+
+// Trace en noir (bit à 0) sur un fond blanc (bit à 1), hors cadre ignoré
+class FrameRaster
+{
+public:
+  constexpr explicit FrameRaster(uint8_t *buffer) : buffer(buffer) {}
+
+  constexpr void clear()
+  {
+    for (int i = 0; i < FRAME_BYTES; i++)
+    {
+      buffer[i] = 0xFF;
+    }
+    ops.bytes += FRAME_BYTES;
+  }
+
+  constexpr void copy(const FrameBitmap &bitmap)
+  {
+    for (int i = 0; i < FRAME_BYTES; i++)
+    {
+      buffer[i] = bitmap.bytes[i];
+    }
+    ops.bytes += FRAME_BYTES;
+  }
+
+  constexpr void pixel(int x, int y)
+  {
+    if (x < 0 || y < 0 || x >= FRAME_WIDTH || y >= FRAME_HEIGHT)
+    {
+      return;
+    }
+    buffer[y * FRAME_ROW_BYTES + x / 8] &= (uint8_t)~(0x80 >> (x & 7));
+    ops.pixels++;
+  }
+
+  // Adafruit_GFX::drawLine, extrémités comprises
+  constexpr void line(int x0, int y0, int x1, int y1)
+  {
+    bool steep = distance(y0, y1) > distance(x0, x1);
+    if (steep)
+    {
+      swap(x0, y0);
+      swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+      swap(x0, x1);
+      swap(y0, y1);
+    }
+    int dx = x1 - x0;
+    int dy = distance(y0, y1);
+    int err = dx / 2;
+    int ystep = y0 < y1 ? 1 : -1;
+    for (; x0 <= x1; x0++)
+    {
+      if (steep)
+      {
+        pixel(y0, x0);
+      }
+      else
+      {
+        pixel(x0, y0);
+      }
+      err -= dy;
+      if (err < 0)
+      {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+
+  // Adafruit_GFX::drawCircle
+  constexpr void circle(int x0, int y0, int r)
+  {
+    int f = 1 - r;
+    int ddFx = 1;
+    int ddFy = -2 * r;
+    int x = 0;
+    int y = r;
+    pixel(x0, y0 + r);
+    pixel(x0, y0 - r);
+    pixel(x0 + r, y0);
+    pixel(x0 - r, y0);
+    while (x < y)
+    {
+      if (f >= 0)
+      {
+        y--;
+        ddFy += 2;
+        f += ddFy;
+      }
+      x++;
+      ddFx += 2;
+      f += ddFx;
+      pixel(x0 + x, y0 + y);
+      pixel(x0 - x, y0 + y);
+      pixel(x0 + x, y0 - y);
+      pixel(x0 - x, y0 - y);
+      pixel(x0 + y, y0 + x);
+      pixel(x0 - y, y0 + x);
+      pixel(x0 + y, y0 - x);
+      pixel(x0 - y, y0 - x);
+    }
+  }
+
+  // Adafruit_GFX::drawRoundRect
+  constexpr void roundRect(int x, int y, int w, int h, int r)
+  {
+    int maxRadius = (w < h ? w : h) / 2;
+    if (r > maxRadius)
+    {
+      r = maxRadius;
+    }
+    line(x + r, y, x + w - r - 1, y);
+    line(x + r, y + h - 1, x + w - r - 1, y + h - 1);
+    line(x, y + r, x, y + h - r - 1);
+    line(x + w - 1, y + r, x + w - 1, y + h - r - 1);
+    corners(x + r, y + r, r, 1);
+    corners(x + w - r - 1, y + r, r, 2);
+    corners(x + w - r - 1, y + h - r - 1, r, 4);
+    corners(x + r, y + h - r - 1, r, 8);
+  }
+
+  // Rectangle plein, une ligne d'octets masqués par rangée
+  constexpr void fillRect(int x, int y, int w, int h)
+  {
+    int x1 = x + w < FRAME_WIDTH ? x + w : FRAME_WIDTH;
+    int y1 = y + h < FRAME_HEIGHT ? y + h : FRAME_HEIGHT;
+    x = x < 0 ? 0 : x;
+    y = y < 0 ? 0 : y;
+    for (; y < y1 && x < x1; y++)
+    {
+      uint8_t *row = buffer + y * FRAME_ROW_BYTES;
+      for (int byte = x / 8; byte <= (x1 - 1) / 8; byte++)
+      {
+        int from = byte * 8 > x ? 0 : x - byte * 8;
+        int to = byte * 8 + 8 < x1 ? 8 : x1 - byte * 8;
+        row[byte] &= (uint8_t)~((0xFF >> from) & (0xFF << (8 - to)));
+      }
+      ops.spans++;
+    }
+  }
+
+  RasterOps ops = {};
+
+private:
+  static constexpr int distance(int a, int b) { return a > b ? a - b : b - a; }
+
+  static constexpr void swap(int &a, int &b)
+  {
+    int t = a;
+    a = b;
+    b = t;
+  }
+
+  // Adafruit_GFX::drawCircleHelper : quarts de cercle 1 haut gauche, 2 haut droit,
+  // 4 bas droit, 8 bas gauche
+  constexpr void corners(int x0, int y0, int r, int corner)
+  {
+    int f = 1 - r;
+    int ddFx = 1;
+    int ddFy = -2 * r;
+    int x = 0;
+    int y = r;
+    while (x < y)
+    {
+      if (f >= 0)
+      {
+        y--;
+        ddFy += 2;
+        f += ddFy;
+      }
+      x++;
+      ddFx += 2;
+      f += ddFx;
+      if (corner & 0x4)
+      {
+        pixel(x0 + x, y0 + y);
+        pixel(x0 + y, y0 + x);
+      }
+      if (corner & 0x2)
+      {
+        pixel(x0 + x, y0 - y);
+        pixel(x0 + y, y0 - x);
+      }
+      if (corner & 0x8)
+      {
+        pixel(x0 - y, y0 + x);
+        pixel(x0 - x, y0 + y);
+      }
+      if (corner & 0x1)
+      {
+        pixel(x0 - y, y0 - x);
+        pixel(x0 - x, y0 - y);
+      }
+    }
+  }
+
+  uint8_t *buffer;
+};
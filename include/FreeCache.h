@@ -0,0 +1,54 @@
+#pragma once
+
+// API sans inscription : validateurs HTTP (ETag, Last-Modified) et valeurs lues
+// dans la dernière réponse de chaque requête, gardés en mémoire RTC. Le réveil
+// suivant les présente (If-None-Match, If-Modified-Since) : une réponse 304 n'a
+// pas de corps et les valeurs gardées sont reprises telles quelles. Quand le
+// serveur ne donne aucun validateur, l'empreinte du corps dit seulement s'il a changé.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stdint.h>
+
+#include "Hal.h"
+#include "RteCalendar.h"
+
+#define FREE_CACHE_VERSION 1
+#define FREE_ETAG_LEN 64
+#define FREE_DATE_LEN 32  // "Wed, 21 Oct 2015 07:28:00 GMT"
+#define FREE_QUERY_LEN 16 // paramètre de la requête, ex. "2025-2026"
+
+enum FreeEndpoint
+{
+  FREE_ENDPOINT_DAYS,   // couleurs d'aujourd'hui et de demain
+  FREE_ENDPOINT_SEASON, // tous les jours de la saison, pour les compteurs
+  FREE_ENDPOINT_COUNT
+};
+
+struct FreeEntry
+{
+  char query[FREE_QUERY_LEN]; // les validateurs ne valent que pour ce paramètre
+  char etag[FREE_ETAG_LEN];   // vide si le serveur n'en a pas donné
+  char lastModified[FREE_DATE_LEN];
+  uint32_t bodyHash;          // fnv1a du corps
+  FreeCalendar calendar;      // days == 0 : emplacement vide
+};
+
+struct FreeCache
+{
+  uint16_t version;
+  FreeEntry entries[FREE_ENDPOINT_COUNT];
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+// Dernière réponse de l'endpoint pour ce paramètre, nullptr si aucune
+const FreeEntry *freeCacheFind(const FreeCache &cache, FreeEndpoint endpoint, const char *query);
+// etag et lastModified trop longs sont ignorés : seule l'empreinte reste
+void freeCacheStore(FreeCache &cache, FreeEndpoint endpoint, const char *query, const char *etag,
+                    const char *lastModified, uint32_t bodyHash, const FreeCalendar &calendar);
+void freeCacheForget(FreeCache &cache);
+
+// Couleurs d'aujourd'hui et de demain (notAvailable si absentes), compteurs jusqu'à
+// demain s'il est connu, sinon jusqu'à aujourd'hui, comme ceux de l'API avec compte.
+// false si la couleur du jour ou les compteurs manquent.
+bool freeCalendarResolve(const FreeCalendar &days, const FreeCalendar &season, int todayYmd, int tomorrowYmd,
+                         const char *notAvailable, TempoResult &result);
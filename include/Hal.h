@@ -0,0 +1,212 @@
+#pragma once
+
+// Interfaces étroites autour du matériel utilisé par le cycle de réveil.
+// Implémentations ESP32 dans src/esp32, implémentations factices dans src/native.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "TempoState.h"
+#include "TimeSnapshot.h"
+
+enum WakeCause
+{
+  WAKE_CAUSE_POWER_ON, // mise sous tension ou reset : mémoire RTC remise à zéro
+  WAKE_CAUSE_TIMER,    // réveil programmé
+  WAKE_CAUSE_BUTTON,   // appui sur le bouton pendant le deep sleep
+};
+
+class Board
+{
+public:
+  virtual ~Board() {}
+  virtual unsigned long millis() = 0;
+  virtual uint64_t micros() = 0; // depuis le reset, pour chronométrer les phases
+  virtual void delay(unsigned long ms) = 0;
+  virtual int readBatteryRaw() = 0; // analogRead(PIN_BAT)
+  virtual uint32_t freeHeap() = 0;
+  // Plus bas niveau de tas libre depuis le reset, donc sur le réveil en cours
+  virtual uint32_t minFreeHeap() = 0;
+  // Octets de pile jamais utilisés par la tâche qui exécute le réveil
+  virtual uint32_t stackFree() = 0;
+  virtual uint32_t random32() = 0; // gigue des nouveaux essais
+  virtual void log(const char *message) = 0;
+  // Caractère reçu sur le port série, -1 si aucun
+  virtual int readCommand() = 0;
+  virtual WakeCause wakeCause() = 0;
+  // Une seule tâche de fond à la fois : job(context) s'exécute pendant que le réveil
+  // continue. false si elle n'a pas pu être lancée, ou si la précédente tourne encore.
+  virtual bool startBackground(void (*job)(void *context), void *context) = 0;
+  // true si la tâche s'est terminée avant timeoutMs. Sinon elle continue : le réveil
+  // peut l'attendre à nouveau ou l'abandonner, context doit alors lui survivre.
+  virtual bool waitBackground(unsigned long timeoutMs) = 0;
+  // seconds == 0 : sommeil sans réveil programmé. Le bouton réveille toujours
+  // la carte. Ne revient pas sur ESP32.
+  virtual void deepSleep(uint64_t seconds) = 0;
+};
+
+class Clock
+{
+public:
+  virtual ~Clock() {}
+  virtual void configureNtp(const char *timeZone, const char *ntpServer) = 0;
+  // true une fois qu'une réponse NTP a été appliquée depuis configureNtp
+  virtual bool ntpSynced() = 0;
+  virtual void setTimeZone(const char *timeZone) = 0;
+  virtual time_t now() = 0;
+  virtual void adjust(long seconds) = 0;
+};
+
+enum ConnectPath
+{
+  CONNECT_FULL_SCAN, // scan de tous les canaux + DHCP
+  CONNECT_DIRECTED,  // BSSID et canal connus + DHCP
+  CONNECT_STATIC_IP, // BSSID, canal et bail DHCP connus
+};
+
+struct NetworkStats
+{
+  unsigned long connectMs; // durée de la dernière connexion
+  ConnectPath path;        // chemin qui a abouti
+  uint16_t fastHits;       // connexions rapides réussies depuis la mise sous tension
+  uint16_t fastMisses;     // connexions rapides échouées, rattrapées par un scan
+};
+
+class Network
+{
+public:
+  virtual ~Network() {}
+  // Connexion lancée en tâche de fond : le réveil prépare l'écran pendant ce temps.
+  // Sans effet tant que la connexion précédente n'a pas été reprise par finishConnect.
+  virtual void startConnect(const char *ssid, const char *key) = 0;
+  // Attend la fin de la connexion en cours, au plus timeoutMs : au-delà false est
+  // retourné, la connexion continue et un prochain appel peut encore l'attendre
+  virtual bool finishConnect(unsigned long timeoutMs) = 0;
+  virtual bool isConnected() = 0;
+  virtual void disconnect() = 0;
+  virtual NetworkStats stats() = 0;
+};
+
+// Petits blocs de données conservés en flash, même après une coupure d'alimentation
+class Storage
+{
+public:
+  virtual ~Storage() {}
+  // false si la clé est absente ou n'a pas la taille attendue
+  virtual bool load(const char *key, void *data, size_t size) = 0;
+  virtual bool save(const char *key, const void *data, size_t size) = 0;
+};
+
+// Fichiers numérotés en ajout seul, pour le journal d'événements (LittleFS sur l'ESP32)
+class LogFiles
+{
+public:
+  virtual ~LogFiles() {}
+  // Taille en octets, 0 si le fichier n'existe pas
+  virtual size_t size(int file) = 0;
+  virtual bool append(int file, const void *data, size_t size) = 0;
+  virtual bool read(int file, size_t offset, void *data, size_t size) = 0;
+  virtual bool remove(int file) = 0;
+};
+
+#define TEMPO_ERROR_CODES 6
+
+struct TempoResult
+{
+  char todayColor[TEMPO_COLOR_LEN];
+  char tomorrowColor[TEMPO_COLOR_LEN];
+  int countBlue;
+  int countWhite;
+  int countRed;
+  int errorCodes[TEMPO_ERROR_CODES];
+};
+
+struct ApiStats
+{
+  unsigned long fetchMs;  // durée du dernier appel
+  uint16_t requests;      // requêtes HTTP du dernier appel
+  uint16_t connections;   // connexions TLS ouvertes, une poignée de main chacune
+  uint16_t tokenReuses;   // jetons OAuth repris de la mémoire RTC depuis la mise sous tension
+  uint32_t bytes;         // octets de corps de réponse reçus pendant le dernier appel
+  uint16_t notModified;   // réponses 304 : valeurs reprises de la mémoire RTC
+};
+
+class TempoApi
+{
+public:
+  virtual ~TempoApi() {}
+  // API RTE sans inscription : dates au format AAAA-MM-JJ. Requêtes conditionnelles,
+  // les valeurs de la réponse précédente sont gardées (FreeCache.h).
+  virtual bool fetchFree(const char *today, const char *tomorrow,
+                         const char *season, TempoResult &result, unsigned long timeoutMs) = 0;
+  // API RTE avec compte : dates au format AAAA-MM-JJT00:00:00+0X:00
+  virtual bool fetchAccount(const char *today, const char *tomorrow, const char *dayAfter,
+                            const char *seasonStart, TempoResult &result, unsigned long timeoutMs) = 0;
+  // Écran hub du réseau local (TempoHub.h) : ligne reçue dans line, HTTP sans TLS
+  virtual bool fetchHub(const char *host, uint16_t port, char *line, size_t size, unsigned long timeoutMs) = 0;
+  virtual ApiStats stats() = 0;
+};
+
+// Rôle hub : au lieu du deep sleep, l'écran reste connecté et répond aux autres
+class HubServer
+{
+public:
+  virtual ~HubServer() {}
+  // Sert line (vide : pas de couleurs à servir) pendant seconds, ou jusqu'à la perte du WiFi
+  virtual void serve(const char *line, uint64_t seconds) = 0;
+};
+
+// Ce qu'il faut pour dessiner l'écran principal
+struct TempoView
+{
+  const char *todayColor;
+  const char *tomorrowColor;
+  int countBlue;
+  int countWhite;
+  int countRed;
+  int batteryPercentage;
+  int batteryDaysLeft; // autonomie prévue, -1 si inconnue
+  bool tempoSansCompte;
+  const char *errorCode;
+  char todayLabel[TIME_LABEL_LEN];    // "Sam 01 Nov"
+  char tomorrowLabel[TIME_LABEL_LEN];
+  time_t refreshTime;   // arrondi à la granularité configurée
+  bool refreshWithTime; // false : seule la date est affichée
+  char refreshLabel[TIME_LABEL_LEN];  // "01 Nov 11:05"
+  unsigned long lastCycleMs; // durée du réveil précédent, 0 si inconnue
+  bool stale; // couleurs du cache, le réveil n'a pas pu les vérifier
+};
+
+struct PanelStats
+{
+  unsigned long updateMs; // durée du dernier rafraîchissement
+  unsigned long parkedMs; // dont processeur en sommeil léger, en attendant l'écran
+};
+
+class Panel
+{
+public:
+  virtual ~Panel() {}
+  virtual void init() = 0;
+  virtual void printLine(const char *text) = 0;
+  // Parties fixes de l'écran principal, dessinables avant que les données n'arrivent
+  virtual void drawBackground() = 0;
+  // Complète le fond, qu'il ait été dessiné avant ou non
+  virtual void drawTempo(const TempoView &view) = 0;
+  virtual void update() = 0;
+  virtual PanelStats stats() = 0;
+};
+
+struct Hal
+{
+  Board &board;
+  Clock &clock;
+  Network &network;
+  TempoApi &api;
+  TempoApi &raceApi; // source lancée en tâche de fond : jamais deux requêtes sur un même client
+  Panel &panel;
+  Storage &storage;
+  HubServer &hub;
+  LogFiles &logFiles;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+// Lecture d'un corps de réponse HTTP directement depuis la connexion, sans le
+// copier en mémoire : longueur connue ou découpage en morceaux (chunked). Le
+// corps est lu exactement jusqu'au bout pour que la connexion reste
+// réutilisable (keep-alive).
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stddef.h>
+
+// Source d'octets au format d'un lecteur personnalisé ArduinoJson
+class ByteReader
+{
+public:
+  virtual ~ByteReader() {}
+  // -1 à la fin des données
+  virtual int read() = 0;
+  virtual size_t readBytes(char *buffer, size_t length) = 0;
+};
+
+#define HTTP_BODY_BUFFER 64
+
+class HttpBodyReader : public ByteReader
+{
+public:
+  // contentLength < 0 et pas de morceaux : jusqu'à la fermeture de la connexion
+  HttpBodyReader(ByteReader &source, long contentLength, bool chunked);
+  int read() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  // Lit la fin du corps qui n'a pas servi
+  void drain();
+  unsigned long bytesRead() const { return total; }
+
+private:
+  bool fill();
+  bool startChunk();
+  int readLine();
+
+  ByteReader &source;
+  long remaining; // octets restants du corps ou du morceau en cours, -1 : inconnu
+  bool chunked;
+  bool chunkStarted = false;
+  bool finished = false;
+  unsigned long total = 0;
+  char buffer[HTTP_BODY_BUFFER];
+  size_t position = 0;
+  size_t length = 0;
+};
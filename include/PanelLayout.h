@@ -0,0 +1,138 @@
+#pragma once
+
+// Disposition de l'écran principal. Les parties fixes sont décrites par une liste
+// de formes, tracée à la compilation en une image 1 bit rangée en flash : au
+// réveil, le fond est copié d'un bloc et seuls textes et barres sont dessinés.
+// Une variante de disposition ne coûte qu'une autre liste de formes.
+
+#include <stddef.h>
+
+#include "FrameRaster.h"
+
+// Layout parameters
+constexpr int leftMargin = 2;
+constexpr int topMargin = 6;
+constexpr int rectWidth = 120;
+constexpr int rectHeight = 100;
+constexpr int borderRadius = 8;
+constexpr int topLineY = 30;
+constexpr int separatorY = 50;
+constexpr int colorTextY = 80;
+constexpr int rectSpacing = 5; // Space between rectangles
+constexpr int bottomIndicatorY = 120;
+constexpr int circleRadius = 6;
+constexpr int redRectWidth = 12;
+constexpr int redRectHeight = 13;
+constexpr int redRectRadius = 3;
+constexpr int textOffsetX = 10;
+constexpr int adjustTitleX = -3;
+constexpr int textRemainOffsetX = 10;
+constexpr int textRemainExclamationOffsetX = 15;
+constexpr int textRemainOffsetY = 6;
+constexpr int exclamantionOffsetX = 45;
+constexpr int secondRectX = leftMargin + rectWidth + rectSpacing;
+
+constexpr int batteryTopMargin = 10;
+constexpr int batteryTopLeftX = leftMargin + textOffsetX;
+constexpr int batteryTopLeftY = colorTextY + batteryTopMargin;
+constexpr int nbBars = 4;
+constexpr int barWidth = 3;
+constexpr int batteryWidth = (barWidth + 1) * nbBars + 2;
+constexpr int barHeight = 4;
+constexpr int batteryHeight = barHeight + 4;
+
+// Positioning for the bottom indicators
+constexpr int x_blanc = 15;
+constexpr int x_rouge = x_blanc + exclamantionOffsetX;
+constexpr int exclamationCenterX = x_rouge + redRectWidth / 2;
+
+enum LayoutShapeKind
+{
+  LAYOUT_LINE,       // a, b -> c, d
+  LAYOUT_ROUND_RECT, // a, b, largeur c, hauteur d, rayon r
+  LAYOUT_CIRCLE,     // centre a, b, rayon r
+};
+
+struct LayoutShape
+{
+  LayoutShapeKind kind;
+  int16_t a;
+  int16_t b;
+  int16_t c;
+  int16_t d;
+  int16_t r;
+};
+
+constexpr LayoutShape panelLayout[] = {
+    // Battery outline
+    {LAYOUT_LINE, batteryTopLeftX, batteryTopLeftY, batteryTopLeftX + batteryWidth, batteryTopLeftY, 0},
+    {LAYOUT_LINE, batteryTopLeftX, batteryTopLeftY + batteryHeight, batteryTopLeftX + batteryWidth, batteryTopLeftY + batteryHeight, 0},
+    {LAYOUT_LINE, batteryTopLeftX, batteryTopLeftY, batteryTopLeftX, batteryTopLeftY + batteryHeight, 0},
+    {LAYOUT_LINE, batteryTopLeftX + batteryWidth, batteryTopLeftY, batteryTopLeftX + batteryWidth, batteryTopLeftY + batteryHeight, 0},
+    // + Pole
+    {LAYOUT_LINE, batteryTopLeftX + batteryWidth + 1, batteryTopLeftY + 1, batteryTopLeftX + batteryWidth + 1, batteryTopLeftY + (batteryHeight - 1), 0},
+    {LAYOUT_LINE, batteryTopLeftX + batteryWidth + 2, batteryTopLeftY + 1, batteryTopLeftX + batteryWidth + 2, batteryTopLeftY + (batteryHeight - 1), 0},
+    // First rectangle (today) and its separator
+    {LAYOUT_ROUND_RECT, leftMargin, topMargin, rectWidth, rectHeight, borderRadius},
+    {LAYOUT_LINE, leftMargin + textOffsetX, separatorY, rectWidth - textOffsetX, separatorY, 0},
+    // Second rectangle (tomorrow) and its separator
+    {LAYOUT_ROUND_RECT, secondRectX, topMargin, rectWidth, rectHeight, borderRadius},
+    {LAYOUT_LINE, secondRectX + textOffsetX, separatorY, secondRectX + rectWidth - textOffsetX, separatorY, 0},
+    // Blue circle: ma MOA se moque des jours bleus :)
+    // White circle
+    {LAYOUT_CIRCLE, x_blanc, bottomIndicatorY, 0, 0, circleRadius},
+    // Red rounded rectangle with an exclamation mark, lines doubled for visibility
+    {LAYOUT_ROUND_RECT, x_rouge, bottomIndicatorY - redRectHeight / 2, redRectWidth, redRectHeight, redRectRadius},
+    {LAYOUT_LINE, exclamationCenterX - 1, bottomIndicatorY - 4, exclamationCenterX - 1, bottomIndicatorY + 2, 0},
+    {LAYOUT_LINE, exclamationCenterX, bottomIndicatorY - 4, exclamationCenterX, bottomIndicatorY + 2, 0},
+    {LAYOUT_LINE, exclamationCenterX - 1, bottomIndicatorY + 4, exclamationCenterX - 1, bottomIndicatorY + 4, 0},
+    {LAYOUT_LINE, exclamationCenterX, bottomIndicatorY + 4, exclamationCenterX, bottomIndicatorY + 4, 0},
+};
+
+constexpr void rasterizeLayout(FrameRaster &raster, const LayoutShape *shapes, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    const LayoutShape &shape = shapes[i];
+    switch (shape.kind)
+    {
+    case LAYOUT_LINE:
+      raster.line(shape.a, shape.b, shape.c, shape.d);
+      break;
+    case LAYOUT_ROUND_RECT:
+      raster.roundRect(shape.a, shape.b, shape.c, shape.d, shape.r);
+      break;
+    case LAYOUT_CIRCLE:
+      raster.circle(shape.a, shape.b, shape.r);
+      break;
+    }
+  }
+}
+
+// Fond blanc et formes fixes
+constexpr FrameBitmap rasterizeBackground(const LayoutShape *shapes, size_t count)
+{
+  FrameBitmap bitmap = {};
+  FrameRaster raster(bitmap.bytes);
+  raster.clear();
+  rasterizeLayout(raster, shapes, count);
+  return bitmap;
+}
+
+// Barres pleines de la jauge de batterie, en rectangles
+constexpr void fillBatteryBars(FrameRaster &raster, int bars)
+{
+  for (int j = 0; j < bars; j++)
+  {
+    raster.fillRect(batteryTopLeftX + 2 + j * (barWidth + 1), batteryTopLeftY + 2, barWidth, barHeight + 1);
+  }
+}
+
+// round(percentage / 25.0) sans virgule flottante
+constexpr int batteryBars(int percentage)
+{
+  return (percentage * 2 + 25) / 50;
+}
+
+// panelLayout tracé à la compilation
+extern const FrameBitmap panelBackground;
@@ -0,0 +1,38 @@
+#pragma once
+
+// Réponse du calendrier Tempo de l'API RTE avec compte, lue jour par jour :
+// seuls la date et la couleur de chaque jour passent le filtre ArduinoJson, et
+// les jours sont comptés au fil de la lecture sans que le tableau soit gardé.
+// La mémoire utilisée ne dépend donc pas de la longueur de la saison demandée.
+
+#include "HttpBody.h"
+#include "SeasonHistory.h"
+
+struct RteCalendar
+{
+  DayColor today;
+  DayColor tomorrow;
+  SeasonCounts counts;
+  int days; // jours lus
+};
+
+// today, tomorrow : dates dont seuls les 10 premiers caractères (AAAA-MM-JJ) comptent
+bool rteCalendarParse(ByteReader &reader, const char *today, const char *tomorrow, RteCalendar &calendar);
+
+// Réponse de l'API sans inscription : un objet "values" de dates AAAA-MM-JJ et de
+// couleurs, dans un ordre quelconque. Seuls les totaux et les deux jours les plus
+// récents sont gardés, de quoi retrouver aujourd'hui, demain et les compteurs
+// jusqu'à demain sans relire la réponse.
+struct FreeCalendar
+{
+  SeasonCounts counts; // tous les jours lus
+  int32_t lastYmd[2];  // deux jours les plus récents (AAAAMMJJ), [1] le dernier, 0 si absent
+  uint8_t lastColor[2]; // DayColor
+  int16_t days;         // jours lus
+};
+
+bool freeCalendarParse(ByteReader &reader, FreeCalendar &calendar);
+// DAY_UNKNOWN si le jour n'est pas parmi les deux plus récents
+DayColor freeCalendarColor(const FreeCalendar &calendar, int ymd);
+// Compteurs des jours jusqu'à ymd inclus, false si la réponse ne permet pas de les isoler
+bool freeCalendarCountsUntil(const FreeCalendar &calendar, int ymd, SeasonCounts &counts);
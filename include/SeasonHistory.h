@@ -0,0 +1,58 @@
+#pragma once
+
+// Couleurs des jours de la saison Tempo, 2 bits par jour, sauvegardées en flash.
+// En mode avec compte, seule la partie de la saison absente de l'historique est
+// demandée à l'API, et les compteurs sont recalculés localement.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stdint.h>
+#include <time.h>
+
+#define SEASON_HISTORY_VERSION 1
+#define SEASON_MAX_DAYS 366
+
+enum DayColor
+{
+  DAY_UNKNOWN = 0,
+  DAY_BLUE = 1,
+  DAY_WHITE = 2,
+  DAY_RED = 3,
+};
+
+struct SeasonCounts
+{
+  int blue;
+  int white;
+  int red;
+};
+
+struct SeasonHistory
+{
+  uint16_t version;
+  uint16_t bulkDays;   // jours [0, bulkDays[ connus seulement par leurs totaux
+  int32_t startYmd;    // premier jour de la saison (AAAAMMJJ)
+  int16_t bulkBlue;
+  int16_t bulkWhite;
+  int16_t bulkRed;
+  uint8_t days[(SEASON_MAX_DAYS * 2 + 7) / 8];
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+DayColor dayColorFromName(const char *color);
+// Jour de la saison (0 : premier jour), -1 si la date est hors saison
+int seasonDayIndex(int startYmd, const struct tm &day);
+// Premier jour de la saison + index, au format AAAA-MM-JJ
+void seasonDayDate(char *buffer, int size, int startYmd, int index);
+
+void seasonHistoryReset(SeasonHistory &history, int startYmd);
+bool seasonHistoryIsValid(const SeasonHistory &history, int startYmd);
+void seasonHistorySeal(SeasonHistory &history);
+
+DayColor seasonHistoryGet(const SeasonHistory &history, int day);
+void seasonHistorySet(SeasonHistory &history, int day, DayColor color);
+// Premier jour de [bulkDays, untilDay[ dont la couleur manque, untilDay s'il n'y en a pas
+int seasonHistoryFirstUnknown(const SeasonHistory &history, int untilDay);
+// Les jours [fromDay, toDay[ ne sont connus que par leurs totaux
+void seasonHistoryMergeTotals(SeasonHistory &history, int fromDay, int toDay, const SeasonCounts &totals);
+// Totaux des jours [0, untilDay[
+SeasonCounts seasonHistoryCount(const SeasonHistory &history, int untilDay);
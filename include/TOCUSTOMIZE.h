@@ -6,6 +6,8 @@
 bool tempoSansCompteTRE = true;
 
 // Create an account and your app here : https://data.rte-france.com/create_account/
+// Renseignés, ils servent aussi quand l'API sans inscription ne répond pas, et
+// inversement : l'écran commence par celle qui répond le plus vite et le plus souvent.
 String client_secret = "";
 String client_id = "";
 
@@ -18,6 +20,22 @@ String debutSaisonTempo = "2025-09-01";
 // Pour les apis sans inscription
 String saisonTempo = "2025-2026";
 
+// Précision en minutes de l'heure de rafraîchissement affichée en bas à droite.
+// 1 : heure exacte. 60 : heure pleine. 1440 : date seule (par défaut).
+// Quand rien d'autre ne change à l'écran, l'écran n'est pas rallumé : avec l'heure
+// exacte ou l'heure pleine, chaque réveil en ligne change l'écran et le rallume.
+int granulariteRafraichissement = 1440;
+
+// Durée maximale d'un réveil, en secondes. Au-delà, WiFi, NTP et appels API sont
+// abandonnés et l'écran garde les dernières couleurs connues, la date en négatif.
+int dureeMaxReveilSecondes = 20;
+
+// Plusieurs écrans sur le même réseau : un seul, alimenté par USB, interroge l'API
+// et sert les couleurs aux autres (hubTempo = true). Les autres indiquent son
+// adresse IP et ne passent par l'API que s'il ne répond pas.
+bool hubTempo = false;
+const char* adresseHub = ""; // ex. "192.168.1.20", vide sans hub
+
 // ==================================
 //           CUSTOMIZE END
 // ==================================
@@ -0,0 +1,21 @@
+#pragma once
+
+// Rôle hub : un écran alimenté par USB interroge l'API et sert les dernières
+// couleurs aux autres écrans du réseau local, qui l'interrogent avant l'API.
+// Une ligne de texte en HTTP simple, sans TLS :
+//   tempo 1 <AAAAMMJJ> <couleur du jour> <couleur de demain> <bleus> <blancs> <rouges>
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stddef.h>
+
+#include "Hal.h"
+#include "TempoState.h"
+
+#define TEMPO_HUB_PATH "/tempo"
+#define TEMPO_HUB_VERSION 1
+#define TEMPO_HUB_LINE_LEN 96
+
+// Longueur de la ligne, 0 si l'état ne peut pas être servi
+int tempoHubFormat(char *buffer, size_t size, const TempoState &state);
+// false si la ligne est illisible ou décrit un autre jour que todayYmd
+bool tempoHubParse(const char *line, int todayYmd, TempoResult &result);
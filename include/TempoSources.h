@@ -0,0 +1,49 @@
+#pragma once
+
+// Sources des couleurs Tempo. Chaque source réseau (hub du réseau local, API RTE
+// avec compte, API sans inscription) garde en mémoire RTC la durée de ses
+// réponses, de ses échecs et son taux de réussite récents. Un réveil les essaie
+// de celle qui promet une réponse au plus vite à la plus lente ; le cache RTC
+// reste le dernier recours, hors classement.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stdint.h>
+#include <time.h>
+
+#define SOURCE_HISTORY_VERSION 1
+
+enum TempoSource
+{
+  SOURCE_HUB,
+  SOURCE_ACCOUNT,
+  SOURCE_FREE,
+  SOURCE_NETWORK_COUNT,
+  SOURCE_CACHE = SOURCE_NETWORK_COUNT, // couleurs déjà en mémoire RTC
+  SOURCE_NONE,                         // aucune couleur obtenue
+};
+
+extern const char *tempoSourceNames[SOURCE_NONE + 1];
+
+struct SourceStats
+{
+  uint16_t successMs;  // durée moyenne d'une réponse
+  uint16_t failureMs;  // durée moyenne d'un échec, délai compris
+  uint8_t successRate; // sur 255, moyenne glissante
+  uint32_t lastTry;    // heure du dernier essai, 0 si aucun
+};
+
+struct SourceHistory
+{
+  uint16_t version;
+  SourceStats sources[SOURCE_NETWORK_COUNT];
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+// Essai terminé : réponse exploitable ou non, durée jusqu'à la réponse ou à l'abandon
+void sourceHistoryRecord(SourceHistory &history, TempoSource source, bool success, unsigned long ms, time_t now);
+// Sources de enabled (bits 1 << TempoSource) dans l'ordre où les essayer, preference
+// (SOURCE_NETWORK_COUNT sources) départageant les égalités. Nombre de sources écrites.
+int sourceOrder(const SourceHistory &history, unsigned enabled, const TempoSource *preference, time_t now,
+                TempoSource *order);
+// Attente de la réponse de source avant de lancer la suivante en parallèle
+unsigned long sourceRaceDelayMs(const SourceHistory &history, TempoSource source);
@@ -0,0 +1,43 @@
+#pragma once
+
+// Etat Tempo conservé en mémoire RTC entre deux deep sleep.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stdint.h>
+#include <time.h>
+
+#define TEMPO_STATE_VERSION 1
+#define TEMPO_COLOR_LEN 12
+
+struct TempoState
+{
+  uint16_t version;
+  int32_t dateYmd; // jour (AAAAMMJJ) auquel s'applique todayColor
+  char todayColor[TEMPO_COLOR_LEN];
+  char tomorrowColor[TEMPO_COLOR_LEN];
+  int16_t countBlue;
+  int16_t countWhite;
+  int16_t countRed;
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+enum TempoCacheStatus
+{
+  TEMPO_CACHE_INVALID,  // pas de cache exploitable : il faut appeler l'API
+  TEMPO_CACHE_FRESH,    // le cache couvre aujourd'hui
+  TEMPO_CACHE_ROLLOVER, // le "demain" de la veille devient "aujourd'hui"
+};
+
+int tempoDateYmd(const struct tm &timeinfo);
+
+void tempoStateStore(TempoState &state, int dateYmd,
+                     const char *todayColor, const char *tomorrowColor,
+                     int countBlue, int countWhite, int countRed);
+void tempoStateInvalidate(TempoState &state);
+bool tempoStateIsIntact(const TempoState &state);
+
+// publicationMinute : minute de la journée à partir de laquelle la couleur
+// du lendemain peut être publiée et justifie un appel réseau.
+TempoCacheStatus tempoStateLookup(const TempoState &state, const struct tm &now,
+                                  int publicationMinute, const char *notAvailable);
+void tempoStateRollOver(TempoState &state, int dateYmd, const char *notAvailable);
@@ -0,0 +1,38 @@
+#pragma once
+
+// Heure du réveil figée une fois : aujourd'hui, demain et après-demain avec
+// leur décalage UTC, pour que toutes les dates d'un même réveil concordent même
+// s'il déborde sur minuit. Formatage dans des tampons fournis, sans allocation.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+#include <stddef.h>
+#include <time.h>
+
+#define SNAPSHOT_DAYS 3
+#define TIME_LABEL_LEN 16
+
+struct SnapshotDay
+{
+  int year;
+  int month; // 1 à 12
+  int mday;
+  int wday;  // 0 : dimanche
+  int utcOffsetMinutes; // à 00:00 ce jour-là
+};
+
+struct TimeSnapshot
+{
+  time_t now;
+  struct tm local;
+  SnapshotDay days[SNAPSHOT_DAYS]; // aujourd'hui, demain, après-demain
+};
+
+void takeTimeSnapshot(TimeSnapshot &snapshot, time_t now);
+int snapshotDateYmd(const TimeSnapshot &snapshot, int delta);
+
+// "2025-11-01T00:00:00+01:00"
+void formatRteDate(char *buffer, size_t size, const TimeSnapshot &snapshot, int delta);
+// "Sam 01 Nov"
+void formatDayLabel(char *buffer, size_t size, const TimeSnapshot &snapshot, int delta);
+// "05 Fev 11:05", ou "05 Fev" seul
+void formatRefreshLabel(char *buffer, size_t size, time_t refreshTime, bool withTime);
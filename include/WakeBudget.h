@@ -0,0 +1,18 @@
+#pragma once
+
+// Temps d'éveil maximal d'un réveil, compté depuis le reset. Chaque étape réseau
+// (WiFi, NTP, API) reçoit ce qui reste avant la réserve de fin, gardée pour
+// afficher le cache et programmer le réveil suivant : le pire cas est borné
+// même quand le réseau ou l'API ne répondent plus.
+// Aucune dépendance Arduino : ce module doit pouvoir être compilé sur l'hôte.
+
+struct WakeBudget
+{
+  unsigned long budgetMs;  // durée d'éveil maximale
+  unsigned long reserveMs; // rafraîchissement de l'écran et mise en veille
+};
+
+// Temps laissé à une étape qui commence à nowMs (depuis le reset), au plus
+// stageMaxMs ; 0 si le budget est épuisé
+unsigned long wakeBudgetStageMs(const WakeBudget &budget, unsigned long nowMs, unsigned long stageMaxMs);
+bool wakeBudgetExhausted(const WakeBudget &budget, unsigned long nowMs);
@@ -0,0 +1,60 @@
+#pragma once
+
+// Cycle de réveil complet : batterie, cache, WiFi, NTP, API, affichage, deep sleep.
+// Ne dépend que de Hal.h, il tourne donc aussi bien sur l'ESP32 que sur l'hôte.
+
+#include <stddef.h>
+#include <time.h>
+
+#include "Battery.h"
+#include "ClockDrift.h"
+#include "CycleLog.h"
+#include "EventLog.h"
+#include "Hal.h"
+#include "TempoSources.h"
+#include "TempoState.h"
+#include "WakeBudget.h"
+#include "WakeScheduler.h"
+
+struct WakeConfig
+{
+  const char *wifiSsid;
+  const char *wifiKey;
+  bool tempoSansCompte;          // API préférée tant que les mesures ne départagent pas
+  bool bothApis;                 // l'autre API RTE aussi, classée selon ses mesures
+  const char *saisonTempo;      // API sans inscription, ex. "2025-2026"
+  const char *debutSaisonTempo; // API avec compte, ex. "2025-09-01"
+  const char *timeZone;
+  const char *ntpServer;
+  const char *notAvailable; // DAY_NOT_AVAILABLE de la librairie
+  WakePolicy schedule;
+  int refreshGranularityMinutes; // précision de l'heure de rafraîchissement affichée
+  long ntpMaxErrorSeconds;       // erreur d'horloge estimée tolérée sans NTP
+  long ntpMaxAgeSeconds;         // NTP au moins une fois par période
+  bool dumpCycleLog;             // journal des réveils sur le port série à chaque réveil
+  WakeBudget budget;             // au-delà, les étapes réseau sont abandonnées
+  bool hubServe;                 // rôle hub (USB) : sert les couleurs au lieu du deep sleep
+  const char *hubHost;           // écran hub du réseau local, nullptr sans hub
+  uint16_t hubPort;
+  bool raceSources;              // source suivante lancée en parallèle quand la première tarde
+};
+
+// Tout ce qui doit survivre au deep sleep (RTC_DATA_ATTR sur l'ESP32)
+struct RtcState
+{
+  unsigned int counterRetry; // échecs consécutifs
+  TempoState tempo;
+  uint32_t screenHash; // contenu affiché, 0 si inconnu
+  int screenDateYmd;   // jour affiché avec ce contenu
+  ClockDrift drift;
+  CycleLog cycles;
+  BatteryHistory battery;
+  WakeDecision scheduledWake; // dernier réveil programmé, gardé après un appui sur le bouton
+  SourceHistory sources;      // latence et réussite récentes de chaque source
+  EventCursor events;         // position d'écriture du journal en flash
+};
+
+void runWakeCycle(Hal &hal, const WakeConfig &config, RtcState &rtc);
+
+time_t roundRefreshTime(time_t now, int granularityMinutes);
+uint32_t tempoViewHash(const TempoView &view, int dateYmd);
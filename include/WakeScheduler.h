@@ -0,0 +1,65 @@
+#pragma once
+
+// Choix du prochain réveil à partir de l'état plutôt que d'une table d'heures fixes :
+// couleur du lendemain connue ou non, fenêtre de publication RTE, échecs
+// consécutifs et niveau de batterie. Aucune dépendance Arduino.
+
+#include <stdint.h>
+#include <time.h>
+
+struct WakeupTime
+{
+  int hour;
+  int minute;
+};
+
+struct WakePolicy
+{
+  WakeupTime publicationStart;   // avant cette heure, demain n'est pas publié
+  WakeupTime publicationEnd;     // essai toujours fait, après la publication officielle ; ensuite
+                                 // les essais s'espacent du double jusqu'au changement de jour
+  int publicationPollMinutes;    // intervalle entre deux essais dans la fenêtre
+  int rolloverDelayMinutes;      // réveil après minuit pour afficher demain en aujourd'hui
+  uint32_t retryBaseSeconds;     // attente après un premier échec, doublée à chaque échec
+  uint32_t retryMaxSeconds;      // plafond de l'attente après échec
+  int lowBatteryPercentage;      // en dessous, les réveils sont espacés
+  int lowBatteryFactor;          // multiplicateur des intervalles sur batterie faible
+  int lowBatteryDays;            // autonomie prévue en jours sous laquelle la batterie est faible
+};
+
+enum WakeReason
+{
+  WAKE_ROLLOVER,    // demain connu : réveil au changement de jour
+  WAKE_PUBLICATION, // début de la fenêtre de publication
+  WAKE_POLL,        // nouvel essai dans la fenêtre de publication ou après
+  WAKE_RETRY,       // échec : attente exponentielle avec gigue
+};
+
+extern const char *wakeReasonNames[];
+
+struct WakeInputs
+{
+  time_t now;             // 0 si l'heure n'est pas fiable
+  bool todayKnown;        // couleur du jour en cache : un échec ne concerne que demain
+  bool tomorrowKnown;     // couleur du lendemain en cache pour le jour courant
+  unsigned int failures;  // échecs consécutifs, celui de ce réveil compris
+  bool batteryLow;
+  uint32_t random;        // source de la gigue
+};
+
+struct WakeDecision
+{
+  uint64_t sleepSeconds;
+  time_t wakeAt; // 0 si l'heure n'est pas fiable
+  WakeReason reason;
+};
+
+// Un réveil un peu en avance sur l'horaire prévu compte comme cet horaire,
+// sinon on se rendormirait quelques secondes pour rien
+#define WAKE_EARLY_TOLERANCE_SECONDS 90
+
+WakeDecision scheduleNextWake(const WakePolicy &policy, const WakeInputs &inputs);
+// Minute du jour de l'essai suivant minute quand demain n'est pas connu, -1 s'il
+// n'y en a plus avant minuit
+int nextPollMinute(const WakePolicy &policy, int minute, bool batteryLow);
+uint32_t retryDelaySeconds(const WakePolicy &policy, unsigned int failures, bool batteryLow, uint32_t random);
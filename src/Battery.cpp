@@ -0,0 +1,198 @@
+#include "Battery.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+// Pont diviseur du T5 : 7,05 V pleine échelle sur 12 bits
+static const long ADC_FULL_SCALE_MV = 7050;
+static const int ADC_RANGE = 4096;
+// Lectures écartées au-delà de cet écart à la médiane (environ 55 mV)
+static const int OUTLIER_RAW = 32;
+// Sous 1 V, pas de batterie : alimentation USB
+static const int MIN_VALID_MV = 1000;
+
+// Au moins ~20 h entre deux mesures de l'historique, et de quoi mesurer une pente
+static const long HISTORY_INTERVAL_SECONDS = 20 * 3600;
+static const long FORECAST_MIN_SPAN_SECONDS = 2 * 86400;
+static const int FORECAST_MIN_SAMPLES = 3;
+static const int FORECAST_MAX_DAYS = 999;
+// Hausse de tension qui ne peut venir que d'une recharge
+static const int RECHARGE_MV = 100;
+
+constexpr int TABLE_MIN_MV = 3500; // batterie vide
+constexpr int TABLE_MAX_MV = 4200; // batterie pleine
+constexpr int TABLE_STEP_MV = 10;
+constexpr int TABLE_SIZE = (TABLE_MAX_MV - TABLE_MIN_MV) / TABLE_STEP_MV + 1;
+
+// Courbe de décharge Li-ion : polynôme de degré 4 en volts, évalué par Horner
+constexpr double dischargeCurve(double volts)
+{
+  return (((2836.9625 * volts - 43987.4889) * volts + 255233.8134) * volts - 656689.7123) * volts + 632041.7303;
+}
+
+struct DischargeTable
+{
+  uint8_t percentage[TABLE_SIZE];
+};
+
+// Pourcentage tous les 10 mV, borné à [0, 100] et croissant
+constexpr DischargeTable makeDischargeTable()
+{
+  DischargeTable table = {};
+  int previous = 0;
+  for (int i = 0; i < TABLE_SIZE; i++)
+  {
+    double value = dischargeCurve((TABLE_MIN_MV + i * TABLE_STEP_MV) / 1000.0);
+    int percentage = value <= 0 ? 0 : value >= 100 ? 100 : (int)(value + 0.5);
+    percentage = percentage < previous ? previous : percentage;
+    table.percentage[i] = (uint8_t)percentage;
+    previous = percentage;
+  }
+  table.percentage[TABLE_SIZE - 1] = 100;
+  return table;
+}
+
+static constexpr DischargeTable dischargeTable = makeDischargeTable();
+static_assert(dischargeTable.percentage[0] == 0, "batterie vide à 3,5 V");
+
+int batteryMillivolts(int *raw, int count)
+{
+  if (count <= 0)
+  {
+    return 0;
+  }
+  // Tri par insertion : quelques lectures seulement
+  for (int i = 1; i < count; i++)
+  {
+    int value = raw[i];
+    int j = i;
+    for (; j > 0 && raw[j - 1] > value; j--)
+    {
+      raw[j] = raw[j - 1];
+    }
+    raw[j] = value;
+  }
+
+  int median = raw[count / 2];
+  long sum = 0;
+  int kept = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (raw[i] >= median - OUTLIER_RAW && raw[i] <= median + OUTLIER_RAW)
+    {
+      sum += raw[i];
+      kept++;
+    }
+  }
+  int millivolts = (int)((sum * ADC_FULL_SCALE_MV + (long)kept * ADC_RANGE / 2) / ((long)kept * ADC_RANGE));
+  return millivolts >= MIN_VALID_MV ? millivolts : 0;
+}
+
+int batteryPercentage(int millivolts)
+{
+  if (millivolts <= TABLE_MIN_MV)
+  {
+    return 0;
+  }
+  if (millivolts >= TABLE_MAX_MV)
+  {
+    return 100;
+  }
+  int index = (millivolts - TABLE_MIN_MV) / TABLE_STEP_MV;
+  int remainder = (millivolts - TABLE_MIN_MV) % TABLE_STEP_MV;
+  int low = dischargeTable.percentage[index];
+  int high = dischargeTable.percentage[index + 1];
+  return low + ((high - low) * remainder + TABLE_STEP_MV / 2) / TABLE_STEP_MV;
+}
+
+static uint32_t computeChecksum(const BatteryHistory &history)
+{
+  return fnv1a(&history, offsetof(BatteryHistory, checksum));
+}
+
+static bool isValid(const BatteryHistory &history)
+{
+  return history.version == BATTERY_HISTORY_VERSION && history.count <= BATTERY_HISTORY_SIZE &&
+         history.next < BATTERY_HISTORY_SIZE && history.checksum == computeChecksum(history);
+}
+
+// Mesure i, de la plus ancienne (0) à la plus récente
+static int slot(const BatteryHistory &history, int i)
+{
+  return (history.next + BATTERY_HISTORY_SIZE - history.count + i) % BATTERY_HISTORY_SIZE;
+}
+
+bool batteryHistoryAdd(BatteryHistory &history, time_t now, int millivolts)
+{
+  if (millivolts <= 0)
+  {
+    return false;
+  }
+  if (!isValid(history))
+  {
+    memset(&history, 0, sizeof(history));
+  }
+  if (history.count > 0)
+  {
+    int last = slot(history, history.count - 1);
+    if ((time_t)history.times[last] > now || millivolts > history.millivolts[last] + RECHARGE_MV)
+    {
+      memset(&history, 0, sizeof(history));
+    }
+    else if (now - (time_t)history.times[last] < HISTORY_INTERVAL_SECONDS)
+    {
+      return false;
+    }
+  }
+
+  history.times[history.next] = (uint32_t)now;
+  history.millivolts[history.next] = (uint16_t)millivolts;
+  history.next = (history.next + 1) % BATTERY_HISTORY_SIZE;
+  if (history.count < BATTERY_HISTORY_SIZE)
+  {
+    history.count++;
+  }
+  history.version = BATTERY_HISTORY_VERSION;
+  history.checksum = computeChecksum(history);
+  return true;
+}
+
+int batteryForecastDays(const BatteryHistory &history)
+{
+  if (!isValid(history) || history.count < FORECAST_MIN_SAMPLES)
+  {
+    return -1;
+  }
+  int first = slot(history, 0);
+  int last = slot(history, history.count - 1);
+  if ((long)(history.times[last] - history.times[first]) < FORECAST_MIN_SPAN_SECONDS)
+  {
+    return -1;
+  }
+
+  // Pente des pourcentages par moindres carrés, en jours depuis la première mesure
+  double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+  for (int i = 0; i < history.count; i++)
+  {
+    int index = slot(history, i);
+    double x = (history.times[index] - history.times[first]) / 86400.0;
+    double y = batteryPercentage(history.millivolts[index]);
+    sumX += x;
+    sumY += y;
+    sumXX += x * x;
+    sumXY += x * y;
+  }
+  int n = history.count;
+  double slope = (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+  if (slope >= 0)
+  {
+    return -1;
+  }
+  // Niveau actuel d'après la droite, moins sensible au bruit de la dernière mesure
+  double xLast = (history.times[last] - history.times[first]) / 86400.0;
+  double level = (sumY - slope * sumX) / n + slope * xLast;
+  double days = level > 0 ? level / -slope : 0;
+  return days < FORECAST_MAX_DAYS ? (int)days : FORECAST_MAX_DAYS;
+}
@@ -0,0 +1,101 @@
+#include "ClockDrift.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+// En dessous, l'écart mesuré est surtout dû à la résolution d'une seconde
+static const long MIN_MEASURE_SECONDS = 3600;
+// Plancher de l'incertitude : 1 s d'erreur de lecture sur une nuit
+static const float MIN_UNCERTAINTY_PPM = 50;
+// Poids d'une nouvelle mesure une fois la dérive connue, pour lisser le bruit
+static const float DRIFT_GAIN = 0.7;
+
+static uint32_t computeChecksum(const ClockDrift &drift)
+{
+  return fnv1a(&drift, offsetof(ClockDrift, checksum));
+}
+
+static void seal(ClockDrift &drift)
+{
+  drift.version = CLOCK_DRIFT_VERSION;
+  drift.checksum = computeChecksum(drift);
+}
+
+bool clockDriftIsValid(const ClockDrift &drift)
+{
+  return drift.version == CLOCK_DRIFT_VERSION && drift.checksum == computeChecksum(drift);
+}
+
+long clockDriftCorrection(ClockDrift &drift, time_t rtcNow)
+{
+  if (!clockDriftIsValid(drift) || rtcNow <= drift.lastCorrection)
+  {
+    return 0;
+  }
+
+  // L'horloge a compté (1 + d) secondes pour chaque seconde réelle
+  double d = drift.driftPpm * 1e-6;
+  double elapsed = (double)(rtcNow - drift.lastCorrection);
+  drift.pendingSeconds -= (float)(elapsed * d / (1 + d));
+
+  long whole = (long)drift.pendingSeconds;
+  drift.pendingSeconds -= whole;
+  drift.lastCorrection = rtcNow + whole;
+  seal(drift);
+  return whole;
+}
+
+uint64_t clockDriftSleepSeconds(const ClockDrift &drift, uint64_t realSeconds)
+{
+  if (!clockDriftIsValid(drift) || drift.samples == 0)
+  {
+    return realSeconds;
+  }
+  // Le timer de deep sleep compte sur la même horloge que l'heure RTC
+  return (uint64_t)llround(realSeconds * (1 + drift.driftPpm * 1e-6));
+}
+
+float clockDriftPredictedError(const ClockDrift &drift, time_t now)
+{
+  if (!clockDriftIsValid(drift) || drift.samples == 0)
+  {
+    return 1e9;
+  }
+  return drift.uncertaintyPpm * 1e-6 * (float)(now - drift.lastSync) + 1;
+}
+
+bool clockDriftNeedsSync(const ClockDrift &drift, time_t now, long maxErrorSeconds, long maxAgeSeconds)
+{
+  if (!clockDriftIsValid(drift) || now - drift.lastSync >= maxAgeSeconds)
+  {
+    return true;
+  }
+  return clockDriftPredictedError(drift, now) > maxErrorSeconds;
+}
+
+void clockDriftOnSync(ClockDrift &drift, time_t expected, time_t ntpTime)
+{
+  if (!clockDriftIsValid(drift))
+  {
+    memset(&drift, 0, sizeof(drift));
+  }
+  else if (ntpTime - drift.lastSync >= MIN_MEASURE_SECONDS)
+  {
+    // Ce qui reste d'écart malgré les corrections est l'erreur de l'estimation
+    float residualPpm = (float)(expected - ntpTime) / (float)(ntpTime - drift.lastSync) * 1e6f;
+    drift.driftPpm += drift.samples == 0 ? residualPpm : residualPpm * DRIFT_GAIN;
+    drift.uncertaintyPpm = fabsf(residualPpm) > MIN_UNCERTAINTY_PPM ? fabsf(residualPpm) : MIN_UNCERTAINTY_PPM;
+    if (drift.samples < 255)
+    {
+      drift.samples++;
+    }
+  }
+
+  drift.lastSync = ntpTime;
+  drift.lastCorrection = ntpTime;
+  drift.pendingSeconds = 0;
+  seal(drift);
+}
@@ -0,0 +1,115 @@
+#include "CycleLog.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+const char *cyclePhaseNames[CYCLE_PHASE_COUNT] = {
+    "boot", "adc", "panel_init", "wifi", "ntp", "api", "render", "panel_update", "sleep"};
+
+static uint32_t computeChecksum(const CycleLog &log)
+{
+  return fnv1a(&log, offsetof(CycleLog, checksum));
+}
+
+static bool isIntact(const CycleLog &log)
+{
+  return log.version == CYCLE_LOG_VERSION && log.next < CYCLE_LOG_SIZE && log.count <= CYCLE_LOG_SIZE &&
+         log.checksum == computeChecksum(log);
+}
+
+CycleRecord &cycleLogBegin(CycleLog &log)
+{
+  if (!isIntact(log))
+  {
+    memset(&log, 0, sizeof(log));
+    log.version = CYCLE_LOG_VERSION;
+  }
+  // L'emplacement du réveil en cours ne compte qu'après le commit :
+  // un réveil interrompu est simplement oublié
+  if (log.count == CYCLE_LOG_SIZE)
+  {
+    log.count--;
+  }
+  CycleRecord &record = log.records[log.next];
+  memset(&record, 0, sizeof(record));
+  log.checksum = computeChecksum(log);
+  return record;
+}
+
+void cycleLogCommit(CycleLog &log)
+{
+  log.next = (log.next + 1) % CYCLE_LOG_SIZE;
+  if (log.count < CYCLE_LOG_SIZE)
+  {
+    log.count++;
+  }
+  log.checksum = computeChecksum(log);
+}
+
+const CycleRecord *cycleLogLast(const CycleLog &log)
+{
+  if (log.version != CYCLE_LOG_VERSION || log.count == 0 || log.next >= CYCLE_LOG_SIZE)
+  {
+    return nullptr;
+  }
+  return &log.records[(log.next + CYCLE_LOG_SIZE - 1) % CYCLE_LOG_SIZE];
+}
+
+unsigned long cycleRecordTotalMs(const CycleRecord &record)
+{
+  unsigned long total = 0;
+  for (int i = 0; i < CYCLE_PHASE_COUNT; i++)
+  {
+    total += record.phaseMs[i];
+  }
+  return total;
+}
+
+bool cycleLogCsvLine(const CycleLog &log, int index, char *buffer, int size)
+{
+  int length = 0;
+  if (index == 0)
+  {
+    length += snprintf(buffer, size, "heure");
+    for (int i = 0; i < CYCLE_PHASE_COUNT && length < size; i++)
+    {
+      length += snprintf(buffer + length, size - length, ",%s", cyclePhaseNames[i]);
+    }
+    if (length < size)
+    {
+      snprintf(buffer + length, size - length,
+               ",total,sommeil_leger,mv,tas,tas_min,pile_libre,octets,echecs,cause,suivant,source,"
+               "issue_wifi,issue_ntp,veille_s,http");
+    }
+    return true;
+  }
+  if (index > log.count)
+  {
+    return false;
+  }
+
+  int slot = (log.next + CYCLE_LOG_SIZE - log.count + index - 1) % CYCLE_LOG_SIZE;
+  const CycleRecord &record = log.records[slot];
+  length += snprintf(buffer, size, "%lu", (unsigned long)record.wakeTime);
+  for (int i = 0; i < CYCLE_PHASE_COUNT && length < size; i++)
+  {
+    length += snprintf(buffer + length, size - length, ",%u", record.phaseMs[i]);
+  }
+  if (length < size)
+  {
+    length += snprintf(buffer + length, size - length, ",%lu,%u,%u,%lu,%lu,%u,%lu,%u,%u,%u,%u,%u,%u,%lu",
+                       cycleRecordTotalMs(record), record.parkedMs, record.batteryMv, (unsigned long)record.freeHeap,
+                       (unsigned long)record.minFreeHeap, record.stackFree, (unsigned long)record.apiBytes,
+                       record.failures, record.wakeCause, record.nextWake, record.source, record.wifi, record.ntp,
+                       (unsigned long)record.sleepSeconds);
+  }
+  // Codes séparés par des '/' : une seule colonne
+  for (int i = 0; i < CYCLE_HTTP_CODES && length < size; i++)
+  {
+    length += snprintf(buffer + length, size - length, i == 0 ? ",%d" : "/%d", record.httpCodes[i]);
+  }
+  return true;
+}
@@ -0,0 +1,160 @@
+#include "EventLog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+static uint32_t computeChecksum(const EventCursor &cursor)
+{
+  return fnv1a(&cursor, offsetof(EventCursor, checksum));
+}
+
+static void seal(EventCursor &cursor)
+{
+  cursor.checksum = computeChecksum(cursor);
+}
+
+static bool isIntact(const EventCursor &cursor)
+{
+  return cursor.file < EVENT_LOG_FILES && cursor.count <= EVENT_FILE_RECORDS &&
+         cursor.checksum == computeChecksum(cursor);
+}
+
+static uint32_t recordCrc(const EventRecord &event)
+{
+  return crc32(&event, offsetof(EventRecord, crc));
+}
+
+void eventRecordFromCycle(EventRecord &event, const CycleRecord &record)
+{
+  // memset : octets de réserve à zéro, CRC reproductible
+  memset(&event, 0, sizeof(event));
+  event.wakeTime = record.wakeTime;
+  event.apiBytes = record.apiBytes;
+  event.sleepSeconds = record.sleepSeconds;
+  memcpy(event.httpCodes, record.httpCodes, sizeof(event.httpCodes));
+  unsigned long awakeMs = cycleRecordTotalMs(record);
+  event.awakeMs = awakeMs > 0xFFFF ? 0xFFFF : (uint16_t)awakeMs;
+  event.batteryMv = record.batteryMv;
+  event.wakeCause = record.wakeCause;
+  event.failures = record.failures;
+  event.ntp = record.ntp;
+  event.wifi = record.wifi;
+  event.source = record.source;
+  event.nextWake = record.nextWake;
+}
+
+// Dernier enregistrement intact du fichier, en remontant depuis la fin : false s'il n'y en a pas
+static bool lastIntact(LogFiles &files, int file, size_t count, EventRecord &event, size_t &index)
+{
+  for (index = count; index > 0; index--)
+  {
+    if (files.read(file, (index - 1) * EVENT_RECORD_SIZE, &event, sizeof(event)) && event.crc == recordCrc(event))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Position perdue (mémoire RTC remise à zéro) ou fichier qui ne correspond plus :
+// le fichier dont le dernier enregistrement intact a la plus grande séquence est le courant
+static void locate(LogFiles &files, EventCursor &cursor)
+{
+  if (isIntact(cursor) && files.size(cursor.file) == (size_t)cursor.count * EVENT_RECORD_SIZE)
+  {
+    return;
+  }
+  memset(&cursor, 0, sizeof(cursor));
+  // Journal vide : le premier ajout passe au fichier 0
+  cursor.file = EVENT_LOG_FILES - 1;
+  cursor.count = EVENT_FILE_RECORDS;
+  bool found = false;
+  for (int file = 0; file < EVENT_LOG_FILES; file++)
+  {
+    size_t size = files.size(file);
+    size_t count = size / EVENT_RECORD_SIZE;
+    EventRecord last;
+    size_t index;
+    if (!lastIntact(files, file, count, last, index) || (found && last.sequence < cursor.sequence))
+    {
+      continue;
+    }
+    found = true;
+    cursor.file = file;
+    cursor.sequence = last.sequence + 1;
+    // Fin tronquée ou abîmée : la suite va dans le fichier suivant plutôt qu'après
+    // des octets orphelins, les numéros perdus sont réattribués
+    bool clean = size % EVENT_RECORD_SIZE == 0 && index == count;
+    cursor.count = clean && count < EVENT_FILE_RECORDS ? count : EVENT_FILE_RECORDS;
+  }
+  seal(cursor);
+}
+
+bool eventLogAppend(LogFiles &files, EventCursor &cursor, EventRecord &event)
+{
+  locate(files, cursor);
+  if (cursor.count >= EVENT_FILE_RECORDS)
+  {
+    cursor.file = (cursor.file + 1) % EVENT_LOG_FILES;
+    cursor.count = 0;
+    files.remove(cursor.file);
+  }
+  event.sequence = cursor.sequence;
+  event.version = EVENT_RECORD_VERSION;
+  event.crc = recordCrc(event);
+  if (!files.append(cursor.file, &event, sizeof(event)))
+  {
+    // Taille du fichier incertaine : elle sera relue au prochain ajout
+    cursor.checksum = 0;
+    return false;
+  }
+  cursor.count++;
+  cursor.sequence++;
+  seal(cursor);
+  return true;
+}
+
+void eventLogRewind(LogFiles &files, EventCursor &cursor, EventLogReader &reader)
+{
+  locate(files, cursor);
+  reader.remaining = EVENT_LOG_FILES;
+  reader.file = (cursor.file + 1) % EVENT_LOG_FILES;
+  reader.index = 0;
+  reader.count = files.size(reader.file) / EVENT_RECORD_SIZE;
+  reader.skipped = 0;
+}
+
+bool eventLogNext(LogFiles &files, EventLogReader &reader, EventRecord &event)
+{
+  while (reader.remaining > 0)
+  {
+    if (reader.index >= reader.count)
+    {
+      reader.remaining--;
+      reader.file = (reader.file + 1) % EVENT_LOG_FILES;
+      reader.index = 0;
+      reader.count = reader.remaining > 0 ? files.size(reader.file) / EVENT_RECORD_SIZE : 0;
+      continue;
+    }
+    bool read = files.read(reader.file, reader.index * EVENT_RECORD_SIZE, &event, sizeof(event));
+    reader.index++;
+    if (read && event.crc == recordCrc(event))
+    {
+      return true;
+    }
+    reader.skipped++;
+  }
+  return false;
+}
+
+void eventRecordHex(const EventRecord &event, char *buffer, size_t size)
+{
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&event);
+  size_t length = snprintf(buffer, size, "ev ");
+  for (size_t i = 0; i < sizeof(event) && length < size; i++)
+  {
+    length += snprintf(buffer + length, size - length, "%02x", bytes[i]);
+  }
+}
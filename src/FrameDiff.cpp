@@ -0,0 +1,120 @@
+#include "FrameDiff.h"
+
+// Deux zones séparées de moins de lignes que ça sont rafraîchies ensemble
+static const int MERGE_GAP_ROWS = 8;
+
+static FrameRect unionRect(const FrameRect &a, const FrameRect &b)
+{
+  int x0 = a.x < b.x ? a.x : b.x;
+  int y0 = a.y < b.y ? a.y : b.y;
+  int x1 = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+  int y1 = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+  FrameRect result = {(int16_t)x0, (int16_t)y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+  return result;
+}
+
+// Fusionne les deux rectangles consécutifs les plus proches verticalement
+static int mergeClosest(FrameRect *rects, int count)
+{
+  int best = 0;
+  int bestGap = 0x7fff;
+  for (int i = 0; i + 1 < count; i++)
+  {
+    int gap = rects[i + 1].y - (rects[i].y + rects[i].h);
+    if (gap < bestGap)
+    {
+      bestGap = gap;
+      best = i;
+    }
+  }
+  rects[best] = unionRect(rects[best], rects[best + 1]);
+  for (int i = best + 1; i + 1 < count; i++)
+  {
+    rects[i] = rects[i + 1];
+  }
+  return count - 1;
+}
+
+int frameDiff(const uint8_t *previous, const uint8_t *current, int width, int height,
+              FrameRect *rects, int maxRects)
+{
+  const int stride = (width + 7) / 8;
+  int count = 0;
+
+  for (int y = 0; y < height; y++)
+  {
+    const uint8_t *before = previous + y * stride;
+    const uint8_t *after = current + y * stride;
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < stride; i++)
+    {
+      if (before[i] != after[i])
+      {
+        if (first < 0)
+        {
+          first = i;
+        }
+        last = i;
+      }
+    }
+    if (first < 0)
+    {
+      continue;
+    }
+
+    int x1 = (last + 1) * 8 > width ? width : (last + 1) * 8;
+    FrameRect row = {(int16_t)(first * 8), (int16_t)y, (int16_t)(x1 - first * 8), 1};
+
+    if (count > 0 && y - (rects[count - 1].y + rects[count - 1].h) <= MERGE_GAP_ROWS)
+    {
+      rects[count - 1] = unionRect(rects[count - 1], row);
+      continue;
+    }
+    if (count == maxRects)
+    {
+      count = mergeClosest(rects, count);
+    }
+    rects[count++] = row;
+  }
+
+  return count;
+}
+
+RefreshKind chooseRefresh(const RefreshMemory &memory, const FrameRect *rects, int count,
+                          int width, int height, int fullRefreshEvery)
+{
+  if (!memory.frameValid)
+  {
+    return REFRESH_FULL;
+  }
+  if (count == 0)
+  {
+    return REFRESH_NONE;
+  }
+  if (memory.partialCount >= fullRefreshEvery)
+  {
+    return REFRESH_FULL;
+  }
+
+  // Au-delà de la moitié de l'écran, le partiel ne fait plus gagner grand-chose
+  long dirtyArea = 0;
+  for (int i = 0; i < count; i++)
+  {
+    dirtyArea += (long)rects[i].w * rects[i].h;
+  }
+  return dirtyArea * 2 > (long)width * height ? REFRESH_FULL : REFRESH_PARTIAL;
+}
+
+void recordRefresh(RefreshMemory &memory, RefreshKind kind)
+{
+  if (kind == REFRESH_FULL)
+  {
+    memory.frameValid = true;
+    memory.partialCount = 0;
+  }
+  else if (kind == REFRESH_PARTIAL)
+  {
+    memory.partialCount++;
+  }
+}
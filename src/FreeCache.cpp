@@ -0,0 +1,103 @@
+#include "FreeCache.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+static uint32_t computeChecksum(const FreeCache &cache)
+{
+  return fnv1a(&cache, offsetof(FreeCache, checksum));
+}
+
+static bool isIntact(const FreeCache &cache)
+{
+  return cache.version == FREE_CACHE_VERSION && cache.checksum == computeChecksum(cache);
+}
+
+const FreeEntry *freeCacheFind(const FreeCache &cache, FreeEndpoint endpoint, const char *query)
+{
+  if (!isIntact(cache))
+  {
+    return nullptr;
+  }
+  const FreeEntry &entry = cache.entries[endpoint];
+  return entry.calendar.days > 0 && strcmp(entry.query, query) == 0 ? &entry : nullptr;
+}
+
+static void copyField(char *dest, size_t size, const char *src)
+{
+  // Tronqué, un validateur ne correspondrait plus à rien
+  if (strlen(src) < size)
+  {
+    strcpy(dest, src);
+  }
+}
+
+void freeCacheStore(FreeCache &cache, FreeEndpoint endpoint, const char *query, const char *etag,
+                    const char *lastModified, uint32_t bodyHash, const FreeCalendar &calendar)
+{
+  if (!isIntact(cache))
+  {
+    // memset pour que le padding soit déterministe dans le checksum
+    memset(&cache, 0, sizeof(cache));
+    cache.version = FREE_CACHE_VERSION;
+  }
+  FreeEntry &entry = cache.entries[endpoint];
+  memset(&entry, 0, sizeof(entry));
+  copyField(entry.query, sizeof(entry.query), query);
+  copyField(entry.etag, sizeof(entry.etag), etag);
+  copyField(entry.lastModified, sizeof(entry.lastModified), lastModified);
+  entry.bodyHash = bodyHash;
+  entry.calendar = calendar;
+  cache.checksum = computeChecksum(cache);
+}
+
+void freeCacheForget(FreeCache &cache)
+{
+  memset(&cache, 0, sizeof(cache));
+}
+
+static const char *frenchColors[] = {nullptr, "BLEU", "BLANC", "ROUGE"};
+
+static void copyColor(char *dest, DayColor color, const char *notAvailable)
+{
+  strncpy(dest, color != DAY_UNKNOWN ? frenchColors[color] : notAvailable, TEMPO_COLOR_LEN - 1);
+  dest[TEMPO_COLOR_LEN - 1] = '\0';
+}
+
+static void addDay(SeasonCounts &counts, const FreeCalendar &season, int ymd, DayColor color)
+{
+  if (color == DAY_UNKNOWN || season.lastYmd[1] >= ymd)
+  {
+    return;
+  }
+  counts.blue += color == DAY_BLUE;
+  counts.white += color == DAY_WHITE;
+  counts.red += color == DAY_RED;
+}
+
+bool freeCalendarResolve(const FreeCalendar &days, const FreeCalendar &season, int todayYmd, int tomorrowYmd,
+                         const char *notAvailable, TempoResult &result)
+{
+  // La réponse de la saison contient aussi les derniers jours connus
+  DayColor today = freeCalendarColor(days, todayYmd);
+  today = today != DAY_UNKNOWN ? today : freeCalendarColor(season, todayYmd);
+  DayColor tomorrow = freeCalendarColor(days, tomorrowYmd);
+  tomorrow = tomorrow != DAY_UNKNOWN ? tomorrow : freeCalendarColor(season, tomorrowYmd);
+  copyColor(result.todayColor, today, notAvailable);
+  copyColor(result.tomorrowColor, tomorrow, notAvailable);
+
+  SeasonCounts counts;
+  if (!freeCalendarCountsUntil(season, tomorrow != DAY_UNKNOWN ? tomorrowYmd : todayYmd, counts))
+  {
+    return false;
+  }
+  // Jours lus seulement dans la réponse courte, pas encore dans celle de la saison
+  addDay(counts, season, todayYmd, today);
+  addDay(counts, season, tomorrowYmd, tomorrow);
+  result.countBlue = counts.blue;
+  result.countWhite = counts.white;
+  result.countRed = counts.red;
+  return today != DAY_UNKNOWN;
+}
@@ -0,0 +1,153 @@
+#include "HttpBody.h"
+
+HttpBodyReader::HttpBodyReader(ByteReader &source, long contentLength, bool chunked)
+    : source(source), remaining(chunked ? 0 : contentLength), chunked(chunked)
+{
+  finished = !chunked && contentLength == 0;
+}
+
+static int hexValue(int c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Longueur de la ligne sans "\r\n", -1 si la connexion s'arrête avant
+int HttpBodyReader::readLine()
+{
+  int count = 0;
+  int c;
+  while ((c = source.read()) >= 0)
+  {
+    if (c == '\n')
+    {
+      return count;
+    }
+    if (c != '\r')
+    {
+      count++;
+    }
+  }
+  return -1;
+}
+
+// "1a3\r\n" : taille du morceau suivant en hexadécimal, 0 pour le dernier
+bool HttpBodyReader::startChunk()
+{
+  if (chunkStarted && readLine() != 0)
+  {
+    finished = true; // "\r\n" attendu après les données du morceau
+    return false;
+  }
+  chunkStarted = true;
+
+  long size = 0;
+  int c;
+  int digit;
+  while ((c = source.read()) >= 0 && (digit = hexValue(c)) >= 0)
+  {
+    size = size * 16 + digit;
+  }
+  if (c < 0 || (c != '\n' && readLine() < 0))
+  {
+    finished = true;
+    return false;
+  }
+  if (size == 0)
+  {
+    // En-têtes de fin éventuels jusqu'à la ligne vide
+    while (readLine() > 0)
+    {
+    }
+    finished = true;
+    return false;
+  }
+  remaining = size;
+  return true;
+}
+
+bool HttpBodyReader::fill()
+{
+  if (finished)
+  {
+    return false;
+  }
+  if (chunked && remaining == 0 && !startChunk())
+  {
+    return false;
+  }
+  // Jamais au-delà du corps : la suite appartient à la réponse suivante
+  size_t wanted = HTTP_BODY_BUFFER;
+  if (remaining >= 0 && (size_t)remaining < wanted)
+  {
+    wanted = (size_t)remaining;
+  }
+  length = source.readBytes(buffer, wanted);
+  position = 0;
+  if (length == 0)
+  {
+    finished = true;
+    return false;
+  }
+  if (remaining >= 0)
+  {
+    remaining -= (long)length;
+    if (remaining == 0 && !chunked)
+    {
+      finished = true;
+    }
+  }
+  return true;
+}
+
+int HttpBodyReader::read()
+{
+  if (position == length && !fill())
+  {
+    return -1;
+  }
+  total++;
+  return (unsigned char)buffer[position++];
+}
+
+size_t HttpBodyReader::readBytes(char *out, size_t count)
+{
+  size_t copied = 0;
+  while (copied < count)
+  {
+    if (position == length && !fill())
+    {
+      break;
+    }
+    size_t available = length - position;
+    size_t step = count - copied < available ? count - copied : available;
+    for (size_t i = 0; i < step; i++)
+    {
+      out[copied + i] = buffer[position + i];
+    }
+    position += step;
+    copied += step;
+  }
+  total += copied;
+  return copied;
+}
+
+void HttpBodyReader::drain()
+{
+  while (position < length || fill())
+  {
+    total += length - position;
+    position = length;
+  }
+}
@@ -0,0 +1,4 @@
+#include "PanelLayout.h"
+
+// Evalué par le compilateur : l'image est une constante en flash, rien n'est tracé au réveil
+constexpr FrameBitmap panelBackground = rasterizeBackground(panelLayout, sizeof(panelLayout) / sizeof(panelLayout[0]));
@@ -0,0 +1,254 @@
+#include "RteCalendar.h"
+
+#include <ArduinoJson.h>
+#include <stdio.h>
+#include <string.h>
+
+// Une date complète, une couleur et les deux clés, avec de la marge pour les
+// emplacements de 64 bits de l'hôte
+#define RTE_DAY_DOCUMENT_SIZE 192
+
+// Permet de regarder le caractère suivant sans le retirer du flux
+class PushbackReader : public ByteReader
+{
+public:
+  explicit PushbackReader(ByteReader &source) : source(source) {}
+
+  int read() override
+  {
+    if (pending >= 0)
+    {
+      int c = pending;
+      pending = -1;
+      return c;
+    }
+    return source.read();
+  }
+
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    if (length == 0)
+    {
+      return 0;
+    }
+    if (pending >= 0)
+    {
+      buffer[0] = (char)read();
+      return 1 + source.readBytes(buffer + 1, length - 1);
+    }
+    return source.readBytes(buffer, length);
+  }
+
+  void unread(int c) { pending = c; }
+
+  // Premier caractère qui n'est pas un blanc
+  int readToken()
+  {
+    int c;
+    do
+    {
+      c = read();
+    } while (c == ' ' || c == '\n' || c == '\r' || c == '\t');
+    return c;
+  }
+
+private:
+  ByteReader &source;
+  int pending = -1;
+};
+
+static bool skipTo(PushbackReader &reader, const char *pattern)
+{
+  size_t matched = 0;
+  size_t length = strlen(pattern);
+  int c;
+  while ((c = reader.read()) >= 0)
+  {
+    if (c == pattern[matched])
+    {
+      matched++;
+    }
+    else
+    {
+      matched = c == pattern[0] ? 1 : 0;
+    }
+    if (matched == length)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool rteCalendarParse(ByteReader &source, const char *today, const char *tomorrow, RteCalendar &calendar)
+{
+  calendar.today = DAY_UNKNOWN;
+  calendar.tomorrow = DAY_UNKNOWN;
+  calendar.counts = {0, 0, 0};
+  calendar.days = 0;
+
+  PushbackReader reader(source);
+  if (!skipTo(reader, "\"values\"") || reader.readToken() != ':' || reader.readToken() != '[')
+  {
+    return false;
+  }
+
+  StaticJsonDocument<64> filter;
+  filter["start_date"] = true;
+  filter["value"] = true;
+
+  int c = reader.readToken();
+  if (c == ']')
+  {
+    return true;
+  }
+  while (c == '{')
+  {
+    reader.unread(c);
+    StaticJsonDocument<RTE_DAY_DOCUMENT_SIZE> day;
+    if (deserializeJson(day, reader, DeserializationOption::Filter(filter)) != DeserializationError::Ok)
+    {
+      return false;
+    }
+
+    const char *date = day["start_date"] | "";
+    DayColor color = dayColorFromName(day["value"] | "");
+    if (color != DAY_UNKNOWN)
+    {
+      if (strncmp(date, today, 10) == 0)
+      {
+        calendar.today = color;
+      }
+      else if (strncmp(date, tomorrow, 10) == 0)
+      {
+        calendar.tomorrow = color;
+      }
+      calendar.counts.blue += color == DAY_BLUE;
+      calendar.counts.white += color == DAY_WHITE;
+      calendar.counts.red += color == DAY_RED;
+      calendar.days++;
+    }
+
+    c = reader.readToken();
+    if (c == ']')
+    {
+      return true;
+    }
+    c = c == ',' ? reader.readToken() : -1;
+  }
+  return false;
+}
+
+// Chaîne JSON dont le '"' ouvrant vient d'être lu, tronquée à size - 1 caractères.
+// Les échappements ne sont pas décodés : dates et couleurs n'en contiennent pas.
+static bool readString(PushbackReader &reader, char *buffer, size_t size)
+{
+  size_t length = 0;
+  int c;
+  while ((c = reader.read()) >= 0 && c != '"')
+  {
+    if (c == '\\')
+    {
+      c = reader.read();
+    }
+    if (length + 1 < size)
+    {
+      buffer[length++] = (char)c;
+    }
+  }
+  buffer[length] = '\0';
+  return c == '"';
+}
+
+static void addFreeDay(FreeCalendar &calendar, int ymd, DayColor color)
+{
+  calendar.counts.blue += color == DAY_BLUE;
+  calendar.counts.white += color == DAY_WHITE;
+  calendar.counts.red += color == DAY_RED;
+  calendar.days++;
+  if (ymd > calendar.lastYmd[1])
+  {
+    calendar.lastYmd[0] = calendar.lastYmd[1];
+    calendar.lastColor[0] = calendar.lastColor[1];
+    calendar.lastYmd[1] = ymd;
+    calendar.lastColor[1] = color;
+  }
+  else if (ymd > calendar.lastYmd[0])
+  {
+    calendar.lastYmd[0] = ymd;
+    calendar.lastColor[0] = color;
+  }
+}
+
+bool freeCalendarParse(ByteReader &source, FreeCalendar &calendar)
+{
+  memset(&calendar, 0, sizeof(calendar));
+
+  PushbackReader reader(source);
+  if (!skipTo(reader, "\"values\"") || reader.readToken() != ':' || reader.readToken() != '{')
+  {
+    return false;
+  }
+
+  int c = reader.readToken();
+  if (c == '}')
+  {
+    return true;
+  }
+  while (c == '"')
+  {
+    char date[16];
+    char color[16];
+    int year;
+    int month;
+    int day;
+    if (!readString(reader, date, sizeof(date)) || reader.readToken() != ':' || reader.readToken() != '"' ||
+        !readString(reader, color, sizeof(color)) || sscanf(date, "%4d-%2d-%2d", &year, &month, &day) != 3)
+    {
+      return false;
+    }
+    // Jour encore indéterminé côté RTE : ni compté ni gardé
+    DayColor dayColor = dayColorFromName(color);
+    if (dayColor != DAY_UNKNOWN)
+    {
+      addFreeDay(calendar, year * 10000 + month * 100 + day, dayColor);
+    }
+
+    c = reader.readToken();
+    if (c == '}')
+    {
+      return true;
+    }
+    c = c == ',' ? reader.readToken() : -1;
+  }
+  return false;
+}
+
+DayColor freeCalendarColor(const FreeCalendar &calendar, int ymd)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    if (calendar.lastYmd[i] != 0 && calendar.lastYmd[i] == ymd)
+    {
+      return (DayColor)calendar.lastColor[i];
+    }
+  }
+  return DAY_UNKNOWN;
+}
+
+bool freeCalendarCountsUntil(const FreeCalendar &calendar, int ymd, SeasonCounts &counts)
+{
+  counts = calendar.counts;
+  for (int i = 0; i < 2; i++)
+  {
+    if (calendar.lastYmd[i] > ymd)
+    {
+      DayColor color = (DayColor)calendar.lastColor[i];
+      counts.blue -= color == DAY_BLUE;
+      counts.white -= color == DAY_WHITE;
+      counts.red -= color == DAY_RED;
+    }
+  }
+  // Deux jours après ymd : d'autres, plus anciens, le sont peut-être aussi
+  return calendar.lastYmd[0] <= ymd || calendar.days <= 2;
+}
@@ -0,0 +1,145 @@
+#include "SeasonHistory.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+static uint32_t computeChecksum(const SeasonHistory &history)
+{
+  return fnv1a(&history, offsetof(SeasonHistory, checksum));
+}
+
+// Midi évite les surprises au changement d'heure
+static time_t noonOf(int ymd, int dayOffset)
+{
+  struct tm day = {};
+  day.tm_year = ymd / 10000 - 1900;
+  day.tm_mon = ymd / 100 % 100 - 1;
+  day.tm_mday = ymd % 100 + dayOffset;
+  day.tm_hour = 12;
+  day.tm_isdst = -1;
+  return mktime(&day);
+}
+
+DayColor dayColorFromName(const char *color)
+{
+  // La librairie renvoie le libellé de l'API : français ou anglais selon le service
+  if (strcmp(color, "BLEU") == 0 || strcmp(color, "BLUE") == 0)
+  {
+    return DAY_BLUE;
+  }
+  if (strcmp(color, "BLANC") == 0 || strcmp(color, "WHITE") == 0)
+  {
+    return DAY_WHITE;
+  }
+  if (strcmp(color, "ROUGE") == 0 || strcmp(color, "RED") == 0)
+  {
+    return DAY_RED;
+  }
+  return DAY_UNKNOWN;
+}
+
+int seasonDayIndex(int startYmd, const struct tm &day)
+{
+  int ymd = (day.tm_year + 1900) * 10000 + (day.tm_mon + 1) * 100 + day.tm_mday;
+  long index = (long)((noonOf(ymd, 0) - noonOf(startYmd, 0) + 43200) / 86400);
+  return index >= 0 && index < SEASON_MAX_DAYS ? (int)index : -1;
+}
+
+void seasonDayDate(char *buffer, int size, int startYmd, int index)
+{
+  time_t day = noonOf(startYmd, index);
+  struct tm timeinfo;
+  localtime_r(&day, &timeinfo);
+  strftime(buffer, size, "%Y-%m-%d", &timeinfo);
+}
+
+void seasonHistoryReset(SeasonHistory &history, int startYmd)
+{
+  memset(&history, 0, sizeof(history));
+  history.version = SEASON_HISTORY_VERSION;
+  history.startYmd = startYmd;
+  seasonHistorySeal(history);
+}
+
+bool seasonHistoryIsValid(const SeasonHistory &history, int startYmd)
+{
+  return history.version == SEASON_HISTORY_VERSION && history.startYmd == startYmd &&
+         history.bulkDays <= SEASON_MAX_DAYS && history.checksum == computeChecksum(history);
+}
+
+void seasonHistorySeal(SeasonHistory &history)
+{
+  history.checksum = computeChecksum(history);
+}
+
+DayColor seasonHistoryGet(const SeasonHistory &history, int day)
+{
+  if (day < history.bulkDays || day >= SEASON_MAX_DAYS)
+  {
+    return DAY_UNKNOWN;
+  }
+  return (DayColor)((history.days[day / 4] >> (day % 4 * 2)) & 3);
+}
+
+void seasonHistorySet(SeasonHistory &history, int day, DayColor color)
+{
+  if (day < history.bulkDays || day >= SEASON_MAX_DAYS)
+  {
+    return;
+  }
+  int shift = day % 4 * 2;
+  history.days[day / 4] = (uint8_t)((history.days[day / 4] & ~(3 << shift)) | (color << shift));
+}
+
+int seasonHistoryFirstUnknown(const SeasonHistory &history, int untilDay)
+{
+  for (int day = history.bulkDays; day < untilDay; day++)
+  {
+    if (seasonHistoryGet(history, day) == DAY_UNKNOWN)
+    {
+      return day;
+    }
+  }
+  return untilDay;
+}
+
+void seasonHistoryMergeTotals(SeasonHistory &history, int fromDay, int toDay, const SeasonCounts &totals)
+{
+  // Les jours connus un par un avant fromDay passent dans les totaux
+  SeasonCounts before = seasonHistoryCount(history, fromDay);
+  history.bulkBlue = before.blue + totals.blue;
+  history.bulkWhite = before.white + totals.white;
+  history.bulkRed = before.red + totals.red;
+  history.bulkDays = toDay;
+  // Au-delà des totaux, les jours sont de nouveau notés un par un
+  for (int day = 0; day < toDay; day++)
+  {
+    history.days[day / 4] &= (uint8_t)~(3 << (day % 4 * 2));
+  }
+}
+
+SeasonCounts seasonHistoryCount(const SeasonHistory &history, int untilDay)
+{
+  SeasonCounts counts = {history.bulkBlue, history.bulkWhite, history.bulkRed};
+  for (int day = history.bulkDays; day < untilDay && day < SEASON_MAX_DAYS; day++)
+  {
+    switch (seasonHistoryGet(history, day))
+    {
+    case DAY_BLUE:
+      counts.blue++;
+      break;
+    case DAY_WHITE:
+      counts.white++;
+      break;
+    case DAY_RED:
+      counts.red++;
+      break;
+    default:
+      break;
+    }
+  }
+  return counts;
+}
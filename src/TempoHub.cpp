@@ -0,0 +1,39 @@
+#include "TempoHub.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int tempoHubFormat(char *buffer, size_t size, const TempoState &state)
+{
+  if (!tempoStateIsIntact(state))
+  {
+    return 0;
+  }
+  int length = snprintf(buffer, size, "tempo %d %ld %s %s %d %d %d\n", TEMPO_HUB_VERSION, (long)state.dateYmd,
+                        state.todayColor, state.tomorrowColor, state.countBlue, state.countWhite,
+                        state.countRed);
+  return length > 0 && (size_t)length < size ? length : 0;
+}
+
+bool tempoHubParse(const char *line, int todayYmd, TempoResult &result)
+{
+  int version = 0;
+  long dateYmd = 0;
+  char today[TEMPO_COLOR_LEN];
+  char tomorrow[TEMPO_COLOR_LEN];
+  int blue = 0;
+  int white = 0;
+  int red = 0;
+  // %11s : TEMPO_COLOR_LEN - 1
+  if (sscanf(line, "tempo %d %ld %11s %11s %d %d %d", &version, &dateYmd, today, tomorrow, &blue, &white, &red) != 7 ||
+      version != TEMPO_HUB_VERSION || dateYmd != todayYmd)
+  {
+    return false;
+  }
+  strcpy(result.todayColor, today);
+  strcpy(result.tomorrowColor, tomorrow);
+  result.countBlue = blue;
+  result.countWhite = white;
+  result.countRed = red;
+  return true;
+}
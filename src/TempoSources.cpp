@@ -0,0 +1,122 @@
+#include "TempoSources.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+const char *tempoSourceNames[SOURCE_NONE + 1] = {"hub", "compte", "libre", "cache", "aucune"};
+
+// Valeurs de départ d'une source jamais essayée : le hub répond en quelques
+// dizaines de ms ou pas du tout (HUB_TIMEOUT_MS), une API demande une poignée
+// de main TLS et peut tenir jusqu'au délai du budget.
+static const uint16_t nominalSuccessMs[SOURCE_NETWORK_COUNT] = {100, 1500, 1500};
+static const uint16_t nominalFailureMs[SOURCE_NETWORK_COUNT] = {1500, 3000, 3000};
+#define NOMINAL_SUCCESS_RATE 230 // 90 %
+
+// Une source tombée au fond du classement est réessayée en tête après ce délai,
+// sinon un hub revenu ne serait plus jamais interrogé
+#define SOURCE_PROBE_SECONDS 3600
+// Attente minimale avant de lancer une deuxième source
+#define RACE_MIN_MS 1000UL
+
+static uint32_t computeChecksum(const SourceHistory &history)
+{
+  return fnv1a(&history, offsetof(SourceHistory, checksum));
+}
+
+static void resetIfCorrupt(SourceHistory &history)
+{
+  if (history.version == SOURCE_HISTORY_VERSION && history.checksum == computeChecksum(history))
+  {
+    return;
+  }
+  // memset pour que le padding soit déterministe dans le checksum
+  memset(&history, 0, sizeof(history));
+  history.version = SOURCE_HISTORY_VERSION;
+  for (int i = 0; i < SOURCE_NETWORK_COUNT; i++)
+  {
+    history.sources[i].successMs = nominalSuccessMs[i];
+    history.sources[i].failureMs = nominalFailureMs[i];
+    history.sources[i].successRate = NOMINAL_SUCCESS_RATE;
+  }
+  history.checksum = computeChecksum(history);
+}
+
+// Moyenne glissante, poids 1/4 pour la nouvelle valeur
+static unsigned long smooth(unsigned long average, unsigned long sample)
+{
+  return (average * 3 + sample) / 4;
+}
+
+void sourceHistoryRecord(SourceHistory &history, TempoSource source, bool success, unsigned long ms, time_t now)
+{
+  if (source >= SOURCE_NETWORK_COUNT)
+  {
+    return;
+  }
+  resetIfCorrupt(history);
+  SourceStats &stats = history.sources[source];
+  ms = ms < UINT16_MAX ? ms : UINT16_MAX;
+  if (success)
+  {
+    stats.successMs = smooth(stats.successMs, ms);
+  }
+  else
+  {
+    stats.failureMs = smooth(stats.failureMs, ms);
+  }
+  stats.successRate = smooth(stats.successRate, success ? 255 : 0);
+  stats.lastTry = now;
+  history.checksum = computeChecksum(history);
+}
+
+// Temps moyen avant d'obtenir les couleurs en commençant par cette source :
+// durée d'un essai divisée par la probabilité qu'il réussisse. Trier par ce
+// rapport minimise l'attente quand les sources sont essayées l'une après l'autre.
+static unsigned long expectedMs(const SourceStats &stats, time_t now)
+{
+  unsigned long rate = stats.successRate;
+  if (rate < NOMINAL_SUCCESS_RATE && now - (time_t)stats.lastTry > SOURCE_PROBE_SECONDS)
+  {
+    rate = NOMINAL_SUCCESS_RATE;
+  }
+  rate = rate > 5 ? rate : 5;
+  unsigned long attempt = (stats.successMs * rate + stats.failureMs * (255 - rate)) / 255;
+  return attempt * 255 / rate;
+}
+
+int sourceOrder(const SourceHistory &history, unsigned enabled, const TempoSource *preference, time_t now,
+                TempoSource *order)
+{
+  SourceHistory current = history;
+  resetIfCorrupt(current);
+  int count = 0;
+  for (int i = 0; i < SOURCE_NETWORK_COUNT; i++)
+  {
+    TempoSource source = preference[i];
+    if (!(enabled & (1u << source)))
+    {
+      continue;
+    }
+    // Insertion stable : à temps égal, l'ordre de préférence est gardé
+    unsigned long expected = expectedMs(current.sources[source], now);
+    int at = count;
+    while (at > 0 && expectedMs(current.sources[order[at - 1]], now) > expected)
+    {
+      order[at] = order[at - 1];
+      at--;
+    }
+    order[at] = source;
+    count++;
+  }
+  return count;
+}
+
+unsigned long sourceRaceDelayMs(const SourceHistory &history, TempoSource source)
+{
+  SourceHistory current = history;
+  resetIfCorrupt(current);
+  unsigned long delay = 2UL * current.sources[source].successMs;
+  return delay > RACE_MIN_MS ? delay : RACE_MIN_MS;
+}
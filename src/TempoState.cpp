@@ -0,0 +1,91 @@
+#include "TempoState.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+static uint32_t computeChecksum(const TempoState &state)
+{
+  // tout ce qui précède le checksum
+  return fnv1a(&state, offsetof(TempoState, checksum));
+}
+
+static void copyColor(char *dest, const char *src)
+{
+  strncpy(dest, src, TEMPO_COLOR_LEN - 1);
+  dest[TEMPO_COLOR_LEN - 1] = '\0';
+}
+
+static int yesterdayYmd(const struct tm &now)
+{
+  struct tm yesterday = now;
+  yesterday.tm_mday -= 1;
+  yesterday.tm_hour = 12; // évite les surprises au changement d'heure
+  mktime(&yesterday);
+  return tempoDateYmd(yesterday);
+}
+
+int tempoDateYmd(const struct tm &timeinfo)
+{
+  return (timeinfo.tm_year + 1900) * 10000 + (timeinfo.tm_mon + 1) * 100 + timeinfo.tm_mday;
+}
+
+void tempoStateStore(TempoState &state, int dateYmd,
+                     const char *todayColor, const char *tomorrowColor,
+                     int countBlue, int countWhite, int countRed)
+{
+  // memset pour que le padding soit déterministe dans le checksum
+  memset(&state, 0, sizeof(state));
+  state.version = TEMPO_STATE_VERSION;
+  state.dateYmd = dateYmd;
+  copyColor(state.todayColor, todayColor);
+  copyColor(state.tomorrowColor, tomorrowColor);
+  state.countBlue = countBlue;
+  state.countWhite = countWhite;
+  state.countRed = countRed;
+  state.checksum = computeChecksum(state);
+}
+
+void tempoStateInvalidate(TempoState &state)
+{
+  memset(&state, 0, sizeof(state));
+}
+
+bool tempoStateIsIntact(const TempoState &state)
+{
+  return state.version == TEMPO_STATE_VERSION && state.checksum == computeChecksum(state);
+}
+
+TempoCacheStatus tempoStateLookup(const TempoState &state, const struct tm &now,
+                                  int publicationMinute, const char *notAvailable)
+{
+  if (!tempoStateIsIntact(state) || strcmp(state.todayColor, notAvailable) == 0)
+  {
+    return TEMPO_CACHE_INVALID;
+  }
+
+  bool tomorrowKnown = strcmp(state.tomorrowColor, notAvailable) != 0;
+  bool beforePublication = now.tm_hour * 60 + now.tm_min < publicationMinute;
+
+  if (state.dateYmd == tempoDateYmd(now))
+  {
+    // Demain est connu, ou il est trop tôt pour qu'il le soit
+    return (tomorrowKnown || beforePublication) ? TEMPO_CACHE_FRESH : TEMPO_CACHE_INVALID;
+  }
+
+  if (state.dateYmd == yesterdayYmd(now) && tomorrowKnown && beforePublication)
+  {
+    return TEMPO_CACHE_ROLLOVER;
+  }
+
+  return TEMPO_CACHE_INVALID;
+}
+
+void tempoStateRollOver(TempoState &state, int dateYmd, const char *notAvailable)
+{
+  // Les compteurs de saison sont recalés au prochain appel réseau
+  TempoState previous = state;
+  tempoStateStore(state, dateYmd, previous.tomorrowColor, notAvailable,
+                  previous.countBlue, previous.countWhite, previous.countRed);
+}
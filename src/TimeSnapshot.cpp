@@ -0,0 +1,86 @@
+#include "TimeSnapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr const char *frenchDays[7] = {"Dim", "Lun", "Mar", "Mer", "Jeu", "Ven", "Sam"};
+static constexpr const char *frenchMonths[12] = {"Jan", "Fev", "Mar", "Avr", "Mai", "Juin",
+                                                 "Juil", "Aou", "Sep", "Oct", "Nov", "Dec"};
+
+// Jours depuis le 1er janvier 1970 d'une date du calendrier grégorien
+static long daysFromCivil(int year, int month, int day)
+{
+  year -= month <= 2;
+  long era = (year >= 0 ? year : year - 399) / 400;
+  long yearOfEra = year - era * 400;
+  long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + dayOfEra - 719468;
+}
+
+// Ecart entre l'heure locale et UTC à l'instant donné
+static int utcOffsetMinutes(time_t time, const struct tm &local)
+{
+  long long localSeconds = (long long)daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday) * 86400 +
+                           local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+  return (int)((localSeconds - (long long)time) / 60);
+}
+
+void takeTimeSnapshot(TimeSnapshot &snapshot, time_t now)
+{
+  snapshot.now = now;
+  localtime_r(&now, &snapshot.local);
+
+  for (int delta = 0; delta < SNAPSHOT_DAYS; delta++)
+  {
+    struct tm midnight = snapshot.local;
+    midnight.tm_mday += delta;
+    midnight.tm_hour = 0;
+    midnight.tm_min = 0;
+    midnight.tm_sec = 0;
+    midnight.tm_isdst = -1;
+    time_t time = mktime(&midnight); // normalise aussi les fins de mois et d'année
+
+    SnapshotDay &day = snapshot.days[delta];
+    day.year = midnight.tm_year + 1900;
+    day.month = midnight.tm_mon + 1;
+    day.mday = midnight.tm_mday;
+    day.wday = midnight.tm_wday;
+    day.utcOffsetMinutes = utcOffsetMinutes(time, midnight);
+  }
+}
+
+int snapshotDateYmd(const TimeSnapshot &snapshot, int delta)
+{
+  const SnapshotDay &day = snapshot.days[delta];
+  return day.year * 10000 + day.month * 100 + day.mday;
+}
+
+void formatRteDate(char *buffer, size_t size, const TimeSnapshot &snapshot, int delta)
+{
+  const SnapshotDay &day = snapshot.days[delta];
+  int offset = abs(day.utcOffsetMinutes);
+  snprintf(buffer, size, "%04d-%02d-%02dT00:00:00%c%02d:%02d", day.year, day.month, day.mday,
+           day.utcOffsetMinutes < 0 ? '-' : '+', offset / 60, offset % 60);
+}
+
+void formatDayLabel(char *buffer, size_t size, const TimeSnapshot &snapshot, int delta)
+{
+  const SnapshotDay &day = snapshot.days[delta];
+  snprintf(buffer, size, "%s %02d %s", frenchDays[day.wday % 7], day.mday, frenchMonths[(day.month - 1) % 12]);
+}
+
+void formatRefreshLabel(char *buffer, size_t size, time_t refreshTime, bool withTime)
+{
+  struct tm timeinfo;
+  localtime_r(&refreshTime, &timeinfo);
+  const char *month = frenchMonths[timeinfo.tm_mon % 12];
+  if (withTime)
+  {
+    snprintf(buffer, size, "%02d %s %02d:%02d", timeinfo.tm_mday, month, timeinfo.tm_hour, timeinfo.tm_min);
+  }
+  else
+  {
+    snprintf(buffer, size, "%02d %s", timeinfo.tm_mday, month);
+  }
+}
@@ -0,0 +1,17 @@
+#include "WakeBudget.h"
+
+unsigned long wakeBudgetStageMs(const WakeBudget &budget, unsigned long nowMs, unsigned long stageMaxMs)
+{
+  unsigned long usable = budget.budgetMs > budget.reserveMs ? budget.budgetMs - budget.reserveMs : 0;
+  if (nowMs >= usable)
+  {
+    return 0;
+  }
+  unsigned long remaining = usable - nowMs;
+  return remaining < stageMaxMs ? remaining : stageMaxMs;
+}
+
+bool wakeBudgetExhausted(const WakeBudget &budget, unsigned long nowMs)
+{
+  return wakeBudgetStageMs(budget, nowMs, 1) == 0;
+}
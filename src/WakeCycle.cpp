@@ -0,0 +1,1133 @@
+#include "WakeCycle.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Checksum.h"
+#include "SeasonHistory.h"
+#include "TempoHub.h"
+
+static const int MINUTES_PER_DAY = 24 * 60;
+
+static void logf(Board &board, const char *format, ...)
+{
+  char line[128];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  board.log(line);
+}
+
+// Ajoute la durée de sa portée à une phase du réveil en cours
+class PhaseTimer
+{
+public:
+  PhaseTimer(Hal &hal, RtcState &rtc, CyclePhase phase)
+      : board(hal.board), record(rtc.cycles.records[rtc.cycles.next]), phase(phase), start(hal.board.micros()) {}
+
+  ~PhaseTimer()
+  {
+    uint64_t total = record.phaseMs[phase] + (board.micros() - start + 500) / 1000;
+    record.phaseMs[phase] = total > 0xFFFF ? 0xFFFF : (uint16_t)total;
+  }
+
+private:
+  Board &board;
+  CycleRecord &record;
+  CyclePhase phase;
+  uint64_t start;
+};
+
+static bool isPlausible(const struct tm &timeinfo)
+{
+  return timeinfo.tm_year > (2016 - 1900);
+}
+
+time_t roundRefreshTime(time_t now, int granularityMinutes)
+{
+  if (granularityMinutes <= 1)
+  {
+    return now;
+  }
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  int minutes = timeinfo.tm_hour * 60 + timeinfo.tm_min;
+  minutes = granularityMinutes >= MINUTES_PER_DAY ? 0 : minutes - minutes % granularityMinutes;
+  timeinfo.tm_hour = minutes / 60;
+  timeinfo.tm_min = minutes % 60;
+  timeinfo.tm_sec = 0;
+  timeinfo.tm_isdst = -1;
+  return mktime(&timeinfo);
+}
+
+uint32_t tempoViewHash(const TempoView &view, int dateYmd)
+{
+  // Sous 25% le pourcentage est écrit, au-dessus seul le nombre de barres compte
+  int battery = view.batteryPercentage < 25 ? view.batteryPercentage : 100 + (int)lround(view.batteryPercentage / 25.0);
+  struct tm refresh;
+  localtime_r(&view.refreshTime, &refresh);
+  char content[112];
+  int length = snprintf(content, sizeof(content), "%d|%s|%s|%d|%d|%d|%d|%d|%02d:%02d|%d",
+                        dateYmd, view.todayColor, view.tomorrowColor, view.countWhite, view.countRed,
+                        battery, view.batteryDaysLeft, tempoDateYmd(refresh),
+                        view.refreshWithTime ? refresh.tm_hour : 0, view.refreshWithTime ? refresh.tm_min : 0,
+                        view.stale);
+  uint32_t hash = fnv1a(content, length);
+  return hash == 0 ? 1 : hash;
+}
+
+static bool knowsToday(const RtcState &rtc, const WakeConfig &config, const struct tm &today)
+{
+  return tempoStateIsIntact(rtc.tempo) && rtc.tempo.dateYmd == tempoDateYmd(today) &&
+         strcmp(rtc.tempo.todayColor, config.notAvailable) != 0;
+}
+
+// Le hub se réveille aux mêmes heures, il lui faut quelques secondes pour l'API
+#define HUB_CLIENT_DELAY_SECONDS 120
+
+static WakeDecision decideNextWake(Hal &hal, const WakeConfig &config, RtcState &rtc, bool batteryLow)
+{
+  time_t now = hal.clock.now();
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+
+  WakeInputs inputs;
+  inputs.now = isPlausible(timeinfo) ? now : 0;
+  inputs.todayKnown = inputs.now != 0 && knowsToday(rtc, config, timeinfo);
+  inputs.tomorrowKnown = inputs.todayKnown && strcmp(rtc.tempo.tomorrowColor, config.notAvailable) != 0;
+  inputs.failures = rtc.counterRetry;
+  inputs.batteryLow = batteryLow;
+  inputs.random = hal.board.random32();
+  WakeDecision decision = scheduleNextWake(config.schedule, inputs);
+  // Client d'un hub : réveillé après lui, quand il a déjà interrogé l'API
+  if (config.hubHost != nullptr && !config.hubServe && decision.reason != WAKE_RETRY)
+  {
+    decision.sleepSeconds += HUB_CLIENT_DELAY_SECONDS;
+    decision.wakeAt += decision.wakeAt != 0 ? HUB_CLIENT_DELAY_SECONDS : 0;
+  }
+
+  char buffer[64];
+  if (decision.wakeAt != 0)
+  {
+    localtime_r(&decision.wakeAt, &timeinfo);
+    strftime(buffer, sizeof(buffer), "%A, %B %d %Y %H:%M:%S", &timeinfo);
+    logf(hal.board, "L'heure du prochain réveil est : %s (%s)", buffer, wakeReasonNames[decision.reason]);
+
+    localtime_r(&now, &timeinfo);
+    strftime(buffer, sizeof(buffer), "%A, %B %d %Y %H:%M:%S", &timeinfo);
+    logf(hal.board, "La date courante est: %s", buffer);
+  }
+  logf(hal.board, "Durée de sommeil en secondes: %lu", (unsigned long)decision.sleepSeconds);
+  return decision;
+}
+
+// 'd' : journal des réveils en mémoire RTC, 'e' : journal d'événements en flash
+struct DumpRequest
+{
+  bool cycles;
+  bool events;
+};
+
+static DumpRequest dumpRequested(Hal &hal, const WakeConfig &config)
+{
+  DumpRequest request = {config.dumpCycleLog, false};
+  for (int command = hal.board.readCommand(); command >= 0; command = hal.board.readCommand())
+  {
+    request.cycles = request.cycles || command == 'd';
+    request.events = request.events || command == 'e';
+  }
+  return request;
+}
+
+static void dumpCycleLog(Hal &hal, const RtcState &rtc)
+{
+  char line[200];
+  hal.board.log("--- journal des réveils (CSV, ms) ---");
+  for (int i = 0; cycleLogCsvLine(rtc.cycles, i, line, sizeof(line)); i++)
+  {
+    hal.board.log(line);
+  }
+  hal.board.log("--- fin du journal ---");
+}
+
+// Une ligne par enregistrement, du plus ancien au plus récent, pour tools/event_log.py
+static void dumpEventLog(Hal &hal, RtcState &rtc)
+{
+  char line[EVENT_HEX_LEN];
+  EventLogReader reader;
+  EventRecord event;
+  int count = 0;
+  hal.board.log("--- journal d'événements (hex) ---");
+  eventLogRewind(hal.logFiles, rtc.events, reader);
+  while (eventLogNext(hal.logFiles, reader, event))
+  {
+    eventRecordHex(event, line, sizeof(line));
+    hal.board.log(line);
+    count++;
+  }
+  logf(hal.board, "--- fin du journal : %d enregistrements, %d illisibles ---", count, reader.skipped);
+}
+
+// Résumé du réveil qui vient de se terminer, après l'écriture de la mémoire RTC
+static void appendEventLog(Hal &hal, RtcState &rtc, const CycleRecord &record)
+{
+  EventRecord event;
+  eventRecordFromCycle(event, record);
+  if (!eventLogAppend(hal.logFiles, rtc.events, event))
+  {
+    hal.board.log("Journal d'événements : écriture impossible.");
+  }
+}
+
+// Rôle hub : connecté jusqu'au réveil suivant, puis une seconde de deep sleep pour
+// repartir d'un réveil normal, mémoire RTC comprise. Sans WiFi, nouvel essai bientôt.
+#define HUB_CONNECT_MS 10000
+#define HUB_RESTART_SECONDS 1
+#define HUB_RETRY_SECONDS 60
+
+static uint64_t serveHub(Hal &hal, const WakeConfig &config, RtcState &rtc, uint64_t seconds)
+{
+  if (!hal.network.isConnected())
+  {
+    hal.network.startConnect(config.wifiSsid, config.wifiKey);
+    if (!hal.network.finishConnect(HUB_CONNECT_MS))
+    {
+      hal.board.log("Hub : WiFi indisponible, rien à servir.");
+      return seconds < HUB_RETRY_SECONDS ? seconds : HUB_RETRY_SECONDS;
+    }
+  }
+  char line[TEMPO_HUB_LINE_LEN] = "";
+  tempoHubFormat(line, sizeof(line), rtc.tempo);
+  logf(hal.board, "Hub : couleurs servies pendant %lu s.", (unsigned long)seconds);
+  unsigned long start = hal.board.millis();
+  hal.hub.serve(line, seconds);
+  uint64_t served = (hal.board.millis() - start) / 1000;
+  if (served < seconds)
+  {
+    hal.board.log("Hub : WiFi perdu.");
+    uint64_t remaining = seconds - served;
+    return remaining < HUB_RETRY_SECONDS ? remaining : HUB_RETRY_SECONDS;
+  }
+  return HUB_RESTART_SECONDS;
+}
+
+// Course de fetchTempo : la source lancée en tâche de fond peut tourner encore
+// quand l'autre l'a emporté. Attendue jusqu'à la fin de son délai avant de couper
+// le WiFi sous sa requête ou de dormir.
+#define RACE_GRACE_MS 1000
+static TempoSource raceSource = SOURCE_NONE;
+static unsigned long raceDeadlineMs = 0;
+
+static void settleRace(Hal &hal)
+{
+  if (raceSource == SOURCE_NONE)
+  {
+    return;
+  }
+  unsigned long now = hal.board.millis();
+  if (!hal.board.waitBackground(raceDeadlineMs > now ? raceDeadlineMs - now : 0))
+  {
+    logf(hal.board, "Source %s toujours en cours après son délai.", tempoSourceNames[raceSource]);
+  }
+  raceSource = SOURCE_NONE;
+}
+
+// Après un appui sur le bouton servi par le cache, le réveil déjà programmé reste
+// le bon : le recalculer repousserait un nouvel essai en attente
+static bool keepScheduledWake(Hal &hal, const RtcState &rtc, WakeDecision &decision)
+{
+  time_t now = hal.clock.now();
+  if (rtc.scheduledWake.wakeAt <= now)
+  {
+    return false;
+  }
+  decision = rtc.scheduledWake;
+  decision.sleepSeconds = (uint64_t)(rtc.scheduledWake.wakeAt - now);
+  logf(hal.board, "Réveil programmé conservé (%s), dans %lu s.", wakeReasonNames[decision.reason],
+       (unsigned long)decision.sleepSeconds);
+  return true;
+}
+
+static void goToDeepSleepUntilNextWakeup(Hal &hal, const WakeConfig &config, RtcState &rtc, bool batteryLow,
+                                         bool keepSchedule)
+{
+  settleRace(hal);
+  CycleRecord &record = rtc.cycles.records[rtc.cycles.next];
+  WakeDecision decision;
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_SLEEP);
+    if (!keepSchedule || !keepScheduledWake(hal, rtc, decision))
+    {
+      decision = decideNextWake(hal, config, rtc, batteryLow);
+    }
+  }
+  rtc.scheduledWake = decision;
+  if (record.wakeTime == 0 && decision.wakeAt != 0)
+  {
+    // Heure obtenue en cours de réveil (NTP) : on en déduit celle du réveil
+    record.wakeTime = (uint32_t)(hal.clock.now() - (time_t)(hal.board.millis() / 1000));
+  }
+  record.freeHeap = hal.board.freeHeap();
+  record.minFreeHeap = hal.board.minFreeHeap();
+  uint32_t stackFree = hal.board.stackFree();
+  record.stackFree = stackFree > 0xFFFF ? 0xFFFF : stackFree;
+  record.failures = rtc.counterRetry > 0xFF ? 0xFF : rtc.counterRetry;
+  record.nextWake = decision.reason;
+  uint64_t sleepSeconds = clockDriftSleepSeconds(rtc.drift, decision.sleepSeconds);
+  record.sleepSeconds = sleepSeconds > UINT32_MAX ? UINT32_MAX : (uint32_t)sleepSeconds;
+  cycleLogCommit(rtc.cycles);
+  appendEventLog(hal, rtc, record);
+  logf(hal.board, "Réveil terminé en %lu ms.", cycleRecordTotalMs(record));
+  logf(hal.board, "Tas libre : %lu octets, minimum %lu. Pile jamais utilisée : %lu octets.",
+       (unsigned long)record.freeHeap, (unsigned long)record.minFreeHeap, (unsigned long)stackFree);
+
+  DumpRequest dump = dumpRequested(hal, config);
+  if (dump.cycles)
+  {
+    dumpCycleLog(hal, rtc);
+  }
+  if (dump.events)
+  {
+    dumpEventLog(hal, rtc);
+  }
+
+  if (config.hubServe)
+  {
+    sleepSeconds = serveHub(hal, config, rtc, sleepSeconds);
+  }
+  hal.board.log("Passage en mode sommeil profond jusqu'au prochain réveil.");
+  hal.board.deepSleep(sleepSeconds);
+}
+
+// Compense la dérive de l'horloge RTC depuis la dernière correction
+static void correctClockDrift(Hal &hal, RtcState &rtc)
+{
+  long correction = clockDriftCorrection(rtc.drift, hal.clock.now());
+  if (correction != 0)
+  {
+    hal.clock.adjust(correction);
+    logf(hal.board, "Dérive de l'horloge corrigée de %ld s (%.0f ppm).", correction, rtc.drift.driftPpm);
+  }
+}
+
+// Attente maximale de la réponse NTP, si le budget du réveil le permet
+#define NTP_MAX_WAIT_MS 10000
+
+static bool initializeTime(Hal &hal, const WakeConfig &config, RtcState &rtc)
+{
+  uint8_t &ntp = rtc.cycles.records[rtc.cycles.next].ntp;
+  time_t now = hal.clock.now();
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  bool needsSync = !isPlausible(timeinfo) ||
+                   clockDriftNeedsSync(rtc.drift, now, config.ntpMaxErrorSeconds, config.ntpMaxAgeSeconds);
+
+  if (!needsSync)
+  {
+    ntp = CYCLE_NTP_SKIPPED;
+    logf(hal.board, "Heure RTC suffisante (erreur estimée %.1f s), pas de NTP.",
+         clockDriftPredictedError(rtc.drift, now));
+    return true;
+  }
+
+  // If connected to WiFi, attempt to synchronize time with NTP
+  if (hal.network.isConnected())
+  {
+    hal.board.log("Tentative de synchronisation NTP...");
+    unsigned long startMs = hal.board.millis();
+    unsigned long waitMs = wakeBudgetStageMs(config.budget, startMs, NTP_MAX_WAIT_MS);
+    hal.clock.configureNtp(config.timeZone, config.ntpServer); // Configure time zone to adjust for daylight savings
+
+    // On sort dès la réponse, ou quand le temps laissé par le budget est écoulé
+    while (true)
+    {
+      if (hal.clock.ntpSynced())
+      {
+        time_t expected = now + (time_t)((hal.board.millis() - startMs + 500) / 1000);
+        clockDriftOnSync(rtc.drift, expected, hal.clock.now());
+        ntp = CYCLE_NTP_SYNCED;
+        logf(hal.board, "NTP time synchronized! Ecart RTC : %ld s.", (long)(expected - hal.clock.now()));
+        return true;
+      }
+      if (hal.board.millis() - startMs >= waitMs)
+      {
+        break;
+      }
+      hal.board.delay(200);
+    }
+
+    hal.board.log("Échec de synchronisation NTP, utilisation de l'heure RTC.");
+    ntp = CYCLE_NTP_FAILED;
+  }
+
+  // Regardless of WiFi or NTP sync, try to use RTC time
+  now = hal.clock.now();
+  localtime_r(&now, &timeinfo);
+  if (!isPlausible(timeinfo))
+  { // If year is not plausible, RTC time is not set
+    hal.board.log("Échec de récupération de l'heure RTC, veuillez vérifier si l'heure a été définie.");
+    return false;
+  }
+
+  hal.board.log("Heure RTC utilisée.");
+  return true;
+}
+
+// Au premier dessin du réveil, ou pendant la connexion WiFi
+static void preparePanel(Hal &hal, RtcState &rtc, bool &panelReady)
+{
+  if (!panelReady)
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_PANEL_INIT);
+    hal.panel.init();
+    panelReady = true;
+  }
+}
+
+static void printLine(Hal &hal, RtcState &rtc, bool &panelReady, const char *text)
+{
+  preparePanel(hal, rtc, panelReady);
+  PhaseTimer timer(hal, rtc, CYCLE_RENDER);
+  hal.panel.printLine(text);
+  rtc.screenHash = 0;
+}
+
+// La radio ne sert plus une fois l'image prête : coupée avant le rafraîchissement,
+// elle laisse le processeur dormir pendant que l'écran travaille
+static void updatePanel(Hal &hal, RtcState &rtc)
+{
+  settleRace(hal);
+  if (hal.network.isConnected())
+  {
+    hal.network.disconnect();
+  }
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_PANEL_UPDATE);
+    hal.panel.update();
+  }
+
+  PanelStats stats = hal.panel.stats();
+  CycleRecord &record = rtc.cycles.records[rtc.cycles.next];
+  unsigned long parked = record.parkedMs + stats.parkedMs;
+  record.parkedMs = parked > 0xFFFF ? 0xFFFF : (uint16_t)parked;
+  if (stats.parkedMs > 0)
+  {
+    logf(hal.board, "Rafraîchissement : %lu ms dont %lu ms en sommeil léger.", stats.updateMs, stats.parkedMs);
+  }
+}
+
+static TempoView viewFromState(const TempoState &state, const WakeConfig &config,
+                               const BatteryStatus &battery, const char *errorCode)
+{
+  TempoView view;
+  view.todayColor = state.todayColor;
+  view.tomorrowColor = state.tomorrowColor;
+  view.countBlue = state.countBlue;
+  view.countWhite = state.countWhite;
+  view.countRed = state.countRed;
+  view.batteryPercentage = battery.percentage;
+  view.batteryDaysLeft = battery.daysLeft;
+  view.tempoSansCompte = config.tempoSansCompte;
+  view.errorCode = errorCode;
+  view.todayLabel[0] = '\0';
+  view.tomorrowLabel[0] = '\0';
+  view.refreshTime = 0;
+  view.refreshWithTime = true;
+  view.refreshLabel[0] = '\0';
+  view.lastCycleMs = 0;
+  view.stale = false;
+  return view;
+}
+
+// stale : couleurs du cache que le réveil n'a pas pu vérifier, seule la date est
+// affichée pour que les nouveaux essais ne rallument pas l'écran
+static void showTempo(Hal &hal, const WakeConfig &config, RtcState &rtc, const TimeSnapshot &time,
+                      bool &panelReady, const BatteryStatus &battery, const char *errorCode, bool stale)
+{
+  TempoView view = viewFromState(rtc.tempo, config, battery, errorCode);
+  formatDayLabel(view.todayLabel, sizeof(view.todayLabel), time, 0);
+  formatDayLabel(view.tomorrowLabel, sizeof(view.tomorrowLabel), time, 1);
+  view.refreshTime = roundRefreshTime(time.now, stale ? MINUTES_PER_DAY : config.refreshGranularityMinutes);
+  view.refreshWithTime = !stale && config.refreshGranularityMinutes < MINUTES_PER_DAY;
+  view.stale = stale;
+  formatRefreshLabel(view.refreshLabel, sizeof(view.refreshLabel), view.refreshTime, view.refreshWithTime);
+  const CycleRecord *lastCycle = cycleLogLast(rtc.cycles);
+  view.lastCycleMs = lastCycle ? cycleRecordTotalMs(*lastCycle) : 0;
+
+  uint32_t hash = tempoViewHash(view, snapshotDateYmd(time, 0));
+  if (hash == rtc.screenHash)
+  {
+    hal.board.log("Contenu de l'écran inchangé : écran non alimenté.");
+    return;
+  }
+
+  preparePanel(hal, rtc, panelReady);
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_RENDER);
+    hal.panel.drawTempo(view);
+  }
+  updatePanel(hal, rtc);
+  rtc.screenHash = hash;
+  rtc.screenDateYmd = snapshotDateYmd(time, 0);
+}
+
+static bool displayFromCache(Hal &hal, const WakeConfig &config, RtcState &rtc, const TimeSnapshot &time,
+                             bool &panelReady, const BatteryStatus &battery)
+{
+  const struct tm &timeinfo = time.local;
+  if (!isPlausible(timeinfo))
+  {
+    hal.board.log("Cache Tempo ignoré : heure RTC invalide.");
+    return false;
+  }
+
+  int publicationMinute = config.schedule.publicationStart.hour * 60 + config.schedule.publicationStart.minute;
+  TempoCacheStatus status = tempoStateLookup(rtc.tempo, timeinfo, publicationMinute, config.notAvailable);
+  if (status == TEMPO_CACHE_INVALID)
+  {
+    hal.board.log("Cache Tempo absent ou périmé.");
+    return false;
+  }
+  if (status == TEMPO_CACHE_ROLLOVER)
+  {
+    hal.board.log("Cache Tempo : demain devient aujourd'hui.");
+    tempoStateRollOver(rtc.tempo, snapshotDateYmd(time, 0), config.notAvailable);
+  }
+
+  hal.board.log("Affichage depuis le cache Tempo.");
+  rtc.cycles.records[rtc.cycles.next].source = SOURCE_CACHE;
+  showTempo(hal, config, rtc, time, panelReady, battery, "cache", false);
+  return true;
+}
+
+// Après un échec ou un abandon : les dernières couleurs connues, si elles
+// décrivent encore aujourd'hui, plutôt qu'un écran d'erreur
+static bool displayStale(Hal &hal, const WakeConfig &config, RtcState &rtc, bool &panelReady,
+                         const BatteryStatus &battery)
+{
+  TimeSnapshot time;
+  takeTimeSnapshot(time, hal.clock.now());
+  if (!isPlausible(time.local))
+  {
+    return false;
+  }
+  // Publication ignorée : un demain inconnu reste inconnu
+  TempoCacheStatus status = tempoStateLookup(rtc.tempo, time.local, MINUTES_PER_DAY, config.notAvailable);
+  if (status == TEMPO_CACHE_INVALID)
+  {
+    return false;
+  }
+  if (status == TEMPO_CACHE_ROLLOVER)
+  {
+    tempoStateRollOver(rtc.tempo, snapshotDateYmd(time, 0), config.notAvailable);
+  }
+
+  hal.board.log("Affichage du cache, marqué comme non vérifié.");
+  rtc.cycles.records[rtc.cycles.next].source = SOURCE_CACHE;
+  showTempo(hal, config, rtc, time, panelReady, battery, "cache", true);
+  return true;
+}
+
+static void logBudget(Hal &hal, const WakeConfig &config)
+{
+  if (wakeBudgetExhausted(config.budget, hal.board.millis()))
+  {
+    logf(hal.board, "Budget du réveil (%lu ms) épuisé : étape abandonnée.", config.budget.budgetMs);
+  }
+}
+
+static void logConnectStats(Hal &hal)
+{
+  static const char *paths[] = {"scan complet", "point d'accès connu", "IP connue"};
+  NetworkStats stats = hal.network.stats();
+  logf(hal.board, "WiFi connecté en %lu ms (%s), rapides : %u réussies, %u échouées",
+       stats.connectMs, paths[stats.path], stats.fastHits, stats.fastMisses);
+}
+
+static void logApiStats(Hal &hal, RtcState &rtc, const ApiStats &stats)
+{
+  logf(hal.board, "API : %u requêtes, %u connexions TLS en %lu ms, jeton réutilisé %u fois",
+       stats.requests, stats.connections, stats.fetchMs, stats.tokenReuses);
+  logf(hal.board, "API : %lu octets reçus, %u réponses non modifiées (304)", (unsigned long)stats.bytes,
+       stats.notModified);
+  rtc.cycles.records[rtc.cycles.next].apiBytes = stats.bytes;
+}
+
+#define SEASON_HISTORY_KEY "saison"
+
+// Mode avec compte : l'historique des couleurs de la saison permet de ne
+// demander à l'API que les jours qui y manquent
+struct SeasonQuery
+{
+  SeasonHistory history;
+  uint32_t storedChecksum; // pour n'écrire la flash que si l'historique change
+  int today;               // jour de la saison, -1 si l'historique est inutilisable
+  int from;                // premier jour demandé à l'API
+};
+
+static int parseYmd(const char *date)
+{
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  if (sscanf(date, "%d-%d-%d", &year, &month, &day) != 3)
+  {
+    return 0;
+  }
+  return year * 10000 + month * 100 + day;
+}
+
+static void prepareSeasonQuery(Hal &hal, const WakeConfig &config, const TimeSnapshot &time, SeasonQuery &query)
+{
+  int startYmd = parseYmd(config.debutSaisonTempo);
+  query.today = startYmd != 0 ? seasonDayIndex(startYmd, time.local) : -1;
+  query.from = 0;
+  query.storedChecksum = 0;
+  if (query.today < 0 || query.today + 1 >= SEASON_MAX_DAYS)
+  {
+    hal.board.log("Date hors de la saison configurée : compteurs sur toute la saison.");
+    query.today = -1;
+    return;
+  }
+
+  if (hal.storage.load(SEASON_HISTORY_KEY, &query.history, sizeof(query.history)) &&
+      seasonHistoryIsValid(query.history, startYmd))
+  {
+    query.storedChecksum = query.history.checksum;
+  }
+  else
+  {
+    // Nouvelle saison ou flash corrompue : tout est redemandé
+    hal.board.log("Historique de saison absent ou invalide : resynchronisation complète.");
+    seasonHistoryReset(query.history, startYmd);
+  }
+  query.from = seasonHistoryFirstUnknown(query.history, query.today);
+  logf(hal.board, "Historique de saison : jours %d à %d demandés.", query.from, query.today + 1);
+}
+
+static void subtractDay(SeasonCounts &counts, DayColor color)
+{
+  counts.blue -= color == DAY_BLUE;
+  counts.white -= color == DAY_WHITE;
+  counts.red -= color == DAY_RED;
+}
+
+// Les compteurs de l'API couvrent les jours demandés jusqu'à demain inclus.
+// Ils sont remplacés par ceux de toute la saison. En mémoire seulement : l'essai
+// peut tourner en tâche de fond, saveSeasonHistory écrit la flash.
+static void mergeSeasonHistory(Hal &hal, SeasonQuery &query, TempoResult &result)
+{
+  if (query.today < 0)
+  {
+    return;
+  }
+
+  // Jours connus avant la requête + jours couverts par la requête
+  SeasonCounts season = seasonHistoryCount(query.history, query.from);
+  season.blue += result.countBlue;
+  season.white += result.countWhite;
+  season.red += result.countRed;
+
+  DayColor today = dayColorFromName(result.todayColor);
+  DayColor tomorrow = dayColorFromName(result.tomorrowColor);
+  SeasonCounts missing = {result.countBlue, result.countWhite, result.countRed};
+  subtractDay(missing, today);
+  subtractDay(missing, tomorrow);
+  int missingDays = query.today - query.from;
+
+  if (today == DAY_UNKNOWN || missing.blue < 0 || missing.white < 0 || missing.red < 0 ||
+      missing.blue + missing.white + missing.red != missingDays)
+  {
+    hal.board.log("Compteurs de l'API incohérents avec l'historique : resynchronisation au prochain appel.");
+    seasonHistoryReset(query.history, query.history.startYmd);
+  }
+  else
+  {
+    if (missingDays == 1)
+    {
+      seasonHistorySet(query.history, query.from,
+                       missing.blue ? DAY_BLUE : (missing.white ? DAY_WHITE : DAY_RED));
+    }
+    else if (missingDays > 1)
+    {
+      seasonHistoryMergeTotals(query.history, query.from, query.today, missing);
+    }
+    seasonHistorySet(query.history, query.today, today);
+    seasonHistorySet(query.history, query.today + 1, tomorrow);
+    seasonHistorySeal(query.history);
+    season = seasonHistoryCount(query.history, query.today + 2);
+  }
+
+  result.countBlue = season.blue;
+  result.countWhite = season.white;
+  result.countRed = season.red;
+}
+
+// Par le réveil, une fois la source retenue
+static void saveSeasonHistory(Hal &hal, const SeasonQuery &query)
+{
+  if (query.today < 0 || query.history.checksum == query.storedChecksum)
+  {
+    return;
+  }
+  if (!hal.storage.save(SEASON_HISTORY_KEY, &query.history, sizeof(query.history)))
+  {
+    hal.board.log("Échec d'écriture de l'historique de saison.");
+  }
+}
+
+// Le hub répond en quelques dizaines de ms sur le réseau local : au-delà, il est absent
+#define HUB_TIMEOUT_MS 1500
+
+static bool fetchFromHub(Hal &hal, TempoApi &api, const WakeConfig &config, const TimeSnapshot &time,
+                         TempoResult &result, unsigned long timeoutMs)
+{
+  char line[TEMPO_HUB_LINE_LEN];
+  if (!api.fetchHub(config.hubHost, config.hubPort, line, sizeof(line),
+                    timeoutMs < HUB_TIMEOUT_MS ? timeoutMs : HUB_TIMEOUT_MS) ||
+      !tempoHubParse(line, snapshotDateYmd(time, 0), result))
+  {
+    hal.board.log("Hub injoignable ou sans les couleurs du jour.");
+    return false;
+  }
+  logf(hal.board, "Couleurs lues sur le hub %s.", config.hubHost);
+  return true;
+}
+
+static bool fetchFromFreeApi(Hal &hal, TempoApi &api, const WakeConfig &config, const TimeSnapshot &time,
+                             TempoResult &result, unsigned long timeoutMs)
+{
+  char today[32];
+  char tomorrow[32];
+  formatRteDate(today, sizeof(today), time, 0);
+  formatRteDate(tomorrow, sizeof(tomorrow), time, 1);
+  // seule la partie AAAA-MM-JJ est attendue
+  today[10] = '\0';
+  tomorrow[10] = '\0';
+  hal.board.log(today);
+  hal.board.log(tomorrow);
+  return api.fetchFree(today, tomorrow, config.saisonTempo, result, timeoutMs);
+}
+
+// query : historique lu par prepareSeasonQuery avant l'essai
+static bool fetchFromAccountApi(Hal &hal, TempoApi &api, const WakeConfig &config, const TimeSnapshot &time,
+                                SeasonQuery &query, TempoResult &result, unsigned long timeoutMs)
+{
+  char today[32];
+  char tomorrow[32];
+  formatRteDate(today, sizeof(today), time, 0);
+  formatRteDate(tomorrow, sizeof(tomorrow), time, 1);
+  hal.board.log(today);
+  hal.board.log(tomorrow);
+
+  char dayAfter[32];
+  char from[11];
+  char seasonStart[32];
+  formatRteDate(dayAfter, sizeof(dayAfter), time, 2);
+  hal.board.log(dayAfter);
+  if (query.from > 0)
+  {
+    seasonDayDate(from, sizeof(from), query.history.startYmd, query.from);
+  }
+  else
+  {
+    snprintf(from, sizeof(from), "%s", config.debutSaisonTempo);
+  }
+  // même fuseau que la date du jour
+  snprintf(seasonStart, sizeof(seasonStart), "%s%s", from, today + 10);
+  if (!api.fetchAccount(today, tomorrow, dayAfter, seasonStart, result, timeoutMs))
+  {
+    return false;
+  }
+  if (strcmp(result.todayColor, config.notAvailable) != 0)
+  {
+    mergeSeasonHistory(hal, query, result);
+  }
+  return true;
+}
+
+// Un essai de source, exécutable dans la tâche de fond d'une course : il n'écrit
+// que dans ses propres champs, avec son propre client de l'API
+struct SourceAttempt
+{
+  Hal *hal;
+  TempoApi *api;
+  const WakeConfig *config;
+  const TimeSnapshot *time;
+  TempoSource source;
+  unsigned long timeoutMs;
+  SeasonQuery query; // SOURCE_ACCOUNT, lu en flash avant l'essai
+  TempoResult result;
+  ApiStats stats;
+  bool fetched; // couleur du jour reçue
+  unsigned long ms;
+};
+
+static void runAttempt(void *context)
+{
+  SourceAttempt &attempt = *static_cast<SourceAttempt *>(context);
+  Hal &hal = *attempt.hal;
+  unsigned long start = hal.board.millis();
+  memset(&attempt.result, 0, sizeof(attempt.result));
+  bool fetched;
+  switch (attempt.source)
+  {
+  case SOURCE_HUB:
+    fetched = fetchFromHub(hal, *attempt.api, *attempt.config, *attempt.time, attempt.result, attempt.timeoutMs);
+    break;
+  case SOURCE_ACCOUNT:
+    fetched = fetchFromAccountApi(hal, *attempt.api, *attempt.config, *attempt.time, attempt.query, attempt.result,
+                                  attempt.timeoutMs);
+    break;
+  default:
+    fetched = fetchFromFreeApi(hal, *attempt.api, *attempt.config, *attempt.time, attempt.result,
+                               attempt.timeoutMs);
+    break;
+  }
+  attempt.stats = attempt.api->stats();
+  attempt.fetched = fetched && strcmp(attempt.result.todayColor, attempt.config->notAvailable) != 0;
+  attempt.ms = hal.board.millis() - start;
+}
+
+// Lectures en flash faites ici, par le réveil, avant un éventuel lancement en tâche de fond
+static void prepareAttempt(SourceAttempt &attempt, Hal &hal, TempoApi &api, const WakeConfig &config,
+                           const TimeSnapshot &time, TempoSource source, unsigned long timeoutMs)
+{
+  attempt.hal = &hal;
+  attempt.api = &api;
+  attempt.config = &config;
+  attempt.time = &time;
+  attempt.source = source;
+  attempt.timeoutMs = timeoutMs;
+  attempt.query.today = -1;
+  if (source == SOURCE_ACCOUNT)
+  {
+    prepareSeasonQuery(hal, config, time, attempt.query);
+  }
+  memset(&attempt.stats, 0, sizeof(attempt.stats));
+  attempt.fetched = false;
+  attempt.ms = 0;
+}
+
+// Source retenue : ses couleurs, ses mesures, et l'historique de saison écrit en flash
+static TempoSource acceptAttempt(Hal &hal, const SourceAttempt &attempt, TempoResult &result, ApiStats &stats)
+{
+  result = attempt.result;
+  stats = attempt.stats;
+  if (attempt.fetched)
+  {
+    saveSeasonHistory(hal, attempt.query);
+  }
+  return attempt.source;
+}
+
+static void recordAttempt(Hal &hal, RtcState &rtc, const TimeSnapshot &time, TempoSource source, bool success,
+                          unsigned long ms)
+{
+  sourceHistoryRecord(rtc.sources, source, success, ms, time.now);
+  logf(hal.board, "Source %s : %s en %lu ms.", tempoSourceNames[source], success ? "couleurs reçues" : "échec", ms);
+}
+
+static int orderSources(Hal &hal, const WakeConfig &config, const RtcState &rtc, const TimeSnapshot &time,
+                        TempoSource *order)
+{
+  // Sans mesures : le hub du réseau local, puis l'API choisie dans TOCUSTOMIZE.h
+  TempoSource preferred = config.tempoSansCompte ? SOURCE_FREE : SOURCE_ACCOUNT;
+  TempoSource other = config.tempoSansCompte ? SOURCE_ACCOUNT : SOURCE_FREE;
+  TempoSource preference[SOURCE_NETWORK_COUNT] = {SOURCE_HUB, preferred, other};
+  unsigned enabled = 1u << preferred;
+  enabled |= config.bothApis ? 1u << other : 0;
+  // Le hub ne s'interroge pas lui-même
+  enabled |= config.hubHost != nullptr && !config.hubServe ? 1u << SOURCE_HUB : 0;
+  int count = sourceOrder(rtc.sources, enabled, preference, time.now, order);
+
+  char names[48] = "";
+  size_t length = 0;
+  for (int i = 0; i < count && length < sizeof(names); i++)
+  {
+    length += snprintf(names + length, sizeof(names) - length, i > 0 ? ", %s" : "%s", tempoSourceNames[order[i]]);
+  }
+  logf(hal.board, "Ordre des sources : %s.", names);
+  return count;
+}
+
+// Sources essayées de la plus prometteuse à la moins prometteuse, dans le temps
+// laissé par le budget. Quand la première tarde au-delà du double de son temps de
+// réponse habituel, la suivante est lancée à côté et la première réponse l'emporte ;
+// la source abandonnée compte comme un échec. SOURCE_NONE si aucune n'a répondu.
+// stats : mesures de l'appel dont viennent les couleurs de result.
+static TempoSource fetchTempo(Hal &hal, const WakeConfig &config, RtcState &rtc, const TimeSnapshot &time,
+                              TempoResult &result, ApiStats &stats, unsigned long timeoutMs)
+{
+  TempoSource order[SOURCE_NETWORK_COUNT];
+  int count = orderSources(hal, config, rtc, time, order);
+
+  // La tâche de fond peut finir après ce réveil : son essai n'est pas sur la pile
+  static SourceAttempt background;
+  bool racing = false;
+  unsigned long backgroundStart = 0;
+  unsigned long start = hal.board.millis();
+  for (int i = 0; i < count; i++)
+  {
+    unsigned long spent = hal.board.millis() - start;
+    if (spent >= timeoutMs)
+    {
+      break;
+    }
+    TempoSource source = order[i];
+    // Une source abandonnée encore en cours garde son essai et son client
+    if (config.raceSources && !racing && i + 1 < count && hal.board.waitBackground(0))
+    {
+      prepareAttempt(background, hal, hal.raceApi, config, time, source, timeoutMs - spent);
+      backgroundStart = hal.board.millis();
+      if (hal.board.startBackground(runAttempt, &background))
+      {
+        raceSource = source;
+        raceDeadlineMs = backgroundStart + background.timeoutMs + RACE_GRACE_MS;
+        unsigned long delay = sourceRaceDelayMs(rtc.sources, source);
+        if (hal.board.waitBackground(delay < timeoutMs - spent ? delay : timeoutMs - spent))
+        {
+          recordAttempt(hal, rtc, time, source, background.fetched, background.ms);
+          if (background.fetched)
+          {
+            return acceptAttempt(hal, background, result, stats);
+          }
+          result = background.result;
+          stats = background.stats;
+          continue;
+        }
+        racing = true;
+        source = order[++i];
+        logf(hal.board, "Source %s sans réponse après %lu ms : %s lancée en parallèle.",
+             tempoSourceNames[background.source], hal.board.millis() - backgroundStart, tempoSourceNames[source]);
+        spent = hal.board.millis() - start;
+      }
+    }
+
+    SourceAttempt attempt;
+    prepareAttempt(attempt, hal, hal.api, config, time, source, timeoutMs - spent);
+    runAttempt(&attempt);
+    recordAttempt(hal, rtc, time, source, attempt.fetched, attempt.ms);
+    if (attempt.fetched)
+    {
+      if (racing)
+      {
+        recordAttempt(hal, rtc, time, background.source, false, hal.board.millis() - backgroundStart);
+      }
+      return acceptAttempt(hal, attempt, result, stats);
+    }
+    result = attempt.result;
+    stats = attempt.stats;
+    if (racing)
+    {
+      // La première source garde le temps qui reste
+      racing = false;
+      spent = hal.board.millis() - start;
+      bool done = hal.board.waitBackground(spent < timeoutMs ? timeoutMs - spent : 0);
+      recordAttempt(hal, rtc, time, background.source, done && background.fetched,
+                    done ? background.ms : hal.board.millis() - backgroundStart);
+      if (done)
+      {
+        if (background.fetched)
+        {
+          return acceptAttempt(hal, background, result, stats);
+        }
+        result = background.result;
+        stats = background.stats;
+      }
+    }
+  }
+  return SOURCE_NONE;
+}
+
+// Un échec de plus : l'écran d'erreur n'est dessiné qu'au premier échec d'une série,
+// les suivants ne changeraient que le compteur
+static bool recordFailure(Hal &hal, RtcState &rtc)
+{
+  rtc.counterRetry++;
+  logf(hal.board, "Échec n°%u, nouvel essai après une attente croissante.", rtc.counterRetry);
+  return rtc.counterRetry == 1;
+}
+
+void runWakeCycle(Hal &hal, const WakeConfig &config, RtcState &rtc)
+{
+  CycleRecord &record = cycleLogBegin(rtc.cycles);
+  record.source = SOURCE_NONE;
+  uint64_t bootMs = hal.board.micros() / 1000;
+  record.phaseMs[CYCLE_BOOT] = bootMs > 0xFFFF ? 0xFFFF : (uint16_t)bootMs;
+  WakeCause cause = hal.board.wakeCause();
+  record.wakeCause = (uint8_t)cause;
+
+  // Tension de la batterie, mesurée avant que le WiFi ne la fasse chuter
+  BatteryStatus battery;
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_ADC);
+    int raw[BATTERY_SAMPLES];
+    for (int i = 0; i < BATTERY_SAMPLES; i++)
+    {
+      raw[i] = hal.board.readBatteryRaw();
+    }
+    battery.millivolts = batteryMillivolts(raw, BATTERY_SAMPLES);
+  }
+  battery.percentage = batteryPercentage(battery.millivolts);
+  battery.daysLeft = -1;
+  record.batteryMv = (uint16_t)battery.millivolts;
+
+  bool panelReady = false;
+
+  // L'horloge RTC survit au deep sleep, pas le fuseau horaire
+  hal.clock.setTimeZone(config.timeZone);
+  correctClockDrift(hal, rtc);
+  // Toutes les dates du réveil viennent de cet instant
+  TimeSnapshot time;
+  takeTimeSnapshot(time, hal.clock.now());
+  record.wakeTime = isPlausible(time.local) ? (uint32_t)time.now : 0;
+
+  // Une tension par jour pour la prévision d'autonomie
+  if (isPlausible(time.local))
+  {
+    batteryHistoryAdd(rtc.battery, time.now, battery.millivolts);
+  }
+  // Sans batterie (alimentation USB), la lecture est invalide
+  if (battery.millivolts > 0)
+  {
+    battery.daysLeft = batteryForecastDays(rtc.battery);
+  }
+  logf(hal.board, "Batterie: %d mV (%d%%), autonomie estimée %d jours", battery.millivolts, battery.percentage,
+       battery.daysLeft);
+  bool batteryLow = battery.millivolts > 0 &&
+                    (battery.percentage < config.schedule.lowBatteryPercentage ||
+                     (battery.daysLeft >= 0 && battery.daysLeft < config.schedule.lowBatteryDays));
+
+  // Les couleurs connues suffisent : pas de WiFi. Après un appui sur le bouton,
+  // le réseau n'est utilisé que si le cache est périmé.
+  bool buttonWake = cause == WAKE_CAUSE_BUTTON;
+  if (buttonWake)
+  {
+    hal.board.log("Réveil par le bouton.");
+  }
+  if (displayFromCache(hal, config, rtc, time, panelReady, battery))
+  {
+    goToDeepSleepUntilNextWakeup(hal, config, rtc, batteryLow, buttonWake);
+    return;
+  }
+
+  // Connecter au WiFi. Quand l'écran changera forcément (rien de connu à l'écran,
+  // ou un autre jour), il est préparé avec son fond pendant l'association et la
+  // phase WiFi ne compte que l'attente qui reste ensuite. Sinon l'écran n'est
+  // alimenté qu'une fois le contenu connu et différent de celui affiché.
+  hal.network.startConnect(config.wifiSsid, config.wifiKey);
+  if (rtc.screenHash == 0 || rtc.screenDateYmd != snapshotDateYmd(time, 0))
+  {
+    preparePanel(hal, rtc, panelReady);
+    PhaseTimer timer(hal, rtc, CYCLE_RENDER);
+    hal.panel.drawBackground();
+  }
+  bool connected;
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_WIFI);
+    connected = hal.network.finishConnect(wakeBudgetStageMs(config.budget, hal.board.millis(), ULONG_MAX));
+  }
+  record.wifi = connected ? (uint8_t)(hal.network.stats().path + 1) : CYCLE_WIFI_FAILED;
+  if (!connected)
+  {
+    hal.board.log("Erreur de connexion WiFi.");
+    logBudget(hal, config);
+    bool firstFailure = recordFailure(hal, rtc);
+    if (!displayStale(hal, config, rtc, panelReady, battery) && firstFailure)
+    {
+      printLine(hal, rtc, panelReady, "Erreur de connexion");
+      printLine(hal, rtc, panelReady, "Nouvel essai automatique");
+      updatePanel(hal, rtc);
+    }
+    goToDeepSleepUntilNextWakeup(hal, config, rtc, batteryLow, false);
+    return;
+  }
+  logConnectStats(hal);
+
+  // Initialiser l'heure
+  bool timeReady;
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_NTP);
+    timeReady = initializeTime(hal, config, rtc);
+  }
+  if (!timeReady)
+  {
+    hal.board.log("Erreur de synchronisation NTP.");
+    logBudget(hal, config);
+    bool firstFailure = recordFailure(hal, rtc);
+    if (!displayStale(hal, config, rtc, panelReady, battery) && firstFailure)
+    {
+      printLine(hal, rtc, panelReady, "Err de conn ou de synchro: deep sleep.");
+      updatePanel(hal, rtc);
+    }
+    goToDeepSleepUntilNextWakeup(hal, config, rtc, batteryLow, false);
+    return;
+  }
+  // Le NTP a pu corriger l'horloge : nouvel instant de référence
+  takeTimeSnapshot(time, hal.clock.now());
+
+  TempoResult result;
+  memset(&result, 0, sizeof(result));
+  ApiStats stats;
+  memset(&stats, 0, sizeof(stats));
+  TempoSource source;
+  {
+    PhaseTimer timer(hal, rtc, CYCLE_API);
+    source = fetchTempo(hal, config, rtc, time, result, stats,
+                        wakeBudgetStageMs(config.budget, hal.board.millis(), ULONG_MAX));
+  }
+  logApiStats(hal, rtc, stats);
+  for (int i = 0; i < CYCLE_HTTP_CODES; i++)
+  {
+    int code = result.errorCodes[i];
+    record.httpCodes[i] = code > INT16_MAX ? INT16_MAX : code < INT16_MIN ? INT16_MIN : (int16_t)code;
+  }
+
+  if (source != SOURCE_NONE)
+  {
+    record.source = source;
+    rtc.counterRetry = 0;
+
+    tempoStateStore(rtc.tempo, snapshotDateYmd(time, 0),
+                    result.todayColor, result.tomorrowColor,
+                    result.countBlue, result.countWhite, result.countRed);
+
+    char errorCode[TEMPO_ERROR_CODES * 8] = "";
+    size_t length = 0;
+    for (int i = 0; i < TEMPO_ERROR_CODES && length < sizeof(errorCode); i++)
+    {
+      length += snprintf(errorCode + length, sizeof(errorCode) - length, "%d | ", result.errorCodes[i]);
+    }
+    hal.board.log(errorCode);
+
+    showTempo(hal, config, rtc, time, panelReady, battery, errorCode, false);
+  }
+  else
+  {
+    hal.board.log("Erreur d'appels API.");
+    logBudget(hal, config);
+    bool firstFailure = recordFailure(hal, rtc);
+    if (!displayStale(hal, config, rtc, panelReady, battery) && firstFailure)
+    {
+      char line[32];
+      printLine(hal, rtc, panelReady, "Erreur d'appels API");
+      printLine(hal, rtc, panelReady, "Sans compte RTE:");
+      printLine(hal, rtc, panelReady, config.tempoSansCompte ? "true" : "false");
+      for (int i = 0; i < TEMPO_ERROR_CODES; i++)
+      {
+        snprintf(line, sizeof(line), "%d", result.errorCodes[i]);
+        printLine(hal, rtc, panelReady, line);
+      }
+      printLine(hal, rtc, panelReady, "Nouvel essai automatique");
+      updatePanel(hal, rtc);
+    }
+  }
+
+  // Sommeil profond jusqu'au prochain réveil utile
+  goToDeepSleepUntilNextWakeup(hal, config, rtc, batteryLow, false);
+}
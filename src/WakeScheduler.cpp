@@ -0,0 +1,146 @@
+#include "WakeScheduler.h"
+
+static const int MINUTES_PER_DAY = 24 * 60;
+
+const char *wakeReasonNames[] = {"changement de jour", "publication RTE", "nouvel essai", "après échec"};
+
+static int minuteOfDay(const WakeupTime &time)
+{
+  return time.hour * 60 + time.minute;
+}
+
+// Heure locale dayOffset jours après now, à la minute donnée. mktime recalcule
+// l'heure d'été, les fins de mois et d'année.
+static time_t localTimeAt(time_t now, int dayOffset, int minute)
+{
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  timeinfo.tm_mday += dayOffset;
+  timeinfo.tm_hour = minute / 60;
+  timeinfo.tm_min = minute % 60;
+  timeinfo.tm_sec = 0;
+  timeinfo.tm_isdst = -1;
+  return mktime(&timeinfo);
+}
+
+uint32_t retryDelaySeconds(const WakePolicy &policy, unsigned int failures, bool batteryLow, uint32_t random)
+{
+  uint32_t delay = policy.retryBaseSeconds;
+  for (unsigned int i = 1; i < failures && delay < policy.retryMaxSeconds; i++)
+  {
+    delay *= 2;
+  }
+  if (delay > policy.retryMaxSeconds)
+  {
+    delay = policy.retryMaxSeconds;
+  }
+
+  // Gigue de +/-25% pour que les afficheurs d'un même réseau ne réessaient pas ensemble
+  delay = (uint32_t)((uint64_t)delay * (75 + random % 51) / 100);
+  if (batteryLow)
+  {
+    delay *= policy.lowBatteryFactor;
+  }
+  return delay > 0 ? delay : 1;
+}
+
+static WakeDecision wakeAt(time_t now, time_t target, WakeReason reason)
+{
+  WakeDecision decision;
+  decision.wakeAt = target;
+  decision.sleepSeconds = target > now ? (uint64_t)(target - now) : 1;
+  decision.reason = reason;
+  return decision;
+}
+
+int nextPollMinute(const WakePolicy &policy, int minute, bool batteryLow)
+{
+  int start = minuteOfDay(policy.publicationStart);
+  int end = minuteOfDay(policy.publicationEnd);
+  int interval = policy.publicationPollMinutes * (batteryLow ? policy.lowBatteryFactor : 1);
+  if (minute < start)
+  {
+    return start;
+  }
+  if (interval <= 0)
+  {
+    return -1;
+  }
+  if (minute < end)
+  {
+    // La grille de la fenêtre, puis sa fin même si l'intervalle la dépasse : la
+    // publication tardive est vue quel que soit l'état de la batterie
+    int next = start + ((minute - start) / interval + 1) * interval;
+    return next < end ? next : end;
+  }
+  // Demain toujours inconnu après la fenêtre : publication en retard, essais de
+  // plus en plus espacés
+  int next = end;
+  for (int gap = interval; next <= minute; gap *= 2)
+  {
+    next += gap;
+  }
+  return next < MINUTES_PER_DAY ? next : -1;
+}
+
+static WakeDecision regularWake(const WakePolicy &policy, const WakeInputs &inputs)
+{
+  time_t now = inputs.now;
+  time_t reference = now + WAKE_EARLY_TOLERANCE_SECONDS;
+  struct tm timeinfo;
+  localtime_r(&reference, &timeinfo);
+  int minute = timeinfo.tm_hour * 60 + timeinfo.tm_min;
+  int start = minuteOfDay(policy.publicationStart);
+
+  if (inputs.tomorrowKnown)
+  {
+    // Demain est le lendemain de now : avec la tolérance, un réveil à 23:59
+    // sauterait un jour
+    if (inputs.batteryLow)
+    {
+      // Sur batterie faible, la bascule attend le prochain réveil utile
+      return wakeAt(now, localTimeAt(now, 1, start), WAKE_PUBLICATION);
+    }
+    return wakeAt(now, localTimeAt(now, 1, policy.rolloverDelayMinutes), WAKE_ROLLOVER);
+  }
+
+  if (minute < start)
+  {
+    return wakeAt(now, localTimeAt(reference, 0, start), WAKE_PUBLICATION);
+  }
+
+  int next = nextPollMinute(policy, minute, inputs.batteryLow);
+  if (next >= 0)
+  {
+    return wakeAt(now, localTimeAt(reference, 0, next), WAKE_POLL);
+  }
+
+  // Pas publié de la journée : le changement de jour rafraîchit au moins aujourd'hui
+  return wakeAt(now, localTimeAt(reference, 1, policy.rolloverDelayMinutes), WAKE_ROLLOVER);
+}
+
+WakeDecision scheduleNextWake(const WakePolicy &policy, const WakeInputs &inputs)
+{
+  if (inputs.failures == 0 && inputs.now != 0)
+  {
+    return regularWake(policy, inputs);
+  }
+
+  WakeDecision retry;
+  retry.sleepSeconds = retryDelaySeconds(policy, inputs.failures > 0 ? inputs.failures : 1,
+                                         inputs.batteryLow, inputs.random);
+  retry.wakeAt = inputs.now != 0 ? inputs.now + (time_t)retry.sleepSeconds : 0;
+  retry.reason = WAKE_RETRY;
+
+  // L'écran montre déjà la couleur du jour : on garde le rythme normal, sans
+  // descendre sous l'attente exponentielle
+  if (inputs.todayKnown && inputs.now != 0)
+  {
+    WakeDecision regular = regularWake(policy, inputs);
+    if (regular.sleepSeconds > retry.sleepSeconds)
+    {
+      return regular;
+    }
+  }
+  return retry;
+}
@@ -0,0 +1,447 @@
+#include "EpdPanel.h"
+
+#include "FrameDiff.h"
+#include "PanelLayout.h"
+
+#include <GxEPD.h>
+#include <GxDEPG0213BN/GxDEPG0213BN.h>
+#include <GxIO/GxIO_SPI/GxIO_SPI.h>
+#include <GxIO/GxIO.h>
+#include "time.h"
+#include <math.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+
+#include <Fonts/FreeSans9pt7b.h>
+#include <Fonts/FreeSansBold12pt7b.h>
+#include <Fonts/Org_01.h>
+
+// décommenter pour deguggage de l'affichage
+// #define DEBUG_GRID
+
+// pour afficher les codes retours
+//#define DEBUG_ERROR_CODE
+
+#define PIN_BUSY 4
+
+GxIO_Class io(SPI, /*CS=5*/ SS, /*DC=*/17, /*RST=*/16);
+GxEPD_Class display(io, /*RST=*/16, /*BUSY=*/PIN_BUSY);
+
+// GxEPD attend BUSY par tranches de delay(1), processeur éveillé. Une tâche
+// moins prioritaire que loopTask ne tourne que lorsque celle-ci est bloquée dans
+// cette attente, jamais au milieu d'une transaction SPI. Réveillée par le front
+// montant de BUSY, elle endort tout le SoC en sommeil léger jusqu'à ce qu'il retombe.
+#define PARK_TASK_STACK 2048
+#define PARK_TASK_PRIORITY 0 // loopTask est à 1
+#define PARK_TIMEOUT_US 10000000ULL // délai de GxEPD avant d'abandonner l'attente
+
+// L'écran principal est dessiné hors écran puis comparé à la dernière image
+// affichée, gardée en mémoire RTC, pour ne rafraîchir que ce qui a changé.
+const int displayRotation = 1;
+
+GFXcanvas1 canvas(FRAME_WIDTH, FRAME_HEIGHT);
+RTC_DATA_ATTR uint8_t lastFrame[FRAME_BYTES];
+RTC_DATA_ATTR RefreshMemory refreshMemory;
+
+// RAM du contrôleur : 128 pixels par ligne dont FRAME_HEIGHT visibles, FRAME_WIDTH
+// lignes, bits à 1 = blanc. 0x24 reçoit l'image à afficher, 0x26 l'image affichée
+// contre laquelle le rafraîchissement partiel calcule sa forme d'onde.
+#define RAM_ROW_BYTES 16
+#define CMD_DATA_ENTRY 0x11
+#define CMD_RAM_X_RANGE 0x44
+#define CMD_RAM_Y_RANGE 0x45
+#define CMD_RAM_X_COUNTER 0x4E
+#define CMD_RAM_Y_COUNTER 0x4F
+#define CMD_WRITE_NEW_RAM 0x24
+#define CMD_WRITE_OLD_RAM 0x26
+#define RAM_BUSY_TIMEOUT_MS 100
+
+void displayInfo(const TempoView &view);
+void drawDebugGrid();
+
+void EpdPanel::init()
+{
+  display.init();
+  display.setTextColor(GxEPD_BLACK);
+  // init() remet le contrôleur à zéro : sa RAM ne contient plus l'image à l'écran
+  ramHoldsLastFrame = false;
+}
+
+// Ligne y de la RAM du contrôleur, tirée de frame avec la rotation displayRotation :
+// le pixel (x, y) de la RAM est le pixel (y, FRAME_HEIGHT - 1 - x) de l'image
+static void ramRow(const uint8_t *frame, int y, uint8_t *row)
+{
+  memset(row, 0xFF, RAM_ROW_BYTES);
+  for (int x = 0; x < FRAME_HEIGHT; x++)
+  {
+    int frameY = FRAME_HEIGHT - 1 - x;
+    if (!(frame[frameY * FRAME_ROW_BYTES + y / 8] & (0x80 >> (y % 8))))
+    {
+      row[x / 8] &= ~(0x80 >> (x % 8));
+    }
+  }
+}
+
+static void writeRam(uint8_t command, const uint8_t *frame)
+{
+  uint8_t row[RAM_ROW_BYTES];
+  io.writeCommandTransaction(command);
+  for (int y = 0; y < FRAME_WIDTH; y++)
+  {
+    ramRow(frame, y, row);
+    for (int i = 0; i < RAM_ROW_BYTES; i++)
+    {
+      io.writeDataTransaction(row[i]);
+    }
+  }
+}
+
+// Recopie l'image affichée dans les deux RAM du contrôleur. Sans cela, après un
+// deep sleep, le rafraîchissement partiel compare la nouvelle image à une RAM
+// indéterminée, et les pixels hors des zones changées partent de cette RAM aussi.
+void EpdPanel::restoreControllerRam()
+{
+  unsigned long start = millis();
+  while (digitalRead(PIN_BUSY) == HIGH && millis() - start < RAM_BUSY_TIMEOUT_MS)
+  {
+    delay(1);
+  }
+  io.writeCommandTransaction(CMD_DATA_ENTRY);
+  io.writeDataTransaction(0x03); // x puis y croissants
+  io.writeCommandTransaction(CMD_RAM_X_RANGE);
+  io.writeDataTransaction(0x00);
+  io.writeDataTransaction(RAM_ROW_BYTES - 1);
+  io.writeCommandTransaction(CMD_RAM_Y_RANGE);
+  io.writeDataTransaction(0x00);
+  io.writeDataTransaction(0x00);
+  io.writeDataTransaction((FRAME_WIDTH - 1) & 0xFF);
+  io.writeDataTransaction((FRAME_WIDTH - 1) >> 8);
+  for (uint8_t command : {CMD_WRITE_OLD_RAM, CMD_WRITE_NEW_RAM})
+  {
+    io.writeCommandTransaction(CMD_RAM_X_COUNTER);
+    io.writeDataTransaction(0x00);
+    io.writeCommandTransaction(CMD_RAM_Y_COUNTER);
+    io.writeDataTransaction(0x00);
+    io.writeDataTransaction(0x00);
+    writeRam(command, lastFrame);
+  }
+  ramHoldsLastFrame = true;
+}
+
+void EpdPanel::printLine(const char *text)
+{
+  textMode = true;
+  if (currentLinePos > 150)
+  {
+    currentLinePos = 0;
+    display.fillScreen(GxEPD_WHITE);
+  }
+  display.setTextColor(GxEPD_BLACK);
+  display.setCursor(10, currentLinePos);
+  display.print(text);
+  currentLinePos += 10;
+}
+
+void EpdPanel::drawBackground()
+{
+  // Fond précalculé : bits à 1 = blanc, comme dans le canvas
+  memcpy(canvas.getBuffer(), panelBackground.bytes, FRAME_BYTES);
+
+#ifdef DEBUG_GRID
+  drawDebugGrid();
+#endif
+  backgroundReady = true;
+}
+
+void EpdPanel::drawTempo(const TempoView &view)
+{
+  textMode = false;
+  if (!backgroundReady)
+  {
+    drawBackground();
+  }
+  displayInfo(view);
+  backgroundReady = false; // le prochain dessin repart d'un fond vierge
+}
+
+void IRAM_ATTR EpdPanel::busyRising(void *parameter)
+{
+  EpdPanel *panel = static_cast<EpdPanel *>(parameter);
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(panel->parkHandle, &woken);
+  if (woken)
+  {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void EpdPanel::parkTask(void *parameter)
+{
+  EpdPanel *panel = static_cast<EpdPanel *>(parameter);
+  gpio_num_t busy = (gpio_num_t)PIN_BUSY;
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (!panel->parking)
+    {
+      break;
+    }
+    // BUSY relu après chaque réveil : un front manqué pendant le sommeil est rattrapé ici
+    while (panel->parking && digitalRead(PIN_BUSY) == HIGH)
+    {
+      // Le réveil sur niveau bas prend le type d'interruption de la broche :
+      // l'interruption du front est masquée le temps du sommeil
+      gpio_intr_disable(busy);
+      gpio_wakeup_enable(busy, GPIO_INTR_LOW_LEVEL);
+      int64_t start = esp_timer_get_time();
+      esp_light_sleep_start();
+      panel->parkedUs += esp_timer_get_time() - start;
+      gpio_wakeup_disable(busy);
+      gpio_set_intr_type(busy, GPIO_INTR_POSEDGE);
+      gpio_intr_enable(busy);
+    }
+  }
+  xSemaphoreGive(panel->parkDone);
+  vTaskDelete(nullptr);
+}
+
+void EpdPanel::startParking()
+{
+  parkedUs = 0;
+  parkDone = xSemaphoreCreateBinary();
+  if (parkDone == nullptr)
+  {
+    return;
+  }
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup(PARK_TIMEOUT_US);
+  Serial.flush(); // l'UART s'arrête pendant le sommeil léger
+  parking = true;
+  if (xTaskCreatePinnedToCore(parkTask, "park", PARK_TASK_STACK, this, PARK_TASK_PRIORITY, &parkHandle,
+                              xPortGetCoreID()) != pdPASS)
+  {
+    parking = false;
+    parkHandle = nullptr;
+    stopParking();
+    return;
+  }
+  gpio_num_t busy = (gpio_num_t)PIN_BUSY;
+  gpio_install_isr_service(0); // déjà installé par attachInterrupt : ESP_ERR_INVALID_STATE, sans effet
+  gpio_set_intr_type(busy, GPIO_INTR_POSEDGE);
+  gpio_isr_handler_add(busy, busyRising, this);
+  gpio_intr_enable(busy);
+}
+
+void EpdPanel::stopParking()
+{
+  gpio_num_t busy = (gpio_num_t)PIN_BUSY;
+  if (parkHandle != nullptr)
+  {
+    gpio_isr_handler_remove(busy);
+    gpio_intr_disable(busy);
+    gpio_set_intr_type(busy, GPIO_INTR_DISABLE);
+  }
+  if (parking)
+  {
+    parking = false;
+    // La tâche tourne dès que loopTask se bloque sur parkDone
+    xTaskNotifyGive(parkHandle);
+    xSemaphoreTake(parkDone, portMAX_DELAY);
+  }
+  parkHandle = nullptr;
+  if (parkDone != nullptr)
+  {
+    vSemaphoreDelete(parkDone);
+    parkDone = nullptr;
+  }
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+  gpio_wakeup_disable(busy);
+}
+
+void EpdPanel::update()
+{
+  int64_t start = esp_timer_get_time();
+  parkedUs = 0;
+  if (sleepWhileBusy)
+  {
+    startParking();
+  }
+  refresh();
+  if (sleepWhileBusy)
+  {
+    stopParking();
+  }
+  lastStats.updateMs = (esp_timer_get_time() - start) / 1000;
+  lastStats.parkedMs = parkedUs / 1000;
+}
+
+PanelStats EpdPanel::stats()
+{
+  return lastStats;
+}
+
+void EpdPanel::refresh()
+{
+  if (textMode)
+  {
+    // Les messages d'erreur sont écrits directement : l'image gardée n'est plus à l'écran
+    display.update();
+    refreshMemory.frameValid = false;
+    ramHoldsLastFrame = false;
+    return;
+  }
+
+  FrameRect rects[FRAME_MAX_RECTS];
+  int count = frameDiff(lastFrame, canvas.getBuffer(), FRAME_WIDTH, FRAME_HEIGHT, rects, FRAME_MAX_RECTS);
+  RefreshKind kind = chooseRefresh(refreshMemory, rects, count, FRAME_WIDTH, FRAME_HEIGHT, fullRefreshEvery);
+  if (kind == REFRESH_NONE)
+  {
+    Serial.println("Image inchangée, pas de rafraîchissement.");
+    return;
+  }
+
+  // Bits à 1 = blanc dans le canvas
+  display.setRotation(displayRotation);
+  display.drawBitmap(0, 0, canvas.getBuffer(), FRAME_WIDTH, FRAME_HEIGHT, GxEPD_WHITE, bm_normal);
+  if (kind == REFRESH_FULL)
+  {
+    Serial.println("Rafraîchissement complet.");
+    display.update();
+  }
+  else
+  {
+    if (!ramHoldsLastFrame)
+    {
+      restoreControllerRam();
+    }
+    Serial.printf("Rafraîchissement partiel de %d zone(s).\n", count);
+    for (int i = 0; i < count; i++)
+    {
+      display.updateWindow(rects[i].x, rects[i].y, rects[i].w, rects[i].h, true);
+    }
+  }
+
+  memcpy(lastFrame, canvas.getBuffer(), FRAME_BYTES);
+  ramHoldsLastFrame = true;
+  recordRefresh(refreshMemory, kind);
+}
+
+void drawBatteryLevel(int percentage, int daysLeft)
+{
+  FrameRaster raster(canvas.getBuffer());
+  fillBatteryBars(raster, batteryBars(percentage));
+
+  // Quand il reste moins de 25% de batterie on affiche le pourcentage,
+  // puis l'autonomie prévue dès qu'elle est connue
+  char line[16] = "";
+  int length = 0;
+  if (percentage < 25)
+  {
+    length = snprintf(line, sizeof(line), "%d%% ", percentage);
+  }
+  if (daysLeft >= 0)
+  {
+    snprintf(line + length, sizeof(line) - length, "%dj", daysLeft);
+  }
+  if (line[0] != '\0')
+  {
+    canvas.setFont(&FreeSans9pt7b);
+    canvas.setCursor(batteryTopLeftX + batteryWidth + 5, batteryTopLeftY + 10);
+    canvas.print(line);
+  }
+}
+
+// Textes et niveau de batterie, par-dessus le fond panelBackground
+void displayInfo(const TempoView &view)
+{
+  // Texte noir (bit à 0) : la couleur par défaut de GFX est le blanc
+  canvas.setTextColor(GxEPD_BLACK);
+  drawBatteryLevel(view.batteryPercentage, view.batteryDaysLeft);
+
+  // Draw date for today
+  canvas.setFont(&FreeSans9pt7b);
+  canvas.setCursor(leftMargin + textOffsetX + adjustTitleX, topLineY);
+  canvas.print(view.todayLabel);
+  // Draw color for today
+  canvas.setFont(&FreeSansBold12pt7b);
+  canvas.setCursor(leftMargin + textOffsetX, colorTextY);
+  canvas.print(view.todayColor);
+
+  // Draw date for tomorrow
+  canvas.setFont(&FreeSans9pt7b);
+  canvas.setCursor(secondRectX + textOffsetX + adjustTitleX, topLineY);
+  canvas.print(view.tomorrowLabel);
+  // Draw color for tomorrow
+  canvas.setFont(&FreeSansBold12pt7b);
+  canvas.setCursor(secondRectX + textOffsetX, colorTextY);
+  canvas.print(view.tomorrowColor);
+
+  // BLANC
+  canvas.setFont(&FreeSans9pt7b);
+  canvas.setCursor(x_blanc + textRemainOffsetX, bottomIndicatorY + textRemainOffsetY);
+  canvas.print(43 - view.countWhite);
+
+  // ROUGE
+  canvas.setCursor(x_rouge + textRemainExclamationOffsetX, bottomIndicatorY + textRemainOffsetY);
+  canvas.print(22 - view.countRed);
+
+  // draw refresh date time
+  int refreshX = leftMargin + textOffsetX + 120 + adjustTitleX;
+  int refreshY = bottomIndicatorY + textRemainOffsetY;
+  if (view.stale)
+  {
+    // Couleurs non vérifiées à ce réveil : date en négatif
+    int16_t boundsX, boundsY;
+    uint16_t boundsW, boundsH;
+    canvas.getTextBounds(view.refreshLabel, refreshX, refreshY, &boundsX, &boundsY, &boundsW, &boundsH);
+    canvas.fillRect(boundsX - 2, boundsY - 1, boundsW + 4, boundsH + 2, GxEPD_BLACK);
+    canvas.setTextColor(GxEPD_WHITE);
+  }
+  canvas.setCursor(refreshX, refreshY);
+  canvas.print(view.refreshLabel);
+  canvas.setTextColor(GxEPD_BLACK);
+
+#ifdef DEBUG_ERROR_CODE
+  // on affiche les codes retours HTTP
+  canvas.setFont(&Org_01);
+  canvas.setCursor(10, 11);
+  if (view.tempoSansCompte) {
+    canvas.print("NO_RTE");
+  } else {
+    canvas.print("RTE");
+  }
+  canvas.setCursor(10,17);
+  canvas.print(view.errorCode);
+  if (view.lastCycleMs > 0)
+  {
+    // durée du réveil précédent, le réveil en cours n'étant pas terminé
+    char lastCycle[32];
+    snprintf(lastCycle, sizeof(lastCycle), "dernier cycle %lu ms", view.lastCycleMs);
+    canvas.setCursor(10, 23);
+    canvas.print(lastCycle);
+  }
+#endif
+}
+
+#ifdef DEBUG_GRID
+void drawDebugGrid()
+{
+  int gridSpacing = 10; // Espacement entre les lignes de la grille
+  int screenWidth = 122;
+  int screenHeight = 250;
+
+  // Dessiner des lignes verticales
+  for (int x = 0; x <= screenWidth; x += gridSpacing)
+  {
+    canvas.drawLine(x, 0, x, screenHeight, GxEPD_BLACK);
+  }
+
+  // Dessiner des lignes horizontales
+  for (int y = 0; y <= screenHeight; y += gridSpacing)
+  {
+    canvas.drawLine(0, y, screenWidth, y, GxEPD_BLACK);
+  }
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+// Ecran e-paper GxDEPG0213BN du Lilygo T5
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "Hal.h"
+
+class EpdPanel : public Panel
+{
+public:
+  // fullRefreshEvery : rafraîchissements partiels avant un complet anti-fantômes
+  // sleepWhileBusy : sommeil léger pendant que l'écran travaille, le WiFi doit être coupé
+  EpdPanel(int fullRefreshEvery, bool sleepWhileBusy)
+      : fullRefreshEvery(fullRefreshEvery), sleepWhileBusy(sleepWhileBusy) {}
+  void init() override;
+  void printLine(const char *text) override;
+  void drawBackground() override;
+  void drawTempo(const TempoView &view) override;
+  void update() override;
+  PanelStats stats() override;
+
+private:
+  void refresh();
+  void restoreControllerRam();
+  void startParking();
+  void stopParking();
+  static void parkTask(void *parameter);
+  static void busyRising(void *parameter);
+
+  int fullRefreshEvery;
+  bool sleepWhileBusy;
+  int currentLinePos = 0;
+  bool textMode = false;
+  bool backgroundReady = false;
+  bool ramHoldsLastFrame = false; // RAM du contrôleur égale à lastFrame depuis init()
+  PanelStats lastStats = {};
+  volatile bool parking = false;
+  uint64_t parkedUs = 0;
+  SemaphoreHandle_t parkDone = nullptr;
+  TaskHandle_t parkHandle = nullptr;
+};
@@ -0,0 +1,599 @@
+#include "EspHal.h"
+
+#include <WiFi.h>
+#include <LittleFS.h>
+#include <MyDumbWifi.h>
+#include <Preferences.h>
+#include <TempoLikeSupplyContractAPI.h>
+#include "time.h"
+#include <stddef.h>
+#include <sys/time.h>
+#include <esp_heap_caps.h>
+#include <esp_sleep.h>
+#include <esp_sntp.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#include "Checksum.h"
+#include "RteClient.h"
+#include "TempoHub.h"
+
+// Point d'accès et bail DHCP de la dernière connexion réussie
+struct WifiCache
+{
+  uint8_t bssid[6];
+  int32_t channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns1;
+  uint32_t dns2;
+  time_t leaseStart;
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+RTC_DATA_ATTR WifiCache wifiCache;
+RTC_DATA_ATTR uint16_t wifiFastHits = 0;
+RTC_DATA_ATTR uint16_t wifiFastMisses = 0;
+
+// Au-delà, le point d'accès a probablement changé de canal ou disparu
+static const unsigned long FAST_CONNECT_TIMEOUT_MS = 1500;
+// Au-delà, on redemande un bail plutôt que de réutiliser une IP peut-être réattribuée
+static const time_t STATIC_IP_MAX_AGE_SECONDS = 12 * 3600;
+
+unsigned long EspBoard::millis()
+{
+  return ::millis();
+}
+
+uint64_t EspBoard::micros()
+{
+  return esp_timer_get_time();
+}
+
+void EspBoard::delay(unsigned long ms)
+{
+  ::delay(ms);
+}
+
+int EspBoard::readBatteryRaw()
+{
+  return analogRead(pinBattery);
+}
+
+uint32_t EspBoard::freeHeap()
+{
+  return ESP.getFreeHeap();
+}
+
+uint32_t EspBoard::minFreeHeap()
+{
+  return heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspBoard::stackFree()
+{
+  // En octets sur ESP32 (StackType_t fait un octet)
+  return uxTaskGetStackHighWaterMark(nullptr);
+}
+
+WakeCause EspBoard::wakeCause()
+{
+  switch (esp_sleep_get_wakeup_cause())
+  {
+  case ESP_SLEEP_WAKEUP_EXT0:
+    return WAKE_CAUSE_BUTTON;
+  case ESP_SLEEP_WAKEUP_TIMER:
+    return WAKE_CAUSE_TIMER;
+  default:
+    return WAKE_CAUSE_POWER_ON;
+  }
+}
+
+// Une requête HTTPS complète, client TLS compris
+#define BACKGROUND_TASK_STACK 12288
+
+void EspBoard::backgroundTask(void *parameter)
+{
+  EspBoard *board = static_cast<EspBoard *>(parameter);
+  board->backgroundJob(board->backgroundContext);
+  Serial.printf("Tâche de fond : %u octets de pile jamais utilisés sur %u.\n",
+                (unsigned)uxTaskGetStackHighWaterMark(nullptr), BACKGROUND_TASK_STACK);
+  xSemaphoreGive(board->backgroundDone);
+  vTaskDelete(nullptr);
+}
+
+bool EspBoard::startBackground(void (*job)(void *context), void *context)
+{
+  if (backgroundDone != nullptr)
+  {
+    return false;
+  }
+  backgroundJob = job;
+  backgroundContext = context;
+  backgroundDone = xSemaphoreCreateBinary();
+  // Même cœur que la boucle principale : la pile WiFi garde le cœur 0 pour elle
+  if (backgroundDone == nullptr ||
+      xTaskCreatePinnedToCore(backgroundTask, "source", BACKGROUND_TASK_STACK, this, 1, nullptr,
+                              xPortGetCoreID()) != pdPASS)
+  {
+    if (backgroundDone != nullptr)
+    {
+      vSemaphoreDelete(backgroundDone);
+      backgroundDone = nullptr;
+    }
+    return false;
+  }
+  return true;
+}
+
+bool EspBoard::waitBackground(unsigned long timeoutMs)
+{
+  if (backgroundDone == nullptr)
+  {
+    return true;
+  }
+  if (xSemaphoreTake(backgroundDone, pdMS_TO_TICKS(timeoutMs)) != pdTRUE)
+  {
+    return false;
+  }
+  vSemaphoreDelete(backgroundDone);
+  backgroundDone = nullptr;
+  return true;
+}
+
+uint32_t EspBoard::random32()
+{
+  return esp_random();
+}
+
+void EspBoard::log(const char *message)
+{
+  Serial.println(message);
+}
+
+int EspBoard::readCommand()
+{
+  return Serial.available() > 0 ? Serial.read() : -1;
+}
+
+// Un bouton encore tenu réveillerait la carte aussitôt endormie
+#define BUTTON_RELEASE_MS 3000
+
+void EspBoard::deepSleep(uint64_t seconds)
+{
+  if (seconds > 0)
+  {
+    esp_sleep_enable_timer_wakeup(seconds * 1000000ULL);
+  }
+  if (pinButton >= 0)
+  {
+    pinMode(pinButton, INPUT);
+    unsigned long start = ::millis();
+    while (digitalRead(pinButton) == LOW && ::millis() - start < BUTTON_RELEASE_MS)
+    {
+      ::delay(10);
+    }
+    if (digitalRead(pinButton) == HIGH)
+    {
+      esp_sleep_enable_ext0_wakeup((gpio_num_t)pinButton, 0);
+    }
+  }
+  esp_deep_sleep_start();
+}
+
+void EspClock::configureNtp(const char *timeZone, const char *ntpServer)
+{
+  configTzTime(timeZone, ntpServer);
+}
+
+bool EspClock::ntpSynced()
+{
+  return sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED;
+}
+
+void EspClock::setTimeZone(const char *timeZone)
+{
+  setenv("TZ", timeZone, 1);
+  tzset();
+}
+
+time_t EspClock::now()
+{
+  time_t now;
+  time(&now);
+  return now;
+}
+
+void EspClock::adjust(long seconds)
+{
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  tv.tv_sec += seconds;
+  settimeofday(&tv, nullptr);
+}
+
+static uint32_t wifiCacheChecksum()
+{
+  return fnv1a(&wifiCache, offsetof(WifiCache, checksum));
+}
+
+static bool wifiCacheIsValid()
+{
+  return wifiCache.channel > 0 && wifiCache.checksum == wifiCacheChecksum();
+}
+
+static void saveWifiCache(bool newLease)
+{
+  time_t leaseStart = newLease ? time(nullptr) : wifiCache.leaseStart;
+  memset(&wifiCache, 0, sizeof(wifiCache));
+  memcpy(wifiCache.bssid, WiFi.BSSID(), sizeof(wifiCache.bssid));
+  wifiCache.channel = WiFi.channel();
+  wifiCache.ip = WiFi.localIP();
+  wifiCache.gateway = WiFi.gatewayIP();
+  wifiCache.subnet = WiFi.subnetMask();
+  wifiCache.dns1 = WiFi.dnsIP(0);
+  wifiCache.dns2 = WiFi.dnsIP(1);
+  wifiCache.leaseStart = leaseStart;
+  wifiCache.checksum = wifiCacheChecksum();
+}
+
+bool EspNetwork::connectDirect(const char *ssid, const char *key, bool staticIp)
+{
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  if (staticIp)
+  {
+    WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway), IPAddress(wifiCache.subnet),
+                IPAddress(wifiCache.dns1), IPAddress(wifiCache.dns2));
+  }
+  WiFi.begin(ssid, key, wifiCache.channel, wifiCache.bssid, true);
+
+  unsigned long start = ::millis();
+  while (WiFi.status() != WL_CONNECTED && ::millis() - start < FAST_CONNECT_TIMEOUT_MS)
+  {
+    ::delay(10);
+  }
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    return true;
+  }
+
+  // Retour au DHCP pour le scan complet
+  WiFi.disconnect();
+  WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+  return false;
+}
+
+bool EspNetwork::connect(const char *ssid, const char *key)
+{
+  unsigned long start = ::millis();
+
+  if (wifiCacheIsValid())
+  {
+    time_t now = time(nullptr);
+    bool leaseFresh = now >= wifiCache.leaseStart && now - wifiCache.leaseStart < STATIC_IP_MAX_AGE_SECONDS;
+    if (connectDirect(ssid, key, leaseFresh))
+    {
+      wifiFastHits++;
+      saveWifiCache(!leaseFresh);
+      lastStats = {::millis() - start, leaseFresh ? CONNECT_STATIC_IP : CONNECT_DIRECTED, wifiFastHits, wifiFastMisses};
+      return true;
+    }
+    wifiFastMisses++;
+    memset(&wifiCache, 0, sizeof(wifiCache));
+    Serial.println("Connexion WiFi rapide échouée, scan complet.");
+  }
+
+  MyDumbWifi mdw;
+  if (debug)
+  {
+    mdw.setDebug(true);
+  }
+  bool connected = mdw.connectToWiFi(ssid, key);
+  if (connected)
+  {
+    saveWifiCache(true);
+  }
+  lastStats = {::millis() - start, CONNECT_FULL_SCAN, wifiFastHits, wifiFastMisses};
+  return connected;
+}
+
+// Assez de pile pour MyDumbWifi et ses traces série
+#define CONNECT_TASK_STACK 8192
+#define CONNECT_TASK_CORE 0
+
+void EspNetwork::connectTask(void *parameter)
+{
+  EspNetwork *network = static_cast<EspNetwork *>(parameter);
+  network->pendingResult = network->connect(network->pendingSsid, network->pendingKey);
+  // Le sémaphore n'est supprimé qu'une fois pris : il existe encore ici
+  xSemaphoreGive(network->connectDone);
+  vTaskDelete(nullptr);
+}
+
+void EspNetwork::startConnect(const char *ssid, const char *key)
+{
+  if (connectDone != nullptr)
+  {
+    // Tâche précédente pas encore reprise par finishConnect : une seule
+    // connexion à la fois, finishConnect attendra celle-là
+    Serial.println("Connexion WiFi déjà en cours.");
+    return;
+  }
+  pendingSsid = ssid;
+  pendingKey = key;
+  pendingResult = false;
+  connectInline = false;
+  connectDone = xSemaphoreCreateBinary();
+  if (connectDone == nullptr ||
+      xTaskCreatePinnedToCore(connectTask, "wifi", CONNECT_TASK_STACK, this, 1, nullptr, CONNECT_TASK_CORE) != pdPASS)
+  {
+    // Pas de tâche possible : connexion faite plus tard, dans finishConnect
+    if (connectDone != nullptr)
+    {
+      vSemaphoreDelete(connectDone);
+      connectDone = nullptr;
+    }
+    connectInline = true;
+  }
+}
+
+bool EspNetwork::finishConnect(unsigned long timeoutMs)
+{
+  if (connectDone == nullptr)
+  {
+    if (!connectInline)
+    {
+      return isConnected();
+    }
+    connectInline = false;
+    return connect(pendingSsid, pendingKey);
+  }
+  if (xSemaphoreTake(connectDone, pdMS_TO_TICKS(timeoutMs)) != pdTRUE)
+  {
+    // La tâche continue et donnera le sémaphore en finissant : il reste en place
+    // jusqu'à ce qu'un prochain finishConnect le prenne, et startConnect refuse
+    // d'ici là d'en lancer une autre
+    Serial.printf("Connexion WiFi abandonnée après %lu ms.\n", timeoutMs);
+    lastStats.connectMs = timeoutMs;
+    return false;
+  }
+  vSemaphoreDelete(connectDone);
+  connectDone = nullptr;
+  return pendingResult;
+}
+
+NetworkStats EspNetwork::stats()
+{
+  return lastStats;
+}
+
+bool EspNetwork::isConnected()
+{
+  return WiFi.status() == WL_CONNECTED;
+}
+
+void EspNetwork::disconnect()
+{
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+}
+
+bool EspTempoApi::fetchFree(const char *today, const char *tomorrow,
+                            const char *season, TempoResult &result, unsigned long timeoutMs)
+{
+  // Les identifiants ne servent pas sans inscription
+  RteClient client(clientSecret, clientId, freeHost, freePort, debug);
+  bool fetched = client.fetchFreeColors(today, tomorrow, season, DAY_NOT_AVAILABLE, result, timeoutMs);
+  lastStats = client.stats();
+  return fetched;
+}
+
+bool EspTempoApi::fetchAccount(const char *today, const char *tomorrow, const char *dayAfter,
+                               const char *seasonStart, TempoResult &result, unsigned long timeoutMs)
+{
+  RteClient client(clientSecret, clientId, accountHost, accountPort, debug);
+  bool fetched = client.fetchColors(today, tomorrow, dayAfter, seasonStart, DAY_NOT_AVAILABLE, result, timeoutMs);
+  lastStats = client.stats();
+  return fetched;
+}
+
+// Ligne terminée par \n, sans \r. -1 si rien n'est arrivé avant la fin du délai
+// ou de la connexion.
+static int readLine(WiFiClient &client, char *line, size_t size, unsigned long start, unsigned long timeoutMs)
+{
+  size_t length = 0;
+  line[0] = '\0';
+  while (::millis() - start < timeoutMs)
+  {
+    int c = client.read();
+    if (c < 0)
+    {
+      if (!client.connected())
+      {
+        return length > 0 ? (int)length : -1;
+      }
+      ::delay(1);
+      continue;
+    }
+    if (c == '\n')
+    {
+      return (int)length;
+    }
+    if (c != '\r' && length + 1 < size)
+    {
+      line[length++] = (char)c;
+      line[length] = '\0';
+    }
+  }
+  return -1;
+}
+
+bool EspTempoApi::fetchHub(const char *host, uint16_t port, char *line, size_t size, unsigned long timeoutMs)
+{
+  unsigned long start = ::millis();
+  // HTTP simple sur le réseau local : aucune poignée de main TLS
+  lastStats = {0, 1, 0, 0};
+  WiFiClient client;
+  bool fetched = false;
+  if (timeoutMs > 0 && client.connect(host, port, timeoutMs))
+  {
+    client.printf("GET %s HTTP/1.0\r\nHost: %s\r\n\r\n", TEMPO_HUB_PATH, host);
+    int status = 0;
+    if (readLine(client, line, size, start, timeoutMs) > 0 && sscanf(line, "HTTP/%*s %d", &status) == 1 &&
+        status == 200)
+    {
+      // En-têtes jusqu'à la ligne vide, puis la ligne du hub
+      int length;
+      while ((length = readLine(client, line, size, start, timeoutMs)) > 0)
+      {
+      }
+      fetched = length == 0 && readLine(client, line, size, start, timeoutMs) > 0;
+    }
+    client.stop();
+  }
+  lastStats.fetchMs = ::millis() - start;
+  lastStats.bytes = fetched ? strlen(line) : 0;
+  return fetched;
+}
+
+ApiStats EspTempoApi::stats()
+{
+  return lastStats;
+}
+
+// Requête et en-têtes d'un écran du réseau local
+#define HUB_REQUEST_TIMEOUT_MS 1000
+
+void EspHubServer::serve(const char *line, uint64_t seconds)
+{
+  WiFiServer server(port);
+  server.begin();
+  uint64_t start = esp_timer_get_time();
+  int served = 0;
+  while ((uint64_t)(esp_timer_get_time() - start) < seconds * 1000000ULL && WiFi.status() == WL_CONNECTED)
+  {
+    WiFiClient client = server.available();
+    if (!client)
+    {
+      ::delay(20);
+      continue;
+    }
+    char request[64];
+    char header[64];
+    unsigned long begin = ::millis();
+    int length = readLine(client, request, sizeof(request), begin, HUB_REQUEST_TIMEOUT_MS);
+    while (length >= 0 && readLine(client, header, sizeof(header), begin, HUB_REQUEST_TIMEOUT_MS) > 0)
+    {
+    }
+    if (length < 0 || strncmp(request, "GET " TEMPO_HUB_PATH " ", strlen("GET " TEMPO_HUB_PATH " ")) != 0)
+    {
+      client.print("HTTP/1.0 404 Not Found\r\n\r\n");
+    }
+    else if (line[0] == '\0')
+    {
+      client.print("HTTP/1.0 503 Service Unavailable\r\n\r\n");
+    }
+    else
+    {
+      client.print("HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\n\r\n");
+      client.print(line);
+      served++;
+    }
+    client.stop();
+  }
+  server.end();
+  Serial.printf("Hub : %d requête(s) servie(s).\n", served);
+}
+
+bool EspStorage::load(const char *key, void *data, size_t size)
+{
+  Preferences preferences;
+  if (!preferences.begin("tempo", true))
+  {
+    return false;
+  }
+  bool loaded = preferences.getBytesLength(key) == size && preferences.getBytes(key, data, size) == size;
+  preferences.end();
+  return loaded;
+}
+
+bool EspStorage::save(const char *key, const void *data, size_t size)
+{
+  Preferences preferences;
+  if (!preferences.begin("tempo", false))
+  {
+    return false;
+  }
+  bool saved = preferences.putBytes(key, data, size) == size;
+  preferences.end();
+  return saved;
+}
+
+static void logFilePath(char *path, size_t size, int file)
+{
+  snprintf(path, size, "/ev%d", file);
+}
+
+bool EspLogFiles::mount()
+{
+  if (!mounted)
+  {
+    mounted = LittleFS.begin(true);
+    if (!mounted)
+    {
+      Serial.println("LittleFS indisponible : journal d'événements désactivé.");
+    }
+  }
+  return mounted;
+}
+
+size_t EspLogFiles::size(int file)
+{
+  char path[8];
+  logFilePath(path, sizeof(path), file);
+  if (!mount() || !LittleFS.exists(path))
+  {
+    return 0;
+  }
+  File handle = LittleFS.open(path, "r");
+  size_t size = handle ? handle.size() : 0;
+  handle.close();
+  return size;
+}
+
+bool EspLogFiles::append(int file, const void *data, size_t size)
+{
+  char path[8];
+  logFilePath(path, sizeof(path), file);
+  if (!mount())
+  {
+    return false;
+  }
+  File handle = LittleFS.open(path, "a");
+  bool written = handle && handle.write(static_cast<const uint8_t *>(data), size) == size;
+  handle.close();
+  return written;
+}
+
+bool EspLogFiles::read(int file, size_t offset, void *data, size_t size)
+{
+  char path[8];
+  logFilePath(path, sizeof(path), file);
+  if (!mount() || !LittleFS.exists(path))
+  {
+    return false;
+  }
+  File handle = LittleFS.open(path, "r");
+  bool read = handle && handle.seek(offset) && handle.read(static_cast<uint8_t *>(data), size) == size;
+  handle.close();
+  return read;
+}
+
+bool EspLogFiles::remove(int file)
+{
+  char path[8];
+  logFilePath(path, sizeof(path), file);
+  return mount() && (!LittleFS.exists(path) || LittleFS.remove(path));
+}
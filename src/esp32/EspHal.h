@@ -0,0 +1,140 @@
+#pragma once
+
+// Implémentations ESP32 / Arduino des interfaces de Hal.h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "Hal.h"
+
+class EspBoard : public Board
+{
+public:
+  // pinButton : broche RTC du bouton, active à l'état bas, -1 sans bouton
+  EspBoard(int pinBattery, int pinButton) : pinBattery(pinBattery), pinButton(pinButton) {}
+  unsigned long millis() override;
+  uint64_t micros() override;
+  void delay(unsigned long ms) override;
+  int readBatteryRaw() override;
+  uint32_t freeHeap() override;
+  uint32_t minFreeHeap() override;
+  uint32_t stackFree() override;
+  WakeCause wakeCause() override;
+  bool startBackground(void (*job)(void *context), void *context) override;
+  bool waitBackground(unsigned long timeoutMs) override;
+  uint32_t random32() override;
+  void log(const char *message) override;
+  int readCommand() override;
+  void deepSleep(uint64_t seconds) override;
+
+private:
+  static void backgroundTask(void *parameter);
+  int pinBattery;
+  int pinButton;
+  void (*backgroundJob)(void *context) = nullptr;
+  void *backgroundContext = nullptr;
+  // Gardé jusqu'à ce que la tâche soit attendue jusqu'au bout, au besoin jusqu'au deep sleep
+  SemaphoreHandle_t backgroundDone = nullptr;
+};
+
+class EspClock : public Clock
+{
+public:
+  void configureNtp(const char *timeZone, const char *ntpServer) override;
+  bool ntpSynced() override;
+  void setTimeZone(const char *timeZone) override;
+  time_t now() override;
+  void adjust(long seconds) override;
+};
+
+// Tente d'abord une connexion directe sur le point d'accès et le canal de la
+// dernière connexion, avec l'IP obtenue alors tant que le bail est récent,
+// puis revient au scan complet de MyDumbWifi. startConnect fait tout cela dans
+// une tâche sur le cœur 0, celui de la pile WiFi, pendant que la boucle
+// principale prépare l'écran sur le cœur 1.
+class EspNetwork : public Network
+{
+public:
+  explicit EspNetwork(bool debug) : debug(debug) {}
+  void startConnect(const char *ssid, const char *key) override;
+  bool finishConnect(unsigned long timeoutMs) override;
+  bool isConnected() override;
+  void disconnect() override;
+  NetworkStats stats() override;
+
+  // Connexion bloquante, exécutée par la tâche de startConnect
+  bool connect(const char *ssid, const char *key);
+
+private:
+  static void connectTask(void *parameter);
+  bool connectDirect(const char *ssid, const char *key, bool staticIp);
+  bool debug;
+  NetworkStats lastStats = {};
+  const char *pendingSsid = nullptr;
+  const char *pendingKey = nullptr;
+  bool pendingResult = false;
+  bool connectInline = false;             // pas de tâche : finishConnect se connecte lui-même
+  SemaphoreHandle_t connectDone = nullptr; // tâche lancée et pas encore reprise par finishConnect
+};
+
+// Les deux API passent par RteClient, une connexion pour tout le réveil, chacune
+// sur son serveur.
+class EspTempoApi : public TempoApi
+{
+public:
+  EspTempoApi(const String &clientSecret, const String &clientId, const char *accountHost,
+              uint16_t accountPort, const char *freeHost, uint16_t freePort, bool debug)
+      : clientSecret(clientSecret), clientId(clientId), accountHost(accountHost),
+        accountPort(accountPort), freeHost(freeHost), freePort(freePort), debug(debug) {}
+  bool fetchFree(const char *today, const char *tomorrow,
+                 const char *season, TempoResult &result, unsigned long timeoutMs) override;
+  bool fetchAccount(const char *today, const char *tomorrow, const char *dayAfter,
+                    const char *seasonStart, TempoResult &result, unsigned long timeoutMs) override;
+  bool fetchHub(const char *host, uint16_t port, char *line, size_t size, unsigned long timeoutMs) override;
+  ApiStats stats() override;
+
+private:
+  const String &clientSecret;
+  const String &clientId;
+  const char *accountHost;
+  uint16_t accountPort;
+  const char *freeHost;
+  uint16_t freePort;
+  bool debug;
+  ApiStats lastStats = {};
+};
+
+// Serveur HTTP du rôle hub, une requête à la fois
+class EspHubServer : public HubServer
+{
+public:
+  explicit EspHubServer(uint16_t port) : port(port) {}
+  void serve(const char *line, uint64_t seconds) override;
+
+private:
+  uint16_t port;
+};
+
+// Espace de noms NVS "tempo" (Preferences)
+class EspStorage : public Storage
+{
+public:
+  bool load(const char *key, void *data, size_t size) override;
+  bool save(const char *key, const void *data, size_t size) override;
+};
+
+// Fichiers "/ev0", "/ev1"... de la partition de données, montée en LittleFS au
+// premier accès et formatée si elle ne l'a jamais été
+class EspLogFiles : public LogFiles
+{
+public:
+  size_t size(int file) override;
+  bool append(int file, const void *data, size_t size) override;
+  bool read(int file, size_t offset, void *data, size_t size) override;
+  bool remove(int file) override;
+
+private:
+  bool mount();
+  bool mounted = false;
+};
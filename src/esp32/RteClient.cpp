@@ -0,0 +1,507 @@
+#include "RteClient.h"
+
+#include <ArduinoJson.h>
+#include <mbedtls/base64.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "Checksum.h"
+
+#define RTE_TOKEN_URI "/token/oauth/"
+#define RTE_CALENDAR_URI "/open_api/tempo_like_supply_contract/v1/tempo_like_calendars"
+// API sans inscription : aujourd'hui et demain, puis toute la saison
+#define RTE_FREE_DAYS_URI "/cms/open_data/v1/tempoLight"
+#define RTE_FREE_SEASON_URI "/cms/open_data/v1/tempo?season="
+// "id:secret" de l'application RTE, puis "Basic " et son encodage base64
+#define RTE_CREDENTIALS_LEN 160
+#define RTE_BASIC_LEN (6 + (RTE_CREDENTIALS_LEN + 2) / 3 * 4 + 1)
+// Chemin du calendrier avec deux dates encodées
+#define RTE_URI_LEN 192
+
+// Jeton OAuth de la dernière authentification, valable environ 2 h
+struct RteToken
+{
+  char value[RTE_TOKEN_LEN];
+  time_t expiresAt;
+  uint32_t checksum; // doit rester le dernier champ
+};
+
+RTC_DATA_ATTR RteToken rteToken;
+RTC_DATA_ATTR uint16_t rteTokenReuses = 0;
+RTC_DATA_ATTR FreeCache freeCache;
+
+// Marge pour ne pas présenter un jeton qui expire pendant la requête
+static const time_t TOKEN_MARGIN_SECONDS = 120;
+static const uint16_t HTTP_TIMEOUT_MS = 8000;
+
+static uint32_t tokenChecksum()
+{
+  return fnv1a(&rteToken, offsetof(RteToken, checksum));
+}
+
+static bool tokenIsValid(time_t now)
+{
+  return rteToken.checksum == tokenChecksum() && rteToken.value[0] != '\0' &&
+         now + TOKEN_MARGIN_SECONDS < rteToken.expiresAt;
+}
+
+static void forgetToken()
+{
+  memset(&rteToken, 0, sizeof(rteToken));
+}
+
+static void saveToken(const char *token, long expiresIn, time_t now)
+{
+  forgetToken();
+  strcpy(rteToken.value, token);
+  rteToken.expiresAt = now + expiresIn;
+  rteToken.checksum = tokenChecksum();
+}
+
+// Le '+' du décalage horaire doit être encodé dans l'URL. Longueur de uri ensuite,
+// size ou plus si le tampon est trop petit.
+static size_t appendEncoded(char *uri, size_t size, size_t length, const char *date)
+{
+  for (const char *c = date; *c != '\0' && length < size; c++)
+  {
+    const char *piece = *c == '+' ? "%2B" : nullptr;
+    size_t pieceLength = piece ? 3 : 1;
+    if (length + pieceLength >= size)
+    {
+      return size;
+    }
+    memcpy(uri + length, piece ? piece : c, pieceLength);
+    length += pieceLength;
+  }
+  if (length < size)
+  {
+    uri[length] = '\0';
+  }
+  return length;
+}
+
+static const char *frenchColors[] = {nullptr, "BLEU", "BLANC", "ROUGE"};
+
+// Lecture bloquante avec le délai de la connexion, comme Stream::readBytes
+class StreamReader : public ByteReader
+{
+public:
+  explicit StreamReader(Stream &stream) : stream(stream) {}
+
+  int read() override
+  {
+    char c;
+    return stream.readBytes(&c, 1) == 1 ? (unsigned char)c : -1;
+  }
+
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    return stream.readBytes(buffer, length);
+  }
+
+private:
+  Stream &stream;
+};
+
+// Avec DEBUG_API, recopie sur le port série ce qui est lu, pour enregistrer les
+// échanges et les rejouer avec tools/rte_standin.py
+class TeeReader : public ByteReader
+{
+public:
+  TeeReader(ByteReader &source, Print *copy) : source(source), copy(copy) {}
+
+  int read() override
+  {
+    int c = source.read();
+    if (c >= 0 && copy != nullptr)
+    {
+      copy->write((uint8_t)c);
+    }
+    return c;
+  }
+
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    size_t count = source.readBytes(buffer, length);
+    if (copy != nullptr)
+    {
+      copy->write((const uint8_t *)buffer, count);
+    }
+    return count;
+  }
+
+  void drain()
+  {
+    while (read() >= 0)
+    {
+    }
+  }
+
+private:
+  ByteReader &source;
+  Print *copy;
+};
+
+// Empreinte du corps au fil de la lecture, pour les serveurs sans validateur
+class HashReader : public ByteReader
+{
+public:
+  explicit HashReader(ByteReader &source) : source(source) {}
+
+  int read() override
+  {
+    int c = source.read();
+    if (c >= 0)
+    {
+      uint8_t byte = (uint8_t)c;
+      value = fnv1a(&byte, 1, value);
+    }
+    return c;
+  }
+
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    size_t count = source.readBytes(buffer, length);
+    value = fnv1a(buffer, count, value);
+    return count;
+  }
+
+  void drain()
+  {
+    while (read() >= 0)
+    {
+    }
+  }
+
+  uint32_t hash() const { return value; }
+
+private:
+  ByteReader &source;
+  uint32_t value = FNV1A_INIT;
+};
+
+static void copyColor(char *dest, const char *color)
+{
+  strncpy(dest, color, TEMPO_COLOR_LEN - 1);
+  dest[TEMPO_COLOR_LEN - 1] = '\0';
+}
+
+RteClient::RteClient(const String &clientSecret, const String &clientId, const char *host, uint16_t port, bool debug)
+    : clientSecret(clientSecret), clientId(clientId), host(host), port(port), debug(debug)
+{
+  // Pas de magasin de certificats sur la carte, comme avec la librairie
+  client.setInsecure();
+  http.setReuse(true);
+  http.setTimeout(HTTP_TIMEOUT_MS);
+  // Le corps du calendrier est lu directement sur la connexion
+  static const char *headerKeys[] = {"Transfer-Encoding", "ETag", "Last-Modified"};
+  http.collectHeaders(headerKeys, 3);
+}
+
+// Le corps de la réponse reste à lire sur la connexion
+int RteClient::send(const char *method, const char *uri, const char *authorization, const FreeEntry *cached)
+{
+  // HTTPClient reprend la connexion ouverte tant que le serveur ne la ferme pas
+  if (!client.connected())
+  {
+    lastStats.connections++;
+  }
+  // Délais de la connexion ramenés à ce qui reste du temps accordé
+  unsigned long elapsed = millis() - startMs;
+  if (elapsed >= allowedMs)
+  {
+    return HTTPC_ERROR_READ_TIMEOUT;
+  }
+  unsigned long remaining = allowedMs - elapsed;
+  http.setConnectTimeout(remaining);
+  http.setTimeout(remaining < HTTP_TIMEOUT_MS ? remaining : HTTP_TIMEOUT_MS);
+  client.setHandshakeTimeout((remaining + 999) / 1000);
+
+  lastStats.requests++;
+  if (!http.begin(client, host, port, uri, true))
+  {
+    return -1;
+  }
+  if (authorization != nullptr)
+  {
+    http.addHeader("Authorization", authorization);
+  }
+  if (cached != nullptr && cached->etag[0] != '\0')
+  {
+    http.addHeader("If-None-Match", cached->etag);
+  }
+  if (cached != nullptr && cached->lastModified[0] != '\0')
+  {
+    http.addHeader("If-Modified-Since", cached->lastModified);
+  }
+  http.addHeader("Accept", "application/json");
+  if (debug)
+  {
+    // Enregistrement : ">>> requête", "<<< statut", corps, "<<< fin"
+    Serial.printf("\n>>> %s %s\n", method, uri);
+  }
+  int code = strcmp(method, "POST") == 0 ? http.POST("") : http.GET();
+  if (debug)
+  {
+    Serial.printf("<<< %d\n", code);
+  }
+  return code;
+}
+
+int RteClient::requestToken(char *token)
+{
+  token[0] = '\0';
+  char credentials[RTE_CREDENTIALS_LEN];
+  int length = snprintf(credentials, sizeof(credentials), "%s:%s", clientId.c_str(), clientSecret.c_str());
+  char authorization[RTE_BASIC_LEN] = "Basic ";
+  size_t encoded = 0;
+  if (length >= (int)sizeof(credentials) ||
+      mbedtls_base64_encode((unsigned char *)authorization + 6, sizeof(authorization) - 6, &encoded,
+                            (const unsigned char *)credentials, length) != 0)
+  {
+    return -3;
+  }
+
+  int code = send("POST", RTE_TOKEN_URI, authorization, nullptr);
+  // Quelques centaines d'octets, lus sur la connexion comme le calendrier
+  StaticJsonDocument<32> filter;
+  filter["access_token"] = true;
+  filter["expires_in"] = true;
+  StaticJsonDocument<256> doc;
+  bool parsed = false;
+  if (code > 0)
+  {
+    StreamReader stream(http.getStream());
+    HttpBodyReader body(stream, http.getSize(), http.header("Transfer-Encoding") == "chunked");
+    TeeReader capture(body, debug ? &Serial : nullptr);
+    parsed = code == 200 &&
+             deserializeJson(doc, capture, DeserializationOption::Filter(filter)) == DeserializationError::Ok;
+    capture.drain();
+    lastStats.bytes += body.bytesRead();
+  }
+  http.end();
+  if (debug)
+  {
+    Serial.print("\n<<< fin\n");
+  }
+  if (code != 200)
+  {
+    return code;
+  }
+  const char *value = doc["access_token"] | "";
+  if (!parsed || value[0] == '\0' || strlen(value) >= RTE_TOKEN_LEN)
+  {
+    return -2;
+  }
+  strcpy(token, value);
+  saveToken(token, doc["expires_in"] | 3600L, time(nullptr));
+  return code;
+}
+
+int RteClient::requestCalendar(const char *token, const char *start, const char *end,
+                               const char *today, const char *tomorrow, RteCalendar &calendar)
+{
+  char uri[RTE_URI_LEN] = RTE_CALENDAR_URI "?start_date=";
+  size_t length = appendEncoded(uri, sizeof(uri), strlen(uri), start);
+  length = appendEncoded(uri, sizeof(uri), length, "&end_date=");
+  length = appendEncoded(uri, sizeof(uri), length, end);
+  char authorization[RTE_TOKEN_LEN + 8];
+  snprintf(authorization, sizeof(authorization), "Bearer %s", token);
+  if (length >= sizeof(uri))
+  {
+    return -3;
+  }
+  int code = send("GET", uri, authorization, nullptr);
+  if (code <= 0)
+  {
+    http.end();
+    if (debug)
+    {
+      Serial.print("<<< fin\n");
+    }
+    return code;
+  }
+
+  // Le corps est lu jusqu'au bout, même en erreur, pour garder la connexion
+  StreamReader stream(http.getStream());
+  HttpBodyReader body(stream, http.getSize(), http.header("Transfer-Encoding") == "chunked");
+  TeeReader capture(body, debug ? &Serial : nullptr);
+  bool parsed = code == 200 && rteCalendarParse(capture, today, tomorrow, calendar);
+  capture.drain();
+  lastStats.bytes += body.bytesRead();
+  http.end();
+  if (debug)
+  {
+    // Résultat attendu au rejeu : dates, couleurs (DayColor), bleus, blancs, rouges, jours
+    if (parsed)
+    {
+      Serial.printf("\n<<< attendu %.10s %d %.10s %d %d %d %d %d", today, calendar.today, tomorrow,
+                    calendar.tomorrow, calendar.counts.blue, calendar.counts.white, calendar.counts.red,
+                    calendar.days);
+    }
+    Serial.print("\n<<< fin\n");
+  }
+  return code == 200 && !parsed ? -2 : code;
+}
+
+bool RteClient::fetchColors(const char *today, const char *tomorrow, const char *dayAfter,
+                            const char *seasonStart, const char *notAvailable, TempoResult &result,
+                            unsigned long timeoutMs)
+{
+  unsigned long start = millis();
+  startMs = start;
+  allowedMs = timeoutMs;
+  lastStats = {};
+  memset(result.errorCodes, 0, sizeof(result.errorCodes));
+  copyColor(result.todayColor, notAvailable);
+  copyColor(result.tomorrowColor, notAvailable);
+
+  // errorCodes[0] : jeton (0 s'il vient de la mémoire RTC), [1] : calendrier
+  char token[RTE_TOKEN_LEN] = "";
+  if (tokenIsValid(time(nullptr)))
+  {
+    strcpy(token, rteToken.value);
+    rteTokenReuses++;
+  }
+  else
+  {
+    result.errorCodes[0] = requestToken(token);
+  }
+
+  RteCalendar calendar = {};
+  if (token[0] != '\0')
+  {
+    result.errorCodes[1] = requestCalendar(token, seasonStart, dayAfter, today, tomorrow, calendar);
+    if (result.errorCodes[1] == 401 && result.errorCodes[0] == 0)
+    {
+      // Jeton révoqué côté RTE : une seule nouvelle authentification
+      forgetToken();
+      result.errorCodes[0] = requestToken(token);
+      if (result.errorCodes[0] == 200)
+      {
+        result.errorCodes[1] = requestCalendar(token, seasonStart, dayAfter, today, tomorrow, calendar);
+      }
+    }
+  }
+  client.stop();
+
+  bool fetched = result.errorCodes[1] == 200;
+  if (fetched)
+  {
+    if (calendar.today != DAY_UNKNOWN)
+    {
+      copyColor(result.todayColor, frenchColors[calendar.today]);
+    }
+    if (calendar.tomorrow != DAY_UNKNOWN)
+    {
+      copyColor(result.tomorrowColor, frenchColors[calendar.tomorrow]);
+    }
+    result.countBlue = calendar.counts.blue;
+    result.countWhite = calendar.counts.white;
+    result.countRed = calendar.counts.red;
+  }
+
+  lastStats.fetchMs = millis() - start;
+  lastStats.tokenReuses = rteTokenReuses;
+  return fetched;
+}
+
+int RteClient::requestFree(FreeEndpoint endpoint, const char *uri, const char *query, FreeCalendar &calendar)
+{
+  const FreeEntry *cached = freeCacheFind(freeCache, endpoint, query);
+  int code = send("GET", uri, nullptr, cached);
+  if (code <= 0 || (code == 304 && cached != nullptr))
+  {
+    // 304 : pas de corps, la réponse précédente reste valable
+    if (code == 304)
+    {
+      calendar = cached->calendar;
+      lastStats.notModified++;
+    }
+    http.end();
+    if (debug)
+    {
+      Serial.print("<<< fin\n");
+    }
+    return code;
+  }
+
+  StreamReader stream(http.getStream());
+  HttpBodyReader body(stream, http.getSize(), http.header("Transfer-Encoding") == "chunked");
+  TeeReader capture(body, debug ? &Serial : nullptr);
+  HashReader hashed(capture);
+  bool parsed = code == 200 && freeCalendarParse(hashed, calendar);
+  hashed.drain();
+  lastStats.bytes += body.bytesRead();
+  if (parsed)
+  {
+    if (cached != nullptr && cached->etag[0] == '\0' && cached->lastModified[0] == '\0' &&
+        cached->bodyHash == hashed.hash())
+    {
+      Serial.printf("\nRéponse identique à la précédente (%s), sans validateur du serveur.\n", uri);
+    }
+    freeCacheStore(freeCache, endpoint, query, http.header("ETag").c_str(), http.header("Last-Modified").c_str(),
+                   hashed.hash(), calendar);
+  }
+  http.end();
+  if (debug)
+  {
+    Serial.print("\n<<< fin\n");
+  }
+  return code == 200 && !parsed ? -2 : code;
+}
+
+static int ymdFromDate(const char *date)
+{
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  sscanf(date, "%4d-%2d-%2d", &year, &month, &day);
+  return year * 10000 + month * 100 + day;
+}
+
+bool RteClient::fetchFreeColors(const char *today, const char *tomorrow, const char *season, const char *notAvailable,
+                                TempoResult &result, unsigned long timeoutMs)
+{
+  unsigned long start = millis();
+  startMs = start;
+  allowedMs = timeoutMs;
+  lastStats = {};
+  memset(result.errorCodes, 0, sizeof(result.errorCodes));
+  copyColor(result.todayColor, notAvailable);
+  copyColor(result.tomorrowColor, notAvailable);
+
+  // errorCodes[0] : jours, [1] : saison. 304 vaut une réponse.
+  FreeCalendar days = {};
+  FreeCalendar seasonDays = {};
+  result.errorCodes[0] = requestFree(FREE_ENDPOINT_DAYS, RTE_FREE_DAYS_URI, "", days);
+  char uri[RTE_URI_LEN] = RTE_FREE_SEASON_URI;
+  if (appendEncoded(uri, sizeof(uri), strlen(uri), season) >= sizeof(uri))
+  {
+    result.errorCodes[1] = -3;
+  }
+  else if (result.errorCodes[0] == 200 || result.errorCodes[0] == 304)
+  {
+    result.errorCodes[1] = requestFree(FREE_ENDPOINT_SEASON, uri, season, seasonDays);
+  }
+  client.stop();
+
+  bool answered = true;
+  for (int i = 0; i < 2; i++)
+  {
+    answered = answered && (result.errorCodes[i] == 200 || result.errorCodes[i] == 304);
+  }
+  bool fetched = answered && freeCalendarResolve(days, seasonDays, ymdFromDate(today), ymdFromDate(tomorrow),
+                                                 notAvailable, result);
+  if (answered && !fetched)
+  {
+    // Réponses sans le jour demandé : le prochain essai redemande tout sans condition
+    freeCacheForget(freeCache);
+  }
+
+  lastStats.fetchMs = millis() - start;
+  lastStats.tokenReuses = rteTokenReuses;
+  return fetched;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Client des API RTE. Toutes les requêtes d'un réveil passent par une seule
+// connexion TLS gardée ouverte (keep-alive).
+// Avec compte : le jeton OAuth est gardé en mémoire RTC tant qu'il est valide, et
+// une seule requête de calendrier, du début de saison à après-demain, donne les
+// couleurs et les compteurs.
+// Sans inscription : les jours et la saison sont demandés sous condition avec les
+// validateurs de la réponse précédente, gardés en mémoire RTC (FreeCache.h).
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+
+#include "FreeCache.h"
+#include "Hal.h"
+#include "RteCalendar.h"
+
+#define RTE_TOKEN_LEN 128
+
+class RteClient
+{
+public:
+  RteClient(const String &clientSecret, const String &clientId, const char *host, uint16_t port, bool debug);
+  // Dates au format AAAA-MM-JJT00:00:00+0X:00, couleurs renvoyées en français.
+  // Aucune requête ne dépasse timeoutMs au total, poignées de main comprises.
+  bool fetchColors(const char *today, const char *tomorrow, const char *dayAfter,
+                   const char *seasonStart, const char *notAvailable, TempoResult &result,
+                   unsigned long timeoutMs);
+  // Dates au format AAAA-MM-JJ, saison au format "2025-2026"
+  bool fetchFreeColors(const char *today, const char *tomorrow, const char *season, const char *notAvailable,
+                       TempoResult &result, unsigned long timeoutMs);
+  ApiStats stats() const { return lastStats; }
+
+private:
+  // authorization : nullptr sans inscription. cached : validateurs à présenter, nullptr sans
+  int send(const char *method, const char *uri, const char *authorization, const FreeEntry *cached);
+  // token : RTE_TOKEN_LEN octets
+  int requestToken(char *token);
+  int requestCalendar(const char *token, const char *start, const char *end,
+                      const char *today, const char *tomorrow, RteCalendar &calendar);
+  // 304 : calendar reprend les valeurs de la réponse précédente
+  int requestFree(FreeEndpoint endpoint, const char *uri, const char *query, FreeCalendar &calendar);
+
+  const String &clientSecret;
+  const String &clientId;
+  const char *host;
+  uint16_t port;
+  bool debug;
+  WiFiClientSecure client;
+  HTTPClient http;
+  ApiStats lastStats = {};
+  unsigned long startMs = 0;
+  unsigned long allowedMs = 0; // pour l'ensemble des requêtes
+};
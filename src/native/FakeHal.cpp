@@ -0,0 +1,858 @@
+#include "FakeHal.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Checksum.h"
+
+const char *fakePhaseNames[PHASE_COUNT] = {
+    "boot", "adc", "panel.init", "wifi", "ntp", "api", "render", "panel.update"};
+
+void FakeWorld::spend(FakePhase spentPhase, unsigned long duration)
+{
+  phase = spentPhase;
+  phaseMs[spentPhase] += duration;
+  ms += duration;
+}
+
+void FakeWorld::radioOff()
+{
+  if (radioOn)
+  {
+    radioMs += ms - radioSince;
+    radioOn = false;
+  }
+}
+
+void FakeWorld::recordApiDates(const char *const *dates, int count)
+{
+  apiCallTime = trueNow();
+  apiDateCount = count;
+  for (int i = 0; i < count; i++)
+  {
+    snprintf(apiDates[i], sizeof(apiDates[i]), "%s", dates[i]);
+  }
+}
+
+size_t fakeHeapUsed = 0;
+size_t fakeHeapPeak = 0;
+unsigned long fakeAllocations = 0;
+
+void fakePaintStack(FakeWorld &world)
+{
+  volatile uint8_t area[FAKE_STACK_BYTES];
+  for (size_t i = 0; i < sizeof(area); i++)
+  {
+    area[i] = FAKE_STACK_PAINT;
+  }
+  world.stackBottom = (uintptr_t)area;
+}
+
+void FakeWorld::startCycle(time_t epoch)
+{
+  // Le reset remet à zéro le minimum de heap_caps_get_minimum_free_size
+  heapAtBoot = fakeHeapUsed;
+  fakeHeapPeak = fakeHeapUsed;
+  stackBottom = 0;
+  backgroundRunning = false;
+  bootEpoch = epoch;
+  ms = 0;
+  memset(phaseMs, 0, sizeof(phaseMs));
+  parkedMs = 0;
+  radioOn = false;
+  radioMs = 0;
+  apiDateCount = 0;
+  adcReads = 0;
+  asleep = false;
+  sleepSeconds = 0;
+  wifiConnects = 0;
+  apiCalls = 0;
+  apiConnections = 0;
+  hubCalls = 0;
+  panelUpdates = 0;
+  partialUpdates = 0;
+  ntpSyncs = 0;
+  apiDays = 0;
+  apiBytes = 0;
+  apiNotModified = 0;
+  storageWrites = 0;
+  logAppends = 0;
+  logBytes = 0;
+  logErases = 0;
+  requestsCut = 0;
+  spend(PHASE_BOOT, costs.bootMs);
+}
+
+time_t FakeWorld::wakeAfterSleep(uint64_t seconds)
+{
+  double realSeconds = seconds / (1 + rtcDriftPpm * 1e-6);
+  rtcOffset += seconds - realSeconds;
+  return trueNow() + (time_t)llround(realSeconds);
+}
+
+time_t FakeWorld::wakeEarly(time_t wakeTime)
+{
+  double realSeconds = (double)(wakeTime - trueNow());
+  rtcOffset += realSeconds * rtcDriftPpm * 1e-6;
+  return wakeTime;
+}
+
+bool FakeWorld::wifiAvailable() const
+{
+  time_t now = trueNow();
+  return wifiUp && !(now >= wifiDownFrom && now < wifiDownUntil);
+}
+
+bool FakeWorld::apiAvailable(TempoSource source) const
+{
+  time_t now = trueNow();
+  return apiUp && !(now >= apiDownFrom && now < apiDownUntil && (apiDownSources & (1u << source)));
+}
+
+static time_t localNoon(time_t time, int dayOffset)
+{
+  struct tm day;
+  localtime_r(&time, &day);
+  day.tm_mday += dayOffset;
+  day.tm_hour = 12;
+  day.tm_min = 0;
+  day.tm_sec = 0;
+  day.tm_isdst = -1;
+  return mktime(&day);
+}
+
+const char *FakeWorld::colorForDay(time_t day)
+{
+  // Tirage déterministe par jour local : ~70% bleu, ~20% blanc, ~10% rouge
+  time_t noon = localNoon(day, 0);
+  unsigned long index = (unsigned long)(noon / 86400);
+  unsigned long hash = (index * 2654435761UL) % 100;
+  if (hash < 70)
+  {
+    return "BLEU";
+  }
+  return hash < 90 ? "BLANC" : "ROUGE";
+}
+
+unsigned long FakeBoard::millis()
+{
+  return world.ms;
+}
+
+uint64_t FakeBoard::micros()
+{
+  return (uint64_t)world.ms * 1000;
+}
+
+void FakeBoard::delay(unsigned long ms)
+{
+  world.spend(world.phase, ms);
+}
+
+int FakeBoard::readBatteryRaw()
+{
+  // Quelques dizaines de µs par lecture : adcMs les couvre toutes
+  if (world.adcReads++ == 0)
+  {
+    world.spend(PHASE_ADC, world.costs.adcMs);
+  }
+  if (world.batteryNoiseRaw <= 0)
+  {
+    return world.batteryRaw;
+  }
+  world.adcNoiseState = world.adcNoiseState * 1664525u + 1013904223u;
+  uint32_t draw = world.adcNoiseState >> 8;
+  int noise = (int)(draw % (2 * world.batteryNoiseRaw + 1)) - world.batteryNoiseRaw;
+  if ((draw >> 16) % 16 == 0)
+  {
+    noise += draw & 1 ? 300 : -300; // pic, pendant une émission par exemple
+  }
+  return world.batteryRaw + noise;
+}
+
+uint32_t FakeBoard::freeHeap()
+{
+  return FAKE_HEAP_BYTES - (uint32_t)(fakeHeapUsed - world.heapAtBoot);
+}
+
+uint32_t FakeBoard::minFreeHeap()
+{
+  return FAKE_HEAP_BYTES - (uint32_t)(fakeHeapPeak - world.heapAtBoot);
+}
+
+uint32_t FakeBoard::stackFree()
+{
+  // Comme uxTaskGetStackHighWaterMark : octets encore peints en bas de la zone
+  if (world.stackBottom == 0)
+  {
+    return 0;
+  }
+  const volatile uint8_t *area = (const volatile uint8_t *)world.stackBottom;
+  uint32_t untouched = 0;
+  while (untouched < FAKE_STACK_BYTES && area[untouched] == FAKE_STACK_PAINT)
+  {
+    untouched++;
+  }
+  return untouched;
+}
+
+WakeCause FakeBoard::wakeCause()
+{
+  return world.wakeCause;
+}
+
+bool FakeBoard::startBackground(void (*job)(void *context), void *context)
+{
+  if (world.backgroundRunning)
+  {
+    return false;
+  }
+  unsigned long startMs = world.ms;
+  FakePhase phase = world.phase;
+  unsigned long phaseMs[PHASE_COUNT];
+  memcpy(phaseMs, world.phaseMs, sizeof(phaseMs));
+  job(context);
+  world.backgroundEndMs = world.ms;
+  world.ms = startMs;
+  world.phase = phase;
+  memcpy(world.phaseMs, phaseMs, sizeof(phaseMs));
+  world.backgroundRunning = true;
+  return true;
+}
+
+bool FakeBoard::waitBackground(unsigned long timeoutMs)
+{
+  if (!world.backgroundRunning)
+  {
+    return true;
+  }
+  unsigned long remaining = world.backgroundEndMs > world.ms ? world.backgroundEndMs - world.ms : 0;
+  bool done = remaining <= timeoutMs;
+  world.spend(PHASE_API, done ? remaining : timeoutMs);
+  world.backgroundRunning = !done;
+  return done;
+}
+
+uint32_t FakeBoard::random32()
+{
+  // Générateur congruentiel : tirages reproductibles d'une exécution à l'autre
+  world.randomState = world.randomState * 1664525u + 1013904223u;
+  return world.randomState >> 8;
+}
+
+void FakeBoard::log(const char *message)
+{
+  if (verbose)
+  {
+    printf("  | %s\n", message);
+  }
+}
+
+int FakeBoard::readCommand()
+{
+  return *world.serialInput ? *world.serialInput++ : -1;
+}
+
+void FakeBoard::deepSleep(uint64_t seconds)
+{
+  world.requestsCut += world.backgroundBusy();
+  world.radioOff();
+  world.asleep = true;
+  world.sleepSeconds = seconds;
+}
+
+void FakeClock::configureNtp(const char *timeZone, const char *ntpServer)
+{
+  (void)ntpServer;
+  setTimeZone(timeZone);
+  world.spend(PHASE_NTP, world.costs.ntpSyncMs);
+  synced = world.ntpUp;
+  if (synced)
+  {
+    world.rtcValid = true;
+    world.rtcOffset = 0;
+    world.ntpSyncs++;
+  }
+}
+
+bool FakeClock::ntpSynced()
+{
+  return synced;
+}
+
+void FakeClock::setTimeZone(const char *timeZone)
+{
+  setenv("TZ", timeZone, 1);
+  tzset();
+}
+
+time_t FakeClock::now()
+{
+  // Sans synchro, l'ESP32 démarre le 1er janvier 1970
+  return world.rtcValid ? world.trueNow() + (time_t)floor(world.rtcOffset) : (time_t)(world.ms / 1000);
+}
+
+void FakeClock::adjust(long seconds)
+{
+  world.rtcOffset += seconds;
+}
+
+void FakeNetwork::startConnect(const char *ssid, const char *key)
+{
+  (void)ssid;
+  (void)key;
+  world.wifiConnects++;
+  connectStart = world.ms;
+  world.radioOn = true;
+  world.radioSince = world.ms;
+}
+
+void FakeNetwork::waitUntil(unsigned long end)
+{
+  if (end > world.ms)
+  {
+    world.spend(PHASE_WIFI, end - world.ms);
+  }
+}
+
+bool FakeNetwork::finishConnect(unsigned long timeoutMs)
+{
+  unsigned long deadline = world.ms + timeoutMs;
+  unsigned long end = connectStart;
+  if (cached)
+  {
+    end += world.costs.wifiFastConnectMs;
+    if (end > deadline)
+    {
+      waitUntil(deadline);
+      connected = false;
+      lastStats.connectMs = deadline - connectStart;
+      return false;
+    }
+    waitUntil(end);
+    if (world.wifiAvailable())
+    {
+      connected = true;
+      lastStats.fastHits++;
+      lastStats.path = CONNECT_STATIC_IP;
+      lastStats.connectMs = end - connectStart;
+      return true;
+    }
+    lastStats.fastMisses++;
+    cached = false;
+  }
+
+  end += world.costs.wifiConnectMs;
+  if (end > deadline)
+  {
+    waitUntil(deadline);
+    connected = false;
+    lastStats.path = CONNECT_FULL_SCAN;
+    lastStats.connectMs = deadline - connectStart;
+    return false;
+  }
+  waitUntil(end);
+  connected = world.wifiAvailable();
+  cached = connected;
+  lastStats.path = CONNECT_FULL_SCAN;
+  lastStats.connectMs = end - connectStart;
+  return connected;
+}
+
+NetworkStats FakeNetwork::stats()
+{
+  return lastStats;
+}
+
+bool FakeNetwork::isConnected()
+{
+  return connected;
+}
+
+void FakeNetwork::disconnect()
+{
+  world.requestsCut += world.backgroundBusy();
+  world.radioOff();
+  connected = false;
+}
+
+static void fillColor(char *dest, const char *color)
+{
+  strncpy(dest, color, TEMPO_COLOR_LEN - 1);
+  dest[TEMPO_COLOR_LEN - 1] = '\0';
+}
+
+// Compteurs sur [from, aujourd'hui], plus demain pour l'API avec compte
+bool FakeTempoApi::spendRequests(TempoSource source, int requests, int connections, unsigned long bytes,
+                                 unsigned long timeoutMs)
+{
+  unsigned long requestMs = world.apiHangs && !world.apiAvailable(source) ? world.costs.apiHangMs
+                                                                          : world.costs.apiRequestMs;
+  unsigned long duration = requests * requestMs + connections * world.costs.tlsHandshakeMs +
+                           bytes * world.costs.apiKilobyteMs / 1024 + world.apiSlowMs[source];
+  bool completed = duration <= timeoutMs;
+  if (!completed)
+  {
+    duration = timeoutMs;
+  }
+  world.spend(PHASE_API, duration);
+  world.apiConnections += connections;
+  lastStats = {duration, (uint16_t)requests, (uint16_t)connections, world.tokenReuses};
+  return completed;
+}
+
+bool FakeTempoApi::abandon(TempoResult &result)
+{
+  world.apiCalls++;
+  for (int i = 0; i < TEMPO_ERROR_CODES; i++)
+  {
+    result.errorCodes[i] = -11; // HTTPC_ERROR_READ_TIMEOUT
+  }
+  fillColor(result.todayColor, FAKE_NOT_AVAILABLE);
+  fillColor(result.tomorrowColor, FAKE_NOT_AVAILABLE);
+  return false;
+}
+
+bool FakeTempoApi::fetch(TempoResult &result, time_t from, bool withTomorrow)
+{
+  world.apiCalls++;
+  bool available = world.apiAvailable(SOURCE_ACCOUNT);
+  for (int i = 0; i < TEMPO_ERROR_CODES; i++)
+  {
+    result.errorCodes[i] = available ? 200 : 503;
+  }
+  if (!available)
+  {
+    fillColor(result.todayColor, FAKE_NOT_AVAILABLE);
+    fillColor(result.tomorrowColor, FAKE_NOT_AVAILABLE);
+    return false;
+  }
+
+  time_t now = world.trueNow();
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  bool published = timeinfo.tm_hour * 60 + timeinfo.tm_min >= world.tomorrowPublishedMinute;
+
+  fillColor(result.todayColor, FakeWorld::colorForDay(now));
+  fillColor(result.tomorrowColor, published ? FakeWorld::colorForDay(localNoon(now, 1)) : FAKE_NOT_AVAILABLE);
+
+  time_t until = localNoon(now, withTomorrow && published ? 1 : 0);
+  result.countBlue = 0;
+  result.countWhite = 0;
+  result.countRed = 0;
+  for (time_t day = from; day <= until; day = localNoon(day, 1))
+  {
+    world.apiDays++;
+    const char *color = FakeWorld::colorForDay(day);
+    if (strcmp(color, "BLEU") == 0)
+    {
+      result.countBlue++;
+    }
+    else if (strcmp(color, "BLANC") == 0)
+    {
+      result.countWhite++;
+    }
+    else
+    {
+      result.countRed++;
+    }
+  }
+  return true;
+}
+
+static time_t parseDate(const char *date)
+{
+  struct tm day = {};
+  sscanf(date, "%d-%d-%d", &day.tm_year, &day.tm_mon, &day.tm_mday);
+  day.tm_year -= 1900;
+  day.tm_mon -= 1;
+  day.tm_hour = 12;
+  day.tm_isdst = -1;
+  return mktime(&day);
+}
+
+static int ymdFromDate(const char *date)
+{
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  sscanf(date, "%d-%d-%d", &year, &month, &day);
+  return year * 10000 + month * 100 + day;
+}
+
+// Corps d'une réponse sans inscription : les jours [from, until], couleurs en anglais
+static int freeBody(char *body, size_t size, time_t from, time_t until)
+{
+  static const char *englishColors[] = {"", "BLUE", "WHITE", "RED"};
+  int length = snprintf(body, size, "{\"values\":{");
+  for (time_t day = from; day <= until && (size_t)length < size; day = localNoon(day, 1))
+  {
+    struct tm timeinfo;
+    localtime_r(&day, &timeinfo);
+    length += snprintf(body + length, size - length, "%s\"%04d-%02d-%02d\":\"%s\"", day == from ? "" : ",",
+                       timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+                       englishColors[dayColorFromName(FakeWorld::colorForDay(day))]);
+  }
+  if ((size_t)length < size)
+  {
+    length += snprintf(body + length, size - length, "}}");
+  }
+  return (size_t)length < size ? length : 0;
+}
+
+// Corps en mémoire lu comme sur la connexion
+class BodyReader : public ByteReader
+{
+public:
+  BodyReader(const char *data, size_t length) : data(data), length(length) {}
+
+  int read() override
+  {
+    return position < length ? (unsigned char)data[position++] : -1;
+  }
+
+  size_t readBytes(char *buffer, size_t count) override
+  {
+    count = length - position < count ? length - position : count;
+    memcpy(buffer, data + position, count);
+    position += count;
+    return count;
+  }
+
+private:
+  const char *data;
+  size_t length;
+  size_t position = 0;
+};
+
+bool FakeTempoApi::fetchFree(const char *today, const char *tomorrow,
+                             const char *season, TempoResult &result, unsigned long timeoutMs)
+{
+  const char *dates[] = {today, tomorrow};
+  world.recordApiDates(dates, 2);
+
+  // Réponses du serveur : aujourd'hui et demain, puis la saison depuis le 1er septembre.
+  // Hors du tas, qui est mesuré pendant le réveil.
+  static char bodies[FREE_ENDPOINT_COUNT][SEASON_MAX_DAYS * 24 + 32];
+  time_t now = world.trueNow();
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  bool published = timeinfo.tm_hour * 60 + timeinfo.tm_min >= world.tomorrowPublishedMinute;
+  time_t last = localNoon(now, published ? 1 : 0);
+  char start[16];
+  snprintf(start, sizeof(start), "%.4s-09-01", season);
+  int lengths[FREE_ENDPOINT_COUNT] = {freeBody(bodies[0], sizeof(bodies[0]), localNoon(now, 0), last),
+                                      freeBody(bodies[1], sizeof(bodies[1]), parseDate(start), last)};
+  const char *queries[FREE_ENDPOINT_COUNT] = {"", season};
+
+  // Comme RteClient : les deux requêtes sur une connexion, avec l'ETag de la réponse précédente
+  bool available = world.apiAvailable(SOURCE_FREE);
+  const FreeEntry *cached[FREE_ENDPOINT_COUNT];
+  char etags[FREE_ENDPOINT_COUNT][FREE_ETAG_LEN];
+  bool notModified[FREE_ENDPOINT_COUNT];
+  unsigned long bytes = 0;
+  for (int i = 0; i < FREE_ENDPOINT_COUNT; i++)
+  {
+    cached[i] = freeCacheFind(world.freeCache, (FreeEndpoint)i, queries[i]);
+    snprintf(etags[i], sizeof(etags[i]), world.apiValidators ? "\"%08x\"" : "",
+             (unsigned)fnv1a(bodies[i], lengths[i]));
+    notModified[i] = cached[i] != nullptr && etags[i][0] != '\0' && strcmp(cached[i]->etag, etags[i]) == 0;
+    bytes += available && !notModified[i] ? lengths[i] : 0;
+  }
+  if (!spendRequests(SOURCE_FREE, FREE_ENDPOINT_COUNT, 1, bytes, timeoutMs))
+  {
+    return abandon(result);
+  }
+  world.apiCalls++;
+  memset(result.errorCodes, 0, sizeof(result.errorCodes));
+  if (!available)
+  {
+    result.errorCodes[0] = 503;
+    fillColor(result.todayColor, FAKE_NOT_AVAILABLE);
+    fillColor(result.tomorrowColor, FAKE_NOT_AVAILABLE);
+    return false;
+  }
+
+  FreeCalendar calendars[FREE_ENDPOINT_COUNT];
+  for (int i = 0; i < FREE_ENDPOINT_COUNT; i++)
+  {
+    if (notModified[i])
+    {
+      calendars[i] = cached[i]->calendar;
+      result.errorCodes[i] = 304;
+      lastStats.notModified++;
+      continue;
+    }
+    BodyReader body(bodies[i], lengths[i]);
+    if (!freeCalendarParse(body, calendars[i]))
+    {
+      result.errorCodes[i] = -2;
+      return false;
+    }
+    freeCacheStore(world.freeCache, (FreeEndpoint)i, queries[i], etags[i], "", fnv1a(bodies[i], lengths[i]),
+                   calendars[i]);
+    result.errorCodes[i] = 200;
+    world.apiDays += calendars[i].days;
+  }
+  lastStats.bytes = bytes;
+  world.apiBytes += bytes;
+  world.apiNotModified += lastStats.notModified;
+  if (!freeCalendarResolve(calendars[0], calendars[1], ymdFromDate(today), ymdFromDate(tomorrow),
+                           FAKE_NOT_AVAILABLE, result))
+  {
+    freeCacheForget(world.freeCache);
+    return false;
+  }
+  return true;
+}
+
+bool FakeTempoApi::fetchAccount(const char *today, const char *tomorrow, const char *dayAfter,
+                                const char *seasonStart, TempoResult &result, unsigned long timeoutMs)
+{
+  const char *dates[] = {today, tomorrow, dayAfter, seasonStart};
+  world.recordApiDates(dates, 4);
+  // Comme RteClient : une connexion, le jeton n'est redemandé qu'à son expiration
+  time_t now = world.trueNow();
+  if (now + 120 < world.tokenExpiresAt)
+  {
+    world.tokenReuses++;
+    if (!spendRequests(SOURCE_ACCOUNT, 1, 1, 0, timeoutMs))
+    {
+      return abandon(result);
+    }
+  }
+  else if (!spendRequests(SOURCE_ACCOUNT, 2, 1, 0, timeoutMs))
+  {
+    return abandon(result);
+  }
+  else
+  {
+    world.tokenExpiresAt = now + 7200;
+  }
+  return fetch(result, parseDate(seasonStart), true);
+}
+
+bool FakeTempoApi::fetchHub(const char *host, uint16_t port, char *line, size_t size, unsigned long timeoutMs)
+{
+  (void)host;
+  (void)port;
+  world.hubCalls++;
+  time_t now = world.trueNow();
+  FakeLan *lan = world.lan;
+  bool listening = lan != nullptr && now >= lan->servingFrom && now < lan->servingUntil;
+  // Hub absent : la connexion attend jusqu'au délai
+  unsigned long duration = listening ? world.costs.hubRequestMs : timeoutMs;
+  world.spend(PHASE_API, duration);
+  lastStats = {duration, 1, 0, world.tokenReuses};
+  if (!listening)
+  {
+    return false;
+  }
+  lan->requests++;
+  if (lan->line[0] == '\0' || strlen(lan->line) >= size)
+  {
+    return false;
+  }
+  lan->answered++;
+  strcpy(line, lan->line);
+  lastStats.bytes = strlen(line);
+  return true;
+}
+
+ApiStats FakeTempoApi::stats()
+{
+  return lastStats;
+}
+
+void FakeHubServer::serve(const char *line, uint64_t seconds)
+{
+  if (world.lan != nullptr)
+  {
+    snprintf(world.lan->line, sizeof(world.lan->line), "%s", line);
+    world.lan->servingFrom = world.trueNow();
+    world.lan->servingUntil = world.lan->servingFrom + (time_t)seconds;
+  }
+  world.ms += seconds * 1000;
+}
+
+bool FakeStorage::load(const char *key, void *data, size_t size)
+{
+  for (const Slot &slot : slots)
+  {
+    if (strcmp(slot.key, key) == 0)
+    {
+      if (slot.size != size)
+      {
+        return false;
+      }
+      memcpy(data, slot.data, size);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FakeStorage::save(const char *key, const void *data, size_t size)
+{
+  if (size > sizeof(slots[0].data) || strlen(key) >= sizeof(slots[0].key))
+  {
+    return false;
+  }
+  for (Slot &slot : slots)
+  {
+    if (slot.key[0] == '\0' || strcmp(slot.key, key) == 0)
+    {
+      strcpy(slot.key, key);
+      slot.size = size;
+      memcpy(slot.data, data, size);
+      world.storageWrites++;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t FakeLogFiles::size(int file)
+{
+  return file >= 0 && file < EVENT_LOG_FILES ? sizes[file] : 0;
+}
+
+bool FakeLogFiles::append(int file, const void *bytes, size_t size)
+{
+  if (file < 0 || file >= EVENT_LOG_FILES || sizes[file] + size > FAKE_LOG_FILE_BYTES)
+  {
+    return false;
+  }
+  memcpy(data[file] + sizes[file], bytes, size);
+  sizes[file] += size;
+  world.logAppends++;
+  world.logBytes += size;
+  return true;
+}
+
+bool FakeLogFiles::read(int file, size_t offset, void *bytes, size_t size)
+{
+  if (file < 0 || file >= EVENT_LOG_FILES || offset + size > sizes[file])
+  {
+    return false;
+  }
+  memcpy(bytes, data[file] + offset, size);
+  return true;
+}
+
+bool FakeLogFiles::remove(int file)
+{
+  if (file < 0 || file >= EVENT_LOG_FILES)
+  {
+    return false;
+  }
+  if (sizes[file] > 0)
+  {
+    world.logErases++;
+  }
+  sizes[file] = 0;
+  return true;
+}
+
+void FakeLogFiles::tear(int file, size_t bytes)
+{
+  if (file < 0 || file >= EVENT_LOG_FILES || sizes[file] == 0)
+  {
+    return;
+  }
+  // La moitié des octets perdus reste, brouillée : un enregistrement tronqué
+  size_t lost = bytes < sizes[file] ? bytes : sizes[file];
+  sizes[file] -= lost / 2;
+  for (size_t i = sizes[file] - (lost - lost / 2); i < sizes[file]; i++)
+  {
+    data[file][i] ^= 0x5A;
+  }
+}
+
+void FakePanel::init()
+{
+  world.spend(PHASE_PANEL_INIT, world.costs.panelInitMs);
+}
+
+void FakePanel::printLine(const char *text)
+{
+  (void)text;
+  textMode = true;
+  world.spend(PHASE_RENDER, 1);
+}
+
+PanelStats FakePanel::stats()
+{
+  return lastStats;
+}
+
+void FakePanel::drawBackground()
+{
+  world.spend(PHASE_RENDER, world.costs.backgroundMs);
+  backgroundReady = true;
+}
+
+void FakePanel::drawTempo(const TempoView &view)
+{
+  textMode = false;
+  snprintf(drawn, sizeof(drawn), "%s|%s|%d|%d|%d|%d", view.todayColor, view.tomorrowColor,
+           view.countWhite, view.countRed, (view.batteryPercentage + 12) / 25, view.batteryDaysLeft);
+  snprintf(drawnLabel, sizeof(drawnLabel), "%s", view.todayLabel);
+  world.spend(PHASE_RENDER, backgroundReady ? world.costs.renderMs - world.costs.backgroundMs : world.costs.renderMs);
+  backgroundReady = false;
+}
+
+void FakePanel::refresh(unsigned long duration)
+{
+  world.spend(PHASE_PANEL_UPDATE, duration);
+  lastStats.updateMs += duration;
+  if (sleepWhileBusy && duration > world.costs.panelTransferMs)
+  {
+    lastStats.parkedMs += duration - world.costs.panelTransferMs;
+    world.parkedMs += duration - world.costs.panelTransferMs;
+  }
+}
+
+void FakePanel::update()
+{
+  lastStats = {};
+  if (textMode)
+  {
+    refresh(world.costs.panelUpdateMs);
+    world.panelUpdates++;
+    memory.frameValid = false;
+    textShown = true;
+    return;
+  }
+
+  FrameRect rects[FRAME_MAX_RECTS];
+  int count = 0;
+  const FrameRect zone = {0, 0, 60, 20};
+  rects[count++] = zone; // horodatage
+  if (strcmp(shown, drawn) != 0)
+  {
+    rects[count++] = zone;
+  }
+
+  RefreshKind kind = chooseRefresh(memory, rects, count, 250, 122, fullRefreshEvery);
+  if (kind == REFRESH_FULL)
+  {
+    refresh(world.costs.panelUpdateMs);
+    world.panelUpdates++;
+  }
+  else if (kind == REFRESH_PARTIAL)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      refresh(world.costs.partialUpdateMs);
+    }
+    world.panelUpdates++;
+    world.partialUpdates++;
+  }
+  strcpy(shown, drawn);
+  strcpy(shownLabel, drawnLabel);
+  textShown = false;
+  recordRefresh(memory, kind);
+}
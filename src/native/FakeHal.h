@@ -0,0 +1,327 @@
+#pragma once
+
+// Implémentations factices de Hal.h pour le build natif.
+// Le temps est virtuel : chaque opération avance l'horloge du coût configuré.
+
+#include "EventLog.h"
+#include "FrameDiff.h"
+#include "FreeCache.h"
+#include "Hal.h"
+#include "TempoHub.h"
+#include "TempoSources.h"
+
+enum FakePhase
+{
+  PHASE_BOOT,
+  PHASE_ADC,
+  PHASE_PANEL_INIT,
+  PHASE_WIFI,
+  PHASE_NTP,
+  PHASE_API,
+  PHASE_RENDER,
+  PHASE_PANEL_UPDATE,
+  PHASE_COUNT
+};
+
+extern const char *fakePhaseNames[PHASE_COUNT];
+
+// Coûts simulés en millisecondes, ordres de grandeur mesurés sur un T5
+struct FakeCosts
+{
+  unsigned long bootMs = 250;
+  unsigned long adcMs = 1; // toutes les lectures de la batterie d'un réveil
+  unsigned long panelInitMs = 300;
+  unsigned long wifiConnectMs = 3500;
+  unsigned long wifiFastConnectMs = 600; // BSSID, canal et IP connus
+  unsigned long ntpSyncMs = 1200;
+  unsigned long tlsHandshakeMs = 550; // par connexion
+  unsigned long apiRequestMs = 250;   // par requête
+  unsigned long apiHangMs = 8000;     // requête sans réponse, jusqu'au délai HTTP
+  unsigned long apiKilobyteMs = 8;    // réception et lecture d'un Ko de corps de réponse
+  unsigned long hubRequestMs = 30;    // écran hub du réseau local, sans TLS
+  unsigned long renderMs = 40;
+  unsigned long backgroundMs = 25; // part de renderMs pour les parties fixes
+  unsigned long panelUpdateMs = 2000;
+  unsigned long partialUpdateMs = 450;
+  unsigned long panelTransferMs = 60; // envoi de l'image, le reste attend BUSY
+};
+
+#define FAKE_NOT_AVAILABLE "N/A"
+
+// Réseau local partagé par les écrans d'un parc simulé : ce que sert le hub
+struct FakeLan
+{
+  char line[TEMPO_HUB_LINE_LEN] = "";
+  time_t servingFrom = 0; // le hub répond sur [from, until[
+  time_t servingUntil = 0;
+  int requests = 0;       // requêtes reçues par le hub
+  int answered = 0;       // dont réponses avec des couleurs
+};
+
+// Tas simulé : octets alloués par new, suivis par les opérateurs de src/native/main.cpp
+// (les tests gardent ceux de la libc, les compteurs y restent à zéro)
+#define FAKE_HEAP_BYTES 200000
+extern size_t fakeHeapUsed;
+extern size_t fakeHeapPeak;
+extern unsigned long fakeAllocations; // appels à new
+// Pile de la tâche loopTask de l'ESP32, peinte avant chaque réveil
+#define FAKE_STACK_BYTES 8192
+#define FAKE_STACK_PAINT 0xA5
+
+struct FakeWorld
+{
+  FakeCosts costs;
+  time_t bootEpoch = 0;    // heure réelle au réveil
+  unsigned long ms = 0;    // temps écoulé depuis le réveil
+  bool rtcValid = false;   // faux après une coupure d'alimentation
+  bool wifiUp = true;
+  bool ntpUp = true;
+  bool apiUp = true;
+  int batteryRaw = 2400;
+  int batteryNoiseRaw = 0;              // bruit de l'ADC, avec un pic une lecture sur 16
+  uint32_t adcNoiseState = 7;
+  int adcReads = 0;                     // lectures de la batterie pendant le réveil
+  int tomorrowPublishedMinute = 7 * 60; // heure de publication simulée, voir aussi 10:40 à 11:10
+  double rtcDriftPpm = 0;               // > 0 : l'horloge RTC avance
+  double rtcOffset = 0;                 // avance actuelle de l'horloge RTC en secondes
+  time_t wifiDownFrom = 0;              // panne WiFi simulée sur [from, until[
+  time_t wifiDownUntil = 0;
+  time_t apiDownFrom = 0;               // panne API simulée sur [from, until[
+  time_t apiDownUntil = 0;
+  bool apiHangs = false;                // pendant la panne, l'API ne répond plus au lieu d'une erreur
+  unsigned apiDownSources = ~0u;        // sources touchées par la panne, bits 1 << TempoSource
+  unsigned long apiSlowMs[SOURCE_NETWORK_COUNT] = {}; // attente ajoutée à chaque réponse d'une source
+  bool apiValidators = true;            // ETag dans les réponses sans inscription, 304 si inchangées
+  FakeLan *lan = nullptr;               // réseau local partagé, nullptr : le hub ne répond jamais
+  // Mémoire RTC de RteClient, commune aux deux clients de l'API comme sur l'ESP32
+  time_t tokenExpiresAt = 0; // jeton OAuth de l'API avec compte
+  uint16_t tokenReuses = 0;
+  FreeCache freeCache = {};
+  uint32_t randomState = 1;
+  WakeCause wakeCause = WAKE_CAUSE_POWER_ON; // du réveil à venir
+  const char *serialInput = ""; // caractères reçus sur le port série simulé
+  FakePhase phase = PHASE_BOOT;
+  unsigned long phaseMs[PHASE_COUNT] = {};
+  unsigned long parkedMs = 0; // dont sommeil léger, compté aussi dans phaseMs
+  bool radioOn = false;
+  unsigned long radioSince = 0;
+  unsigned long radioMs = 0; // radio WiFi allumée pendant le réveil
+  size_t heapAtBoot = 0;     // tas déjà occupé par la simulation au réveil
+  uintptr_t stackBottom = 0; // zone peinte par fakePaintStack, 0 si aucune
+  bool backgroundRunning = false; // tâche de fond lancée et pas encore attendue jusqu'au bout
+  unsigned long backgroundEndMs = 0;
+
+  // résultat du cycle
+  bool asleep = false;
+  uint64_t sleepSeconds = 0;
+  int wifiConnects = 0;
+  int apiCalls = 0;
+  int apiConnections = 0; // connexions TLS vers l'API
+  int hubCalls = 0;
+  int panelUpdates = 0;
+  int partialUpdates = 0;
+  int ntpSyncs = 0;
+  int apiDays = 0;       // jours couverts par les requêtes du cycle
+  unsigned long apiBytes = 0; // octets de corps de réponse reçus
+  int apiNotModified = 0;     // réponses 304
+  int storageWrites = 0;
+  int logAppends = 0;          // ajouts au journal d'événements
+  unsigned long logBytes = 0;  // octets écrits dans le journal
+  int logErases = 0;           // fichiers du journal effacés pour faire de la place
+  int requestsCut = 0;         // WiFi coupé ou deep sleep sous une requête de la tâche de fond
+  char apiDates[4][32] = {}; // dates transmises à l'API, dans l'ordre des paramètres
+  int apiDateCount = 0;
+  time_t apiCallTime = 0; // heure réelle de l'appel
+
+  time_t trueNow() const { return bootEpoch + (time_t)(ms / 1000); }
+  bool wifiAvailable() const;
+  bool apiAvailable(TempoSource source) const;
+  void spend(FakePhase phase, unsigned long duration);
+  void radioOff();
+  // Tâche de fond lancée et pas encore finie à cet instant
+  bool backgroundBusy() const { return backgroundRunning && backgroundEndMs > ms; }
+  void recordApiDates(const char *const *dates, int count);
+  void startCycle(time_t epoch);
+  // Heure réelle du réveil après un deep sleep mesuré par l'horloge RTC
+  time_t wakeAfterSleep(uint64_t seconds);
+  // Réveil avant la fin du deep sleep (bouton), à l'heure réelle wakeTime
+  time_t wakeEarly(time_t wakeTime);
+  static const char *colorForDay(time_t day);
+};
+
+// À appeler juste avant runWakeCycle, depuis la même fonction : la zone peinte est
+// celle que les appels du réveil occuperont ensuite.
+void fakePaintStack(FakeWorld &world);
+
+class FakeBoard : public Board
+{
+public:
+  explicit FakeBoard(FakeWorld &world) : world(world) {}
+  unsigned long millis() override;
+  uint64_t micros() override;
+  void delay(unsigned long ms) override;
+  int readBatteryRaw() override;
+  uint32_t freeHeap() override;
+  uint32_t minFreeHeap() override;
+  uint32_t stackFree() override;
+  WakeCause wakeCause() override;
+  // La tâche s'exécute aussitôt, puis le temps virtuel est ramené à son lancement :
+  // waitBackground n'attend que ce qui reste de sa durée
+  bool startBackground(void (*job)(void *context), void *context) override;
+  bool waitBackground(unsigned long timeoutMs) override;
+  uint32_t random32() override;
+  void log(const char *message) override;
+  int readCommand() override;
+  void deepSleep(uint64_t seconds) override;
+
+  bool verbose = false;
+
+private:
+  FakeWorld &world;
+};
+
+class FakeClock : public Clock
+{
+public:
+  explicit FakeClock(FakeWorld &world) : world(world) {}
+  void configureNtp(const char *timeZone, const char *ntpServer) override;
+  bool ntpSynced() override;
+  void setTimeZone(const char *timeZone) override;
+  time_t now() override;
+  void adjust(long seconds) override;
+
+private:
+  FakeWorld &world;
+  bool synced = false;
+};
+
+class FakeNetwork : public Network
+{
+public:
+  explicit FakeNetwork(FakeWorld &world) : world(world) {}
+  void startConnect(const char *ssid, const char *key) override;
+  bool finishConnect(unsigned long timeoutMs) override;
+  bool isConnected() override;
+  void disconnect() override;
+  NetworkStats stats() override;
+
+private:
+  FakeWorld &world;
+  bool connected = false;
+  bool cached = false; // équivalent du cache RTC de EspNetwork
+  unsigned long connectStart = 0;
+  NetworkStats lastStats = {};
+
+  // La connexion avance en parallèle : seul le temps qui reste est attendu
+  void waitUntil(unsigned long end);
+};
+
+// Le temps passé à servir compte comme éveillé, radio allumée, hors des phases
+class FakeHubServer : public HubServer
+{
+public:
+  explicit FakeHubServer(FakeWorld &world) : world(world) {}
+  void serve(const char *line, uint64_t seconds) override;
+
+private:
+  FakeWorld &world;
+};
+
+class FakeTempoApi : public TempoApi
+{
+public:
+  explicit FakeTempoApi(FakeWorld &world) : world(world) {}
+  bool fetchFree(const char *today, const char *tomorrow,
+                 const char *season, TempoResult &result, unsigned long timeoutMs) override;
+  bool fetchAccount(const char *today, const char *tomorrow, const char *dayAfter,
+                    const char *seasonStart, TempoResult &result, unsigned long timeoutMs) override;
+  bool fetchHub(const char *host, uint16_t port, char *line, size_t size, unsigned long timeoutMs) override;
+  ApiStats stats() override;
+
+private:
+  bool fetch(TempoResult &result, time_t from, bool withTomorrow);
+  // false si les requêtes dépassent timeoutMs : elles sont abandonnées
+  bool spendRequests(TempoSource source, int requests, int connections, unsigned long bytes,
+                     unsigned long timeoutMs);
+  bool abandon(TempoResult &result);
+  FakeWorld &world;
+  ApiStats lastStats = {};
+};
+
+// Quelques blocs en mémoire, conservés comme la flash à travers les coupures
+class FakeStorage : public Storage
+{
+public:
+  explicit FakeStorage(FakeWorld &world) : world(world) {}
+  bool load(const char *key, void *data, size_t size) override;
+  bool save(const char *key, const void *data, size_t size) override;
+
+private:
+  struct Slot
+  {
+    char key[16];
+    size_t size;
+    uint8_t data[512];
+  };
+  FakeWorld &world;
+  Slot slots[4] = {};
+};
+
+// Fichiers du journal d'événements en mémoire, conservés à travers les coupures.
+// Écritures non chronométrées : quelques ms sur l'ESP32, noyées dans le réveil.
+#define FAKE_LOG_FILE_BYTES (EVENT_FILE_RECORDS * EVENT_RECORD_SIZE)
+class FakeLogFiles : public LogFiles
+{
+public:
+  explicit FakeLogFiles(FakeWorld &world) : world(world) {}
+  size_t size(int file) override;
+  bool append(int file, const void *data, size_t size) override;
+  bool read(int file, size_t offset, void *data, size_t size) override;
+  bool remove(int file) override;
+
+  // Coupure pendant une écriture : les bytes derniers octets du fichier sont perdus
+  // ou à moitié écrits
+  void tear(int file, size_t bytes);
+
+private:
+  FakeWorld &world;
+  size_t sizes[EVENT_LOG_FILES] = {};
+  uint8_t data[EVENT_LOG_FILES][FAKE_LOG_FILE_BYTES] = {};
+};
+
+// Pas de rastérisation : chaque champ de TempoView modifié compte pour une zone
+// de l'écran, l'horodatage du rafraîchissement en étant toujours une.
+class FakePanel : public Panel
+{
+public:
+  FakePanel(FakeWorld &world, int fullRefreshEvery, bool sleepWhileBusy)
+      : world(world), fullRefreshEvery(fullRefreshEvery), sleepWhileBusy(sleepWhileBusy) {}
+  void init() override;
+  void printLine(const char *text) override;
+  void drawBackground() override;
+  void drawTempo(const TempoView &view) override;
+  void update() override;
+  PanelStats stats() override;
+
+  // Contenu à l'écran "aujourd'hui|demain|blancs|rouges|barres", nullptr pour un écran de texte
+  const char *shownContent() const { return textShown || shown[0] == '\0' ? nullptr : shown; }
+  // Jour décrit par l'écran, "Sam 01 Nov"
+  const char *shownDay() const { return shownLabel; }
+
+private:
+  // Un rafraîchissement : transfert éveillé puis attente de BUSY
+  void refresh(unsigned long duration);
+
+  FakeWorld &world;
+  int fullRefreshEvery;
+  bool sleepWhileBusy;
+  PanelStats lastStats = {};
+  RefreshMemory memory = {};
+  bool textMode = false;
+  bool backgroundReady = false;
+  char shown[96] = "";
+  char drawn[96] = "";
+  char shownLabel[TIME_LABEL_LEN] = "";
+  char drawnLabel[TIME_LABEL_LEN] = "";
+  bool textShown = false;
+};
@@ -0,0 +1,244 @@
+#include "Simulation.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const WakePolicy wakePolicy = {{6, 30}, {12, 0}, 90, 5, 60, 3600, 20, 2, 21};
+
+WakeConfig nativeConfig()
+{
+  WakeConfig config;
+  config.wifiSsid = "ssid";
+  config.wifiKey = "key";
+  config.tempoSansCompte = true;
+  config.bothApis = false;
+  config.saisonTempo = "2025-2026";
+  config.debutSaisonTempo = "2025-09-01";
+  config.timeZone = "CET-1CEST,M3.5.0,M10.5.0/3";
+  config.ntpServer = "pool.ntp.org";
+  config.notAvailable = FAKE_NOT_AVAILABLE;
+  config.schedule = wakePolicy;
+  config.refreshGranularityMinutes = 24 * 60; // date seule, comme TOCUSTOMIZE.h
+  config.ntpMaxErrorSeconds = 30;
+  config.ntpMaxAgeSeconds = 24 * 3600;
+  config.dumpCycleLog = false;
+  config.budget = {20000, 3000};
+  config.hubServe = false;
+  config.hubHost = nullptr;
+  config.hubPort = 80;
+  config.raceSources = true;
+  return config;
+}
+
+time_t simulationStart(const char *timeZone)
+{
+  setenv("TZ", timeZone, 1);
+  tzset();
+  struct tm start = {};
+  start.tm_year = 2025 - 1900;
+  start.tm_mon = 10; // 1er novembre 2025, 11:05
+  start.tm_mday = 1;
+  start.tm_hour = 11;
+  start.tm_min = 5;
+  start.tm_isdst = -1;
+  return mktime(&start);
+}
+
+time_t Simulation::run(time_t epoch, int days, bool printWakes, SimulationReport &report)
+{
+  time_t end = epoch + (time_t)days * 86400;
+  if (printWakes)
+  {
+    printf("%-20s %8s %5s %4s %4s %6s %8s %7s\n", "réveil", "éveil ms", "wifi", "ntp", "api", "écran", "partiel", "allocs");
+  }
+
+  while (epoch < end)
+  {
+    epoch = wake(epoch, printWakes, report);
+  }
+  return epoch;
+}
+
+time_t Simulation::wake(time_t epoch, bool printWakes, SimulationReport &report)
+{
+  world.startCycle(epoch);
+  unsigned long allocationsBefore = fakeAllocations;
+  fakePaintStack(world);
+  runWakeCycle(hal, config, rtc);
+  unsigned long cycleAllocations = fakeAllocations - allocationsBefore;
+  if (afterWake)
+  {
+    afterWake(epoch);
+  }
+
+  // Le premier réveil d'un jour constate si la veille a reçu sa couleur
+  struct tm local;
+  localtime_r(&epoch, &local);
+  int ymd = tempoDateYmd(local);
+  if (lastWakeYmd != 0 && ymd != lastWakeYmd && tomorrowSeenYmd != lastWakeYmd)
+  {
+    report.daysWithoutTomorrow++;
+  }
+  lastWakeYmd = ymd;
+  if (rtc.tempo.dateYmd == ymd && strcmp(rtc.tempo.tomorrowColor, FAKE_NOT_AVAILABLE) != 0)
+  {
+    tomorrowSeenYmd = ymd;
+  }
+
+  if (printWakes)
+  {
+    struct tm timeinfo;
+    char label[24];
+    localtime_r(&epoch, &timeinfo);
+    strftime(label, sizeof(label), "%Y-%m-%d %H:%M", &timeinfo);
+    printf("%-20s %8lu %5d %4d %4d %6d %8d %7lu\n", label, world.ms, world.wifiConnects, world.ntpSyncs,
+           world.apiCalls, world.panelUpdates, world.partialUpdates, cycleAllocations);
+  }
+
+  for (int i = 0; i < PHASE_COUNT; i++)
+  {
+    report.phaseMs[i] += world.phaseMs[i];
+  }
+  report.cycles++;
+  report.awakeMs += world.ms;
+  report.parkedMs += world.parkedMs;
+  report.radioMs += world.radioMs;
+  report.allocations += cycleAllocations;
+  const CycleRecord *record = cycleLogLast(rtc.cycles);
+  if (record && record->minFreeHeap < report.minFreeHeap)
+  {
+    report.minFreeHeap = record->minFreeHeap;
+  }
+  if (record && record->stackFree < report.minStackFree)
+  {
+    report.minStackFree = record->stackFree;
+  }
+  if (record)
+  {
+    report.sourceWakes[record->source <= SOURCE_NONE ? record->source : SOURCE_NONE]++;
+    report.failedWakes += record->failures > 0;
+  }
+  report.wifiConnects += world.wifiConnects;
+  report.apiCalls += world.apiCalls;
+  report.apiConnections += world.apiConnections;
+  report.hubCalls += world.hubCalls;
+  report.panelUpdates += world.panelUpdates;
+  report.partialUpdates += world.partialUpdates;
+  report.ntpSyncs += world.ntpSyncs;
+  report.apiDays += world.apiDays;
+  report.maxApiDays = world.apiDays > report.maxApiDays ? world.apiDays : report.maxApiDays;
+  report.apiBytes += world.apiBytes;
+  report.apiNotModified += world.apiNotModified;
+  report.storageWrites += world.storageWrites;
+  report.logAppends += world.logAppends;
+  report.logBytes += world.logBytes;
+  report.logErases += world.logErases;
+  report.requestsCut += world.requestsCut;
+  if (pressWake)
+  {
+    report.buttonWakes++;
+    report.buttonOnline += world.wifiConnects > 0;
+    report.buttonMs += world.ms;
+  }
+  if (fabs(world.rtcOffset) > report.maxClockError)
+  {
+    report.maxClockError = fabs(world.rtcOffset);
+  }
+
+  if (!world.asleep)
+  {
+    // Le firmware reste éveillé : on simule un reset une heure plus tard
+    if (printWakes)
+    {
+      printf("  !! cycle terminé sans deep sleep\n");
+    }
+    return world.trueNow() + 3600;
+  }
+  uint64_t seconds = world.sleepSeconds ? world.sleepSeconds : 86400;
+  time_t now = world.trueNow();
+  while (nextPress < buttonPresses.size() && buttonPresses[nextPress] <= now)
+  {
+    nextPress++;
+  }
+  pressWake = nextPress < buttonPresses.size() && buttonPresses[nextPress] < now + (time_t)seconds;
+  if (!pressWake)
+  {
+    epoch = world.wakeAfterSleep(seconds);
+    world.wakeCause = WAKE_CAUSE_TIMER;
+  }
+  else if (pressResets)
+  {
+    epoch = world.wakeEarly(buttonPresses[nextPress++]);
+    world.wakeCause = WAKE_CAUSE_POWER_ON;
+    world.rtcValid = false;
+    memset(&rtc, 0, sizeof(rtc));
+  }
+  else
+  {
+    epoch = world.wakeEarly(buttonPresses[nextPress++]);
+    world.wakeCause = WAKE_CAUSE_BUTTON;
+  }
+  return epoch;
+}
+
+// Compteurs attendus : du 1er septembre à aujourd'hui, demain compris s'il est connu
+bool countsMatch(const Simulation &simulation, time_t now)
+{
+  struct tm last;
+  localtime_r(&now, &last);
+  if (strcmp(simulation.rtc.tempo.tomorrowColor, FAKE_NOT_AVAILABLE) != 0)
+  {
+    last.tm_mday++;
+    last.tm_hour = 12;
+    last.tm_isdst = -1;
+    mktime(&last);
+  }
+
+  struct tm day = last;
+  day.tm_year = last.tm_mon >= 8 ? last.tm_year : last.tm_year - 1;
+  day.tm_mon = 8;
+  day.tm_mday = 1;
+  int counts[3] = {};
+  while (true)
+  {
+    day.tm_hour = 12;
+    day.tm_isdst = -1;
+    time_t noon = mktime(&day);
+    const char *color = FakeWorld::colorForDay(noon);
+    counts[strcmp(color, "BLEU") == 0 ? 0 : strcmp(color, "BLANC") == 0 ? 1 : 2]++;
+    if (tempoDateYmd(day) == tempoDateYmd(last))
+    {
+      break;
+    }
+    day.tm_mday++;
+  }
+  const TempoState &tempo = simulation.rtc.tempo;
+  return tempo.countBlue == counts[0] && tempo.countWhite == counts[1] && tempo.countRed == counts[2];
+}
+
+const WakeupTime buttonTimes[BUTTON_PRESSES_PER_DAY] = {{6, 45}, {8, 10}, {12, 40}, {19, 30}, {23, 55}};
+
+std::vector<time_t> buttonSchedule(time_t start, int days)
+{
+  std::vector<time_t> presses;
+  for (int day = 0; day < days; day++)
+  {
+    for (const WakeupTime &press : buttonTimes)
+    {
+      struct tm local;
+      localtime_r(&start, &local);
+      local.tm_mday += day;
+      local.tm_hour = press.hour;
+      local.tm_min = press.minute;
+      local.tm_sec = 0;
+      local.tm_isdst = -1;
+      time_t time = mktime(&local);
+      if (time > start)
+      {
+        presses.push_back(time);
+      }
+    }
+  }
+  return presses;
+}
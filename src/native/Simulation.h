@@ -0,0 +1,103 @@
+#pragma once
+
+// Réveils et deep sleeps enchaînés en temps virtuel sur le matériel factice de
+// FakeHal.h, partagés par les modes du programme natif et les tests de test/.
+
+#include <functional>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "FakeHal.h"
+#include "WakeCycle.h"
+
+// Configuration de TOCUSTOMIZE.h ramenée à la simulation : API sans inscription, saison 2025-2026
+WakeConfig nativeConfig();
+// Règle le fuseau de timeZone et rend le 1er novembre 2025, 11:05 heure locale
+time_t simulationStart(const char *timeZone);
+
+struct SimulationReport
+{
+  int cycles = 0;
+  unsigned long phaseMs[PHASE_COUNT] = {};
+  unsigned long awakeMs = 0;
+  unsigned long parkedMs = 0; // dont sommeil léger pendant les rafraîchissements
+  unsigned long radioMs = 0;  // radio WiFi allumée
+  unsigned long allocations = 0;
+  uint32_t minFreeHeap = FAKE_HEAP_BYTES; // plus bas niveau sur l'ensemble des réveils
+  uint32_t minStackFree = FAKE_STACK_BYTES;
+  int wifiConnects = 0;
+  int apiCalls = 0;
+  int apiConnections = 0; // connexions TLS
+  int hubCalls = 0;
+  int panelUpdates = 0;
+  int partialUpdates = 0;
+  int ntpSyncs = 0;
+  int apiDays = 0;
+  int maxApiDays = 0; // plus grande requête
+  unsigned long apiBytes = 0; // corps de réponse reçus
+  int apiNotModified = 0;     // réponses 304
+  int sourceWakes[SOURCE_NONE + 1] = {}; // réveils par source des couleurs affichées
+  int failedWakes = 0;        // réveils terminés sur un échec
+  int storageWrites = 0;
+  int logAppends = 0;         // enregistrements ajoutés au journal d'événements
+  unsigned long logBytes = 0;
+  int logErases = 0;          // fichiers du journal effacés
+  int requestsCut = 0;        // requêtes de la tâche de fond coupées par le WiFi ou le deep sleep
+  double maxClockError = 0; // secondes, au moment de programmer le réveil suivant
+  int buttonWakes = 0;      // réveils dus à un appui
+  int buttonOnline = 0;     // dont réveils avec WiFi, le cache étant périmé
+  int daysWithoutTomorrow = 0; // jours finis sans la couleur du lendemain
+  unsigned long buttonMs = 0;
+};
+
+// Enchaîne réveils et deep sleeps en temps virtuel, l'état RTC étant conservé
+class Simulation
+{
+public:
+  Simulation()
+      : board(world), clock(world), network(world), api(world), raceApi(world), panel(world, 10, true), storage(world),
+        hubServer(world), logFiles(world), hal{board, clock, network, api, raceApi, panel, storage, hubServer, logFiles},
+        config(nativeConfig())
+  {
+    memset(&rtc, 0, sizeof(rtc));
+  }
+
+  time_t run(time_t epoch, int days, bool printWakes, SimulationReport &report);
+  // Un réveil et le deep sleep qui suit : heure réelle du réveil suivant
+  time_t wake(time_t epoch, bool printWakes, SimulationReport &report);
+
+  // Appelé à la fin de chaque réveil, avant le deep sleep simulé
+  std::function<void(time_t wakeEpoch)> afterWake;
+  // Heures réelles d'appui sur le bouton, croissantes. pressResets : le bouton est
+  // celui du reset, la carte repart sans mémoire RTC ni heure.
+  std::vector<time_t> buttonPresses;
+  bool pressResets = false;
+  size_t nextPress = 0;
+  bool pressWake = false; // réveil en cours dû à un appui
+  int lastWakeYmd = 0;     // jour local du réveil précédent
+  int tomorrowSeenYmd = 0; // dernier jour où la couleur du lendemain a été reçue
+
+  FakeWorld world;
+  FakeBoard board;
+  FakeClock clock;
+  FakeNetwork network;
+  FakeTempoApi api;
+  FakeTempoApi raceApi;
+  FakePanel panel;
+  FakeStorage storage;
+  FakeHubServer hubServer;
+  FakeLogFiles logFiles;
+  Hal hal;
+  WakeConfig config;
+  RtcState rtc;
+};
+
+// Compteurs de saison en mémoire RTC égaux à ceux du calendrier factice à l'heure now
+bool countsMatch(const Simulation &simulation, time_t now);
+
+// Heures d'appui chaque jour : matin avant et pendant la fenêtre de publication, midi, soir
+#define BUTTON_PRESSES_PER_DAY 5
+extern const WakeupTime buttonTimes[BUTTON_PRESSES_PER_DAY];
+// Appuis des days jours à partir de start, croissants
+std::vector<time_t> buttonSchedule(time_t start, int days);
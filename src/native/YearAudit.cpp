@@ -0,0 +1,321 @@
+#include "YearAudit.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Pannes scriptées autour des passages d'heure et des fins de mois et d'année,
+// dans l'ordre chronologique pour chaque type
+const YearOutage yearOutages[] = {
+    {OUTAGE_API, 2025, 9, 30, 18, 10},
+    {OUTAGE_WIFI, 2025, 10, 25, 22, 8},
+    {OUTAGE_API, 2025, 11, 30, 6, 20},
+    {OUTAGE_WIFI, 2025, 12, 31, 21, 14},
+    {OUTAGE_API_HANG, 2026, 1, 19, 6, 36},
+    {OUTAGE_WIFI, 2026, 2, 28, 5, 4},
+    {OUTAGE_API, 2026, 3, 28, 20, 14},
+    {OUTAGE_API_HANG, 2026, 6, 30, 23, 3},
+};
+
+const int yearOutageCount = sizeof(yearOutages) / sizeof(yearOutages[0]);
+
+time_t localTime(int year, int month, int mday, int hour, int minute)
+{
+  struct tm timeinfo = {};
+  timeinfo.tm_year = year - 1900;
+  timeinfo.tm_mon = month - 1;
+  timeinfo.tm_mday = mday;
+  timeinfo.tm_hour = hour;
+  timeinfo.tm_min = minute;
+  timeinfo.tm_isdst = -1;
+  return mktime(&timeinfo);
+}
+
+// Première occurrence de minute (heure locale) après after
+static time_t nextLocalMinute(time_t after, int minute)
+{
+  struct tm timeinfo;
+  localtime_r(&after, &timeinfo);
+  for (int day = 0;; day++)
+  {
+    struct tm candidate = timeinfo;
+    candidate.tm_mday += day;
+    candidate.tm_hour = minute / 60;
+    candidate.tm_min = minute % 60;
+    candidate.tm_sec = 0;
+    candidate.tm_isdst = -1;
+    time_t time = mktime(&candidate);
+    if (time > after)
+    {
+      return time;
+    }
+  }
+}
+
+// Date RTE attendue, calculée avec l'écart UTC que donne la libc à minuit
+static void expectedRteDate(char *buffer, size_t size, time_t now, int delta)
+{
+  struct tm day;
+  localtime_r(&now, &day);
+  day.tm_mday += delta;
+  day.tm_hour = 0;
+  day.tm_min = 0;
+  day.tm_sec = 0;
+  day.tm_isdst = -1;
+  mktime(&day);
+  long offset = labs(day.tm_gmtoff) / 60;
+  snprintf(buffer, size, "%04d-%02d-%02dT00:00:00%c%02ld:%02ld", day.tm_year + 1900, day.tm_mon + 1, day.tm_mday,
+           day.tm_gmtoff < 0 ? '-' : '+', offset / 60, offset % 60);
+}
+
+const char *anomalyNames[ANOMALY_COUNT] = {"horaire", "date API", "couleur", "retard", "sommeil"};
+
+YearAudit::YearAudit(Simulation &simulation, time_t start, bool verbose) : simulation(simulation), verbose(verbose)
+{
+  struct tm day;
+  localtime_r(&start, &day);
+  coveredYmd = tempoDateYmd(day);
+}
+
+void YearAudit::flag(AnomalyKind kind, time_t time, const char *format, ...)
+{
+  counts[kind]++;
+  total++;
+  if (counts[kind] > 5 && !verbose)
+  {
+    return;
+  }
+  char label[24];
+  struct tm timeinfo;
+  localtime_r(&time, &timeinfo);
+  strftime(label, sizeof(label), "%Y-%m-%d %H:%M:%S", &timeinfo);
+  char message[160];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  printf("  !! %-8s %s %s\n", anomalyNames[kind], label, message);
+}
+
+bool YearAudit::outageBetween(time_t from, time_t until) const
+{
+  for (const std::pair<time_t, time_t> &outage : outages)
+  {
+    if (outage.first < until && outage.second > from)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Heure locale du réveil recalculée à partir de la raison enregistrée par le réveil précédent
+void YearAudit::checkSchedule(time_t wakeEpoch)
+{
+  const WakePolicy &policy = simulation.config.schedule;
+  time_t after = previousEnd + WAKE_EARLY_TOLERANCE_SECONDS;
+  time_t expected = 0;
+  if (previousReason == WAKE_ROLLOVER)
+  {
+    expected = nextLocalMinute(after, policy.rolloverDelayMinutes);
+  }
+  else if (previousReason == WAKE_PUBLICATION)
+  {
+    expected = nextLocalMinute(after, policy.publicationStart.hour * 60 + policy.publicationStart.minute);
+  }
+  else if (previousReason == WAKE_POLL)
+  {
+    // Grille de la fenêtre, sa fin, puis les essais espacés du double de l'après-midi
+    int start = policy.publicationStart.hour * 60 + policy.publicationStart.minute;
+    int end = policy.publicationEnd.hour * 60 + policy.publicationEnd.minute;
+    std::vector<int> polls;
+    for (int minute = start; minute < end; minute += policy.publicationPollMinutes)
+    {
+      polls.push_back(minute);
+    }
+    for (int minute = end, gap = policy.publicationPollMinutes; minute < 24 * 60; minute += gap, gap *= 2)
+    {
+      polls.push_back(minute);
+    }
+    expected = nextLocalMinute(after, start);
+    for (int minute : polls)
+    {
+      time_t candidate = nextLocalMinute(after, minute);
+      expected = candidate < expected ? candidate : expected;
+    }
+  }
+  else
+  {
+    // Après un échec : attente exponentielle plafonnée, gigue comprise
+    time_t longest = (time_t)policy.retryMaxSeconds * 5 / 4;
+    if (wakeEpoch - previousEnd > longest && previousReason == WAKE_RETRY)
+    {
+      bool regular = false;
+      for (int minute : {policy.rolloverDelayMinutes, policy.publicationStart.hour * 60 + policy.publicationStart.minute})
+      {
+        regular = regular || llabs((long long)(wakeEpoch - nextLocalMinute(after, minute))) <= 120;
+      }
+      if (!regular)
+      {
+        flag(ANOMALY_SCHEDULE, wakeEpoch, "nouvel essai après %ld s", (long)(wakeEpoch - previousEnd));
+      }
+    }
+    return;
+  }
+
+  if (llabs((long long)(wakeEpoch - expected)) > 120)
+  {
+    char label[24];
+    struct tm timeinfo;
+    localtime_r(&expected, &timeinfo);
+    strftime(label, sizeof(label), "%Y-%m-%d %H:%M", &timeinfo);
+    flag(ANOMALY_SCHEDULE, wakeEpoch, "%s attendu à %s", wakeReasonNames[previousReason], label);
+  }
+}
+
+// Dates transmises à l'API : jour local de l'appel et décalage UTC de minuit ce jour-là
+void YearAudit::checkApiDates()
+{
+  FakeWorld &world = simulation.world;
+  for (int i = 0; i < world.apiDateCount && i < 3; i++)
+  {
+    char expected[32];
+    expectedRteDate(expected, sizeof(expected), world.apiCallTime, i);
+    const char *sent = world.apiDates[i];
+    // Sans compte, seule la partie AAAA-MM-JJ est transmise
+    size_t length = strlen(sent) == 10 ? 10 : strlen(expected) + 1;
+    if (strncmp(sent, expected, length) != 0)
+    {
+      flag(ANOMALY_DATE, world.apiCallTime, "jour %d : %s au lieu de %.*s", i, sent, (int)(length > 10 ? 25 : 10),
+           expected);
+    }
+  }
+}
+
+// Couleur du jour à l'écran, et heure à laquelle elle y apparaît chaque jour
+void YearAudit::checkDisplay()
+{
+  const char *shown = simulation.panel.shownContent();
+  time_t now = simulation.world.trueNow();
+  if (!shown)
+  {
+    return;
+  }
+  // Un écran resté sur un jour précédent porte sa date : il est en retard, pas faux
+  TimeSnapshot snapshot;
+  takeTimeSnapshot(snapshot, now);
+  char label[TIME_LABEL_LEN];
+  formatDayLabel(label, sizeof(label), snapshot, 0);
+  char today[TEMPO_COLOR_LEN];
+  snprintf(today, sizeof(today), "%.*s", (int)strcspn(shown, "|"), shown);
+  const char *truth = FakeWorld::colorForDay(now);
+  if (strcmp(simulation.panel.shownDay(), label) != 0 || strcmp(today, FAKE_NOT_AVAILABLE) == 0)
+  {
+    return;
+  }
+  if (strcmp(today, truth) != 0)
+  {
+    flag(ANOMALY_COLOR, now, "%s affiché, %s attendu", today, truth);
+    return;
+  }
+
+  struct tm day;
+  localtime_r(&now, &day);
+  if (tempoDateYmd(day) == coveredYmd)
+  {
+    return;
+  }
+  coveredYmd = tempoDateYmd(day);
+  const WakeupTime &limit = simulation.config.schedule.publicationStart;
+  time_t deadline = localTime(day.tm_year + 1900, day.tm_mon + 1, day.tm_mday, limit.hour, limit.minute) +
+                    WAKE_EARLY_TOLERANCE_SECONDS;
+  if (now > deadline)
+  {
+    lateDays++;
+    // Une panne dans les 24 h précédentes peut empêcher de connaître demain
+    if (!outageBetween(deadline - 86400, now))
+    {
+      flag(ANOMALY_LATE, now, "couleur du jour affichée %ld min après %02d:%02d", (long)(now - deadline) / 60,
+           limit.hour, limit.minute);
+    }
+  }
+}
+
+void YearAudit::afterWake(time_t wakeEpoch)
+{
+  FakeWorld &world = simulation.world;
+  if (previousReason >= 0)
+  {
+    checkSchedule(wakeEpoch);
+  }
+  checkApiDates();
+  checkDisplay();
+  if (!world.asleep || world.sleepSeconds == 0 || world.sleepSeconds > 26 * 3600)
+  {
+    flag(ANOMALY_SLEEP, world.trueNow(), "deep sleep de %llu s", (unsigned long long)world.sleepSeconds);
+  }
+
+  const CycleRecord *record = cycleLogLast(simulation.rtc.cycles);
+  previousReason = record ? record->nextWake : -1;
+  previousEnd = world.trueNow();
+}
+
+void OutageScript::advance()
+{
+  FakeWorld &world = simulation.world;
+  time_t now = world.trueNow();
+  while (nextApi < yearOutageCount && now >= world.apiDownUntil)
+  {
+    const YearOutage &outage = yearOutages[nextApi++];
+    if (outage.kind != OUTAGE_WIFI)
+    {
+      world.apiDownFrom = start(outage);
+      world.apiDownUntil = world.apiDownFrom + outage.hours * 3600;
+      world.apiHangs = outage.kind == OUTAGE_API_HANG;
+    }
+  }
+  while (nextWifi < yearOutageCount && now >= world.wifiDownUntil)
+  {
+    const YearOutage &outage = yearOutages[nextWifi++];
+    if (outage.kind == OUTAGE_WIFI)
+    {
+      world.wifiDownFrom = start(outage);
+      world.wifiDownUntil = world.wifiDownFrom + outage.hours * 3600;
+    }
+  }
+}
+
+time_t yearStart(const Simulation &simulation)
+{
+  setenv("TZ", simulation.config.timeZone, 1);
+  tzset();
+  return localTime(2025, 9, 1, 9, 0);
+}
+
+time_t yearRun(Simulation &simulation, YearAudit &audit, time_t start, int days, bool outages, bool verbose,
+               SimulationReport &report)
+{
+  OutageScript script(simulation);
+  if (outages)
+  {
+    for (const YearOutage &outage : yearOutages)
+    {
+      time_t from = OutageScript::start(outage);
+      audit.addOutage(from, from + outage.hours * 3600);
+    }
+    simulation.world.startCycle(start);
+    script.advance();
+  }
+  simulation.afterWake = [&](time_t wakeEpoch)
+  {
+    audit.afterWake(wakeEpoch);
+    if (outages)
+    {
+      script.advance();
+    }
+  };
+  time_t end = simulation.run(start, days, verbose, report);
+  simulation.afterWake = nullptr;
+  return end;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// Saison entière en temps virtuel à partir du 1er septembre 2025 : pannes scriptées
+// autour des passages d'heure et des fins de mois, et contrôle de chaque réveil.
+
+#include <utility>
+#include <vector>
+
+#include "Simulation.h"
+
+enum OutageKind
+{
+  OUTAGE_API,
+  OUTAGE_API_HANG, // l'API ne répond plus jusqu'au délai HTTP
+  OUTAGE_WIFI,
+};
+
+struct YearOutage
+{
+  OutageKind kind;
+  int year;
+  int month;
+  int mday;
+  int hour; // début, heure locale
+  int hours;
+};
+
+extern const YearOutage yearOutages[];
+extern const int yearOutageCount;
+
+time_t localTime(int year, int month, int mday, int hour, int minute);
+
+enum AnomalyKind
+{
+  ANOMALY_SCHEDULE, // réveil qui ne tombe pas à l'heure locale prévue
+  ANOMALY_DATE,     // date ou décalage UTC transmis à l'API
+  ANOMALY_COLOR,    // couleur du jour affichée fausse
+  ANOMALY_LATE,     // couleur du jour affichée après l'heure limite sans panne pour l'expliquer
+  ANOMALY_SLEEP,    // deep sleep nul, absent ou de plus d'un jour
+  ANOMALY_COUNT
+};
+
+extern const char *anomalyNames[ANOMALY_COUNT];
+
+// Contrôles faits après chaque réveil de la simulation sur un an
+class YearAudit
+{
+public:
+  YearAudit(Simulation &simulation, time_t start, bool verbose);
+
+  void addOutage(time_t from, time_t until) { outages.push_back({from, until}); }
+  void afterWake(time_t wakeEpoch);
+
+  int counts[ANOMALY_COUNT] = {};
+  int total = 0;
+  int lateDays = 0; // couleur du jour affichée après l'heure limite, pannes comprises
+
+private:
+  void flag(AnomalyKind kind, time_t time, const char *format, ...);
+  void checkSchedule(time_t wakeEpoch);
+  void checkApiDates();
+  void checkDisplay();
+  bool outageBetween(time_t from, time_t until) const;
+
+  Simulation &simulation;
+  bool verbose;
+  std::vector<std::pair<time_t, time_t>> outages;
+  time_t previousEnd = 0; // fin du réveil précédent, quand le suivant a été choisi
+  int previousReason = -1;
+  int coveredYmd; // dernier jour dont la couleur a été affichée
+};
+
+// Fenêtres de panne successives, posées une à une au fil des réveils
+class OutageScript
+{
+public:
+  explicit OutageScript(Simulation &simulation) : simulation(simulation) {}
+
+  // Après chaque réveil : passe à la panne suivante de chaque type une fois la précédente finie
+  void advance();
+
+  static time_t start(const YearOutage &outage)
+  {
+    return localTime(outage.year, outage.month, outage.mday, outage.hour, 0);
+  }
+
+private:
+  Simulation &simulation;
+  int nextApi = 0;
+  int nextWifi = 0;
+};
+
+// Règle le fuseau de la simulation et rend le 1er septembre 2025, 9:00 heure locale
+time_t yearStart(const Simulation &simulation);
+// days jours à partir de start, avec les pannes de yearOutages si outages, chaque
+// réveil passé à audit : heure réelle du réveil suivant
+time_t yearRun(Simulation &simulation, YearAudit &audit, time_t start, int days, bool outages, bool verbose,
+               SimulationReport &report);
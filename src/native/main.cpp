@@ -0,0 +1,1267 @@
+// Build natif : rejoue le cycle de réveil contre des implémentations factices
+// et mesure le temps éveillé simulé par phase, les allocations, le tas et la pile par cycle.
+//
+//   pio run -e native && .pio/build/native/program <mode> [jours] [options] [-v]
+//
+//   bench [-g<minutes>]  temps éveillé par phase, tas et pile, granularité de l'heure affichée (date seule par défaut)
+//   drift [-d<ppm>]      dérive de l'horloge RTC et synchros NTP semaine par semaine
+//   schedule             réveils par jour selon la publication RTE, les pannes et la batterie
+//   cycles               journal des réveils tel que le firmware le mesure et l'envoie en CSV
+//   season               taille des requêtes de compteurs avec l'historique de saison (mode avec compte, 14 jours par défaut)
+//   year                 saison entière (365 jours par défaut) : consommation estimée, heures de réveil et dates API contrôlées
+//   battery              mesure filtrée de la batterie et prévision d'autonomie pendant une décharge
+//   button               appuis sur le bouton : cache affiché sans réseau, réveils programmés inchangés
+//   hub                  parc d'écrans sur un réseau local, avec et sans écran hub
+//   conditional          API sans inscription : réponses 304 et octets reçus, avec et sans ETag
+//   sources              panne de l'API sans inscription : repli sur les autres sources et course
+//   events [fichier]     journal en flash (300 jours, saison configurée) : pannes, bouton, coupure en écriture, lignes "ev" dans fichier
+//   json                 tas et temps de lecture d'une réponse du calendrier RTE selon la longueur de saison
+//   replay <dossier>     relit les échanges enregistrés avec DEBUG_API (tools/rte_standin.py capture)
+
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <math.h>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "PanelLayout.h"
+#include "RteCalendar.h"
+#include "Simulation.h"
+#include "YearAudit.h"
+
+// pio test compile src/ avec les tests, qui ont chacun leur main
+#ifndef PIO_UNIT_TESTING
+
+// Chaque bloc commence par sa taille, pour tenir fakeHeapUsed et fakeHeapPeak
+#define HEAP_HEADER sizeof(max_align_t)
+
+void *operator new(size_t size)
+{
+  fakeAllocations++;
+  char *block = (char *)malloc(HEAP_HEADER + size);
+  if (!block)
+  {
+    throw std::bad_alloc();
+  }
+  *(size_t *)block = size;
+  fakeHeapUsed += size;
+  if (fakeHeapUsed > fakeHeapPeak)
+  {
+    fakeHeapPeak = fakeHeapUsed;
+  }
+  return block + HEAP_HEADER;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+  if (pointer)
+  {
+    char *block = (char *)pointer - HEAP_HEADER;
+    fakeHeapUsed -= *(size_t *)block;
+    free(block);
+  }
+}
+
+void operator delete[](void *pointer) noexcept
+{
+  operator delete(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+  operator delete(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+  operator delete(pointer);
+}
+
+static int bench(int days, int granularity, bool verbose)
+{
+  Simulation simulation;
+  simulation.board.verbose = verbose;
+  simulation.config.refreshGranularityMinutes = granularity;
+
+  SimulationReport report;
+  simulation.run(simulationStart(simulation.config.timeZone), days, true, report);
+
+  printf("\n%d réveils sur %d jours, %.1f réveils/jour\n", report.cycles, days, (double)report.cycles / days);
+  printf("%-14s %10s %10s\n", "phase", "total ms", "ms/réveil");
+  for (int i = 0; i < PHASE_COUNT; i++)
+  {
+    printf("%-14s %10lu %10.1f\n", fakePhaseNames[i], report.phaseMs[i], (double)report.phaseMs[i] / report.cycles);
+  }
+  printf("%-14s %10lu %10.1f\n", "total", report.awakeMs, (double)report.awakeMs / report.cycles);
+  printf("%-14s %10lu %10.1f\n", "sommeil léger", report.parkedMs, (double)report.parkedMs / report.cycles);
+  unsigned long cpuMs = report.awakeMs - report.parkedMs;
+  printf("%-14s %10lu %10.1f\n", "cpu éveillé", cpuMs, (double)cpuMs / report.cycles);
+  printf("allocations/réveil : %.1f\n", (double)report.allocations / report.cycles);
+  printf("tas : au plus %lu octets alloués pendant un réveil\n",
+         (unsigned long)(FAKE_HEAP_BYTES - report.minFreeHeap));
+  printf("pile : au plus %lu octets utilisés sur %d, %lu jamais touchés\n",
+         (unsigned long)(FAKE_STACK_BYTES - report.minStackFree), FAKE_STACK_BYTES,
+         (unsigned long)report.minStackFree);
+  return 0;
+}
+
+// Dérive de l'horloge RTC sur plusieurs semaines : synchros NTP et erreur maximale par semaine
+static int drift(int days, double driftPpm, bool verbose)
+{
+  Simulation simulation;
+  simulation.board.verbose = verbose;
+  simulation.world.rtcDriftPpm = driftPpm;
+
+  printf("dérive simulée : %.0f ppm, seuil %ld s, NTP au moins toutes les %ld h\n", driftPpm,
+         simulation.config.ntpMaxErrorSeconds, simulation.config.ntpMaxAgeSeconds / 3600);
+  printf("%-8s %8s %8s %10s %12s\n", "semaine", "réveils", "ntp", "ntp/jour", "erreur max s");
+
+  time_t epoch = simulationStart(simulation.config.timeZone);
+  int totalSyncs = 0;
+  int totalCycles = 0;
+  for (int week = 0; week * 7 < days; week++)
+  {
+    int weekDays = days - week * 7 < 7 ? days - week * 7 : 7;
+    SimulationReport report;
+    epoch = simulation.run(epoch, weekDays, verbose, report);
+    printf("%-8d %8d %8d %10.2f %12.1f\n", week + 1, report.cycles, report.ntpSyncs,
+           (double)report.ntpSyncs / weekDays, report.maxClockError);
+    totalSyncs += report.ntpSyncs;
+    totalCycles += report.cycles;
+  }
+  printf("\n%d synchros NTP pour %d réveils (%.0f%%), dérive estimée %.0f ppm\n", totalSyncs, totalCycles,
+         100.0 * totalSyncs / totalCycles, simulation.rtc.drift.driftPpm);
+  return 0;
+}
+
+struct ScheduleScenario
+{
+  const char *name;
+  int publishedMinute;  // heure de publication de la couleur du lendemain
+  int apiDownFromHour;  // panne API, en heures depuis le début de la simulation
+  int apiDownHours;
+  int wifiDownFromHour; // panne WiFi, idem
+  int wifiDownHours;
+  int batteryRaw;
+  bool apiHangs;          // pendant la panne, l'API ne répond plus
+  unsigned long budgetMs; // durée maximale d'un réveil, 0 : celle de nativeConfig
+};
+
+static const ScheduleScenario scheduleScenarios[] = {
+    {"publication 06:00", 6 * 60, 0, 0, 0, 0, 2400, false, 0},
+    {"publication 07:00", 7 * 60, 0, 0, 0, 0, 2400, false, 0},
+    {"publication 10:40", 10 * 60 + 40, 0, 0, 0, 0, 2400, false, 0},
+    {"publication 11:00", 11 * 60, 0, 0, 0, 0, 2400, false, 0},
+    {"publication 11:10", 11 * 60 + 10, 0, 0, 0, 0, 2400, false, 0},
+    {"jamais publiée", 24 * 60, 0, 0, 0, 0, 2400, false, 0},
+    {"panne API 36 h", 7 * 60, 24, 36, 0, 0, 2400, false, 0},
+    {"panne WiFi 12 h", 7 * 60, 0, 0, 40, 12, 2400, false, 0},
+    {"batterie faible", 7 * 60, 0, 0, 0, 0, 2100, false, 0},
+    {"batterie faible + 11:00", 11 * 60, 0, 0, 0, 0, 2100, false, 0},
+    {"batterie faible + 11:10", 11 * 60 + 10, 0, 0, 0, 0, 2100, false, 0},
+    {"API muette 36 h", 7 * 60, 24, 36, 0, 0, 2400, true, 0},
+    {"API muette, sans budget", 7 * 60, 24, 36, 0, 0, 2400, true, 600000},
+};
+
+// Réveils par jour du planificateur pour plusieurs séquences de résultats, et jours
+// finis sans la couleur du lendemain
+static int schedule(int days, bool verbose)
+{
+  printf("%-24s %9s %9s %9s %9s %10s %11s\n", "scénario", "réveils/j", "wifi/j", "api/j", "écran/j", "éveil s/j",
+         "sans demain");
+  for (const ScheduleScenario &scenario : scheduleScenarios)
+  {
+    Simulation simulation;
+    simulation.board.verbose = verbose;
+    time_t start = simulationStart(simulation.config.timeZone);
+    simulation.world.tomorrowPublishedMinute = scenario.publishedMinute;
+    simulation.world.apiDownFrom = start + scenario.apiDownFromHour * 3600;
+    simulation.world.apiDownUntil = simulation.world.apiDownFrom + scenario.apiDownHours * 3600;
+    simulation.world.wifiDownFrom = start + scenario.wifiDownFromHour * 3600;
+    simulation.world.wifiDownUntil = simulation.world.wifiDownFrom + scenario.wifiDownHours * 3600;
+    simulation.world.batteryRaw = scenario.batteryRaw;
+    simulation.world.apiHangs = scenario.apiHangs;
+    if (scenario.budgetMs > 0)
+    {
+      simulation.config.budget.budgetMs = scenario.budgetMs;
+    }
+
+    if (verbose)
+    {
+      printf("\n== %s\n", scenario.name);
+    }
+    SimulationReport report;
+    simulation.run(start, days, verbose, report);
+    printf("%-24s %9.2f %9.2f %9.2f %9.2f %10.1f %11d\n", scenario.name, (double)report.cycles / days,
+           (double)report.wifiConnects / days, (double)report.apiCalls / days,
+           (double)report.panelUpdates / days, report.awakeMs / 1000.0 / days, report.daysWithoutTomorrow);
+  }
+  return 0;
+}
+
+// Journal conservé en mémoire RTC après plusieurs jours, vu comme sur le port série
+static int cycles(int days, bool verbose)
+{
+  Simulation simulation;
+  simulation.board.verbose = verbose;
+  SimulationReport report;
+  simulation.run(simulationStart(simulation.config.timeZone), days, verbose, report);
+
+  char line[200];
+  for (int i = 0; cycleLogCsvLine(simulation.rtc.cycles, i, line, sizeof(line)); i++)
+  {
+    printf("%s\n", line);
+  }
+
+  unsigned long phaseMs[CYCLE_PHASE_COUNT] = {};
+  unsigned long parkedMs = 0;
+  int count = simulation.rtc.cycles.count;
+  for (int i = 0; i < count; i++)
+  {
+    for (int phase = 0; phase < CYCLE_PHASE_COUNT; phase++)
+    {
+      phaseMs[phase] += simulation.rtc.cycles.records[i].phaseMs[phase];
+    }
+    parkedMs += simulation.rtc.cycles.records[i].parkedMs;
+  }
+  printf("\nmoyenne sur les %d derniers réveils :\n", count);
+  for (int phase = 0; phase < CYCLE_PHASE_COUNT; phase++)
+  {
+    printf("%-14s %8.1f ms\n", cyclePhaseNames[phase], (double)phaseMs[phase] / count);
+  }
+  printf("%-14s %8.1f ms (dans panel_update)\n", "sommeil_leger", (double)parkedMs / count);
+  return 0;
+}
+
+struct SeasonScenario
+{
+  const char *name;
+  int wifiDownFromDay; // panne WiFi
+  int wifiDownDays;
+  int powerCutDay;     // mémoire RTC perdue, la flash est conservée
+};
+
+static const SeasonScenario seasonScenarios[] = {
+    {"continu", 0, 0, 0},
+    {"WiFi coupé 5 jours", 5, 5, 0},
+    {"coupure de courant", 0, 0, 10},
+};
+
+// Mode avec compte : jours demandés par requête et écritures flash de l'historique.
+// Les compteurs ne sont justes qu'une fois la panne finie : days doit la dépasser.
+static int season(int days, bool verbose)
+{
+  int wrong = 0;
+  printf("%-20s %8s %10s %10s %9s %10s\n", "scénario", "requêtes", "jours/req", "max jours", "écritures", "compteurs");
+  for (const SeasonScenario &scenario : seasonScenarios)
+  {
+    Simulation simulation;
+    simulation.board.verbose = verbose;
+    simulation.config.tempoSansCompte = false;
+    time_t epoch = simulationStart(simulation.config.timeZone);
+    simulation.world.wifiDownFrom = epoch + scenario.wifiDownFromDay * 86400;
+    simulation.world.wifiDownUntil = simulation.world.wifiDownFrom + scenario.wifiDownDays * 86400;
+
+    SimulationReport report;
+    if (scenario.powerCutDay > 0 && scenario.powerCutDay < days)
+    {
+      epoch = simulation.run(epoch, scenario.powerCutDay, verbose, report);
+      memset(&simulation.rtc, 0, sizeof(simulation.rtc));
+      simulation.world.rtcValid = false;
+      epoch = simulation.run(epoch, days - scenario.powerCutDay, verbose, report);
+    }
+    else
+    {
+      epoch = simulation.run(epoch, days, verbose, report);
+    }
+
+    bool exact = countsMatch(simulation, simulation.world.trueNow());
+    wrong += !exact;
+    printf("%-20s %8d %10.1f %10d %9d %10s\n", scenario.name, report.apiCalls,
+           report.apiCalls ? (double)report.apiDays / report.apiCalls : 0.0, report.maxApiDays,
+           report.storageWrites, exact ? "exacts" : "FAUX");
+  }
+  return wrong == 0 ? 0 : 1;
+}
+
+// Courants moyens en mA d'un T5 sur batterie, ordres de grandeur
+struct CurrentModel
+{
+  double deepSleepMa = 0.3;
+  double cpuMa = 45;        // processeur éveillé, radio coupée
+  double radioMa = 85;      // en plus du processeur, WiFi allumé
+  double lightSleepMa = 1.5; // sommeil léger pendant BUSY
+  double panelMa = 4;       // rafraîchissement de l'écran
+};
+
+static const CurrentModel currentModel;
+
+static double consumedMah(const SimulationReport &report, time_t seconds)
+{
+  double awake = report.awakeMs / 1000.0;
+  double parked = report.parkedMs / 1000.0;
+  double asleep = seconds > awake ? seconds - awake : 0;
+  double mAs = asleep * currentModel.deepSleepMa + (awake - parked) * currentModel.cpuMa +
+               parked * currentModel.lightSleepMa + report.radioMs / 1000.0 * currentModel.radioMa +
+               report.phaseMs[PHASE_PANEL_UPDATE] / 1000.0 * currentModel.panelMa;
+  return mAs / 3600;
+}
+
+struct YearScenario
+{
+  const char *name;
+  bool tempoSansCompte;
+  bool outages;
+};
+
+static const YearScenario yearScenarios[] = {
+    {"sans compte", true, false},
+    {"avec compte", false, false},
+    {"sans compte, pannes", true, true},
+    {"avec compte, pannes", false, true},
+};
+
+// Saison entière en temps virtuel à partir du 1er septembre 2025 : passages à
+// l'heure d'hiver et d'été, fins de mois et d'année, pannes scriptées. Consommation
+// estimée et contrôle de chaque réveil.
+static int year(int days, bool verbose)
+{
+  printf("%-20s %8s %9s %8s %7s %8s %5s %8s %7s %9s\n", "scénario", "réveils", "réveils/j", "radio s",
+         "écran", "partiels", "ntp", "mAh", "mAh/j", "anomalies");
+  int anomalies = 0;
+  for (const YearScenario &scenario : yearScenarios)
+  {
+    Simulation simulation;
+    simulation.board.verbose = verbose;
+    simulation.config.tempoSansCompte = scenario.tempoSansCompte;
+    time_t start = yearStart(simulation);
+    YearAudit audit(simulation, start, verbose);
+    if (verbose)
+    {
+      printf("\n== %s\n", scenario.name);
+    }
+    SimulationReport report;
+    time_t end = yearRun(simulation, audit, start, days, scenario.outages, verbose, report);
+    double mAh = consumedMah(report, end - start);
+    printf("%-20s %8d %9.2f %8.0f %7d %8d %5d %8.1f %7.2f %9d\n", scenario.name, report.cycles,
+           (double)report.cycles / days, report.radioMs / 1000.0, report.panelUpdates, report.partialUpdates,
+           report.ntpSyncs, mAh, mAh / days, audit.total);
+    if (audit.total > 0 || verbose)
+    {
+      printf("  ");
+      for (int i = 0; i < ANOMALY_COUNT; i++)
+      {
+        printf("%s %d  ", anomalyNames[i], audit.counts[i]);
+      }
+      printf("jours en retard %d (pannes comprises)\n", audit.lateDays);
+    }
+    anomalies += audit.total;
+  }
+  printf("%d anomalie(s)\n", anomalies);
+  return anomalies == 0 ? 0 : 1;
+}
+
+// Plus petite tension à laquelle la table de décharge donne percentage
+static int millivoltsForPercentage(double percentage)
+{
+  int millivolts = 3500;
+  while (millivolts < 4200 && batteryPercentage(millivolts) < percentage)
+  {
+    millivolts++;
+  }
+  return millivolts;
+}
+
+static int rawForMillivolts(int millivolts)
+{
+  return (int)lround(millivolts * 4096.0 / 7050);
+}
+
+// Écart à la tension réelle d'une lecture seule et de BATTERY_SAMPLES lectures filtrées
+static void batteryNoise(int noiseRaw)
+{
+  FakeWorld world;
+  FakeBoard board(world);
+  world.batteryNoiseRaw = noiseRaw;
+  printf("%8s %14s %14s %14s %14s\n", "réel mV", "1 lecture moy", "1 lecture max", "filtrée moy", "filtrée max");
+  for (int millivolts = 3600; millivolts <= 4200; millivolts += 200)
+  {
+    world.batteryRaw = rawForMillivolts(millivolts);
+    const int runs = 500;
+    double singleSum = 0, filteredSum = 0;
+    int singleMax = 0, filteredMax = 0;
+    for (int run = 0; run < runs; run++)
+    {
+      int raw[BATTERY_SAMPLES];
+      for (int i = 0; i < BATTERY_SAMPLES; i++)
+      {
+        raw[i] = board.readBatteryRaw();
+      }
+      int single = abs((int)lround(raw[0] * 7050.0 / 4096) - millivolts);
+      int filtered = abs(batteryMillivolts(raw, BATTERY_SAMPLES) - millivolts);
+      singleSum += single;
+      filteredSum += filtered;
+      singleMax = std::max(singleMax, single);
+      filteredMax = std::max(filteredMax, filtered);
+    }
+    printf("%8d %14.1f %14d %14.1f %14d\n", millivolts, singleSum / runs, singleMax, filteredSum / runs, filteredMax);
+  }
+}
+
+struct DischargeDay
+{
+  double day;     // jours écoulés au début de l'étape
+  int millivolts; // tension réelle
+  int measured;   // dernière mesure de l'historique
+  int daysLeft;   // prévision affichée
+};
+
+// Décharge d'une petite batterie jour après jour ; jours tenus et réveils
+static double discharge(int days, int lowBatteryDays, double capacityMah, std::vector<DischargeDay> &history,
+                        int &wakes, bool verbose)
+{
+  Simulation simulation;
+  simulation.board.verbose = verbose;
+  simulation.config.schedule.lowBatteryDays = lowBatteryDays;
+  simulation.world.batteryNoiseRaw = 20;
+  double percentage = 100;
+  time_t first = simulationStart(simulation.config.timeZone);
+  time_t epoch = first;
+  double lifetime = 0;
+  wakes = 0;
+  while (epoch - first < (time_t)days * 86400 && percentage > 0)
+  {
+    int millivolts = millivoltsForPercentage(percentage);
+    simulation.world.batteryRaw = rawForMillivolts(millivolts);
+    SimulationReport report;
+    time_t start = epoch;
+    // Un run s'arrête au premier réveil après 24 h : les étapes n'ont pas toutes la même durée
+    epoch = simulation.run(epoch, 1, verbose, report);
+    double used = consumedMah(report, epoch - start) / capacityMah * 100;
+    lifetime = (start - first + (used < percentage ? 1 : percentage / used) * (epoch - start)) / 86400.0;
+    percentage -= used;
+    wakes += report.cycles;
+
+    const BatteryHistory &measures = simulation.rtc.battery;
+    int last = (measures.next + BATTERY_HISTORY_SIZE - 1) % BATTERY_HISTORY_SIZE;
+    history.push_back({(start - first) / 86400.0, millivolts, measures.count ? measures.millivolts[last] : 0,
+                       batteryForecastDays(measures)});
+  }
+  return lifetime;
+}
+
+// Appuis sur le bouton : voie rapide depuis le cache contre le bouton reset d'avant,
+// et réveils programmés identiques à ceux d'une simulation sans appui
+static int button(int days, bool verbose)
+{
+  static const char *names[] = {"sans appui", "bouton (ext0)", "reset (avant)"};
+  std::vector<time_t> timerWakes[3];
+  printf("%d appuis par jour sur %d jours\n", BUTTON_PRESSES_PER_DAY, days);
+  printf("%-16s %11s %7s %9s %9s %10s\n", "scénario", "programmés", "appuis", "en ligne", "ms/appui", "éveil s/j");
+  for (int run = 0; run < 3; run++)
+  {
+    Simulation simulation;
+    simulation.board.verbose = verbose;
+    time_t start = simulationStart(simulation.config.timeZone);
+    if (run > 0)
+    {
+      simulation.buttonPresses = buttonSchedule(start, days);
+      simulation.pressResets = run == 2;
+    }
+    std::vector<time_t> &wakes = timerWakes[run];
+    simulation.afterWake = [&](time_t wakeEpoch)
+    {
+      if (simulation.world.wakeCause == WAKE_CAUSE_TIMER)
+      {
+        wakes.push_back(wakeEpoch);
+      }
+    };
+    if (verbose)
+    {
+      printf("\n== %s\n", names[run]);
+    }
+    SimulationReport report;
+    simulation.run(start, days, verbose, report);
+    printf("%-16s %11zu %7d %9d %9.0f %10.1f\n", names[run], wakes.size(), report.buttonWakes,
+           report.buttonOnline, report.buttonWakes ? (double)report.buttonMs / report.buttonWakes : 0.0,
+           report.awakeMs / 1000.0 / days);
+  }
+
+  // Les durées d'éveil différentes décalent les réveils de quelques secondes dans le temps simulé
+  bool unchanged = timerWakes[0].size() == timerWakes[1].size();
+  for (size_t i = 0; unchanged && i < timerWakes[0].size(); i++)
+  {
+    unchanged = labs((long)(timerWakes[0][i] - timerWakes[1][i])) <= WAKE_EARLY_TOLERANCE_SECONDS;
+  }
+  printf("réveils programmés identiques avec et sans appuis : %s\n", unchanged ? "oui" : "NON");
+  return unchanged ? 0 : 1;
+}
+
+#define FLEET_SCREENS 8
+
+struct FleetScenario
+{
+  const char *name;
+  bool hub;           // l'écran 0 sert les couleurs aux autres
+  int hubDownFromDay; // écran hub éteint pendant hubDownDays jours
+  int hubDownDays;
+};
+
+static const FleetScenario fleetScenarios[] = {
+    {"sans hub", false, 0, 0},
+    {"hub", true, 0, 0},
+    {"hub éteint 2 jours", true, 3, 2},
+};
+
+// Parc d'écrans sur un même réseau local : appels à l'API et connexions TLS sans hub,
+// puis avec l'écran 0 en hub. Les réveils des écrans sont rejoués dans l'ordre du temps.
+static int hub(int days, bool verbose)
+{
+  printf("%d écrans, %d jours\n", FLEET_SCREENS, days);
+  printf("%-20s %8s %8s %10s %10s %14s\n", "scénario", "api/j", "tls/j", "hub/j", "réponses", "éveil s/j/écran");
+  for (const FleetScenario &scenario : fleetScenarios)
+  {
+    FakeLan lan;
+    std::vector<std::unique_ptr<Simulation>> fleet;
+    std::vector<SimulationReport> reports(FLEET_SCREENS);
+    std::vector<time_t> next(FLEET_SCREENS);
+    time_t start = 0;
+    for (int i = 0; i < FLEET_SCREENS; i++)
+    {
+      fleet.emplace_back(new Simulation());
+      Simulation &screen = *fleet.back();
+      screen.board.verbose = verbose;
+      screen.world.lan = &lan;
+      screen.world.randomState = i + 1;
+      screen.config.hubServe = scenario.hub && i == 0;
+      screen.config.hubHost = scenario.hub && i > 0 ? "192.168.1.20" : nullptr;
+      start = simulationStart(screen.config.timeZone);
+      // Écrans branchés à quelques minutes d'écart
+      next[i] = start + i * 173;
+    }
+    time_t end = start + (time_t)days * 86400;
+    time_t downFrom = start + (time_t)scenario.hubDownFromDay * 86400;
+    time_t downUntil = downFrom + (time_t)scenario.hubDownDays * 86400;
+
+    while (true)
+    {
+      int screen = (int)(std::min_element(next.begin(), next.end()) - next.begin());
+      if (next[screen] >= end)
+      {
+        break;
+      }
+      if (screen == 0 && scenario.hub && next[0] >= downFrom && next[0] < downUntil)
+      {
+        lan.servingUntil = lan.servingUntil < downFrom ? lan.servingUntil : downFrom;
+        next[0] = downUntil;
+        continue;
+      }
+      if (verbose)
+      {
+        printf("-- écran %d\n", screen);
+      }
+      next[screen] = fleet[screen]->wake(next[screen], verbose, reports[screen]);
+    }
+
+    int apiCalls = 0;
+    int connections = 0;
+    double clientAwakeMs = 0;
+    for (int i = 0; i < FLEET_SCREENS; i++)
+    {
+      apiCalls += reports[i].apiCalls;
+      connections += reports[i].apiConnections;
+      // Le hub reste éveillé pour servir : seuls les autres écrans comptent ici
+      if (!fleet[i]->config.hubServe)
+      {
+        clientAwakeMs += reports[i].awakeMs;
+      }
+    }
+    int clients = scenario.hub ? FLEET_SCREENS - 1 : FLEET_SCREENS;
+    printf("%-20s %8.2f %8.2f %10.2f %10d %14.2f\n", scenario.name, (double)apiCalls / days,
+           (double)connections / days, (double)lan.requests / days, lan.answered,
+           clientAwakeMs / 1000.0 / days / clients);
+  }
+  return 0;
+}
+
+struct ConditionalScenario
+{
+  const char *name;
+  bool validators;      // le serveur donne un ETag et répond 304
+  int publishedMinute;  // publication de demain
+};
+
+static const ConditionalScenario conditionalScenarios[] = {
+    {"sans ETag, 07:00", false, 7 * 60},
+    {"ETag, 07:00", true, 7 * 60},
+    {"sans ETag, 11:00", false, 11 * 60},
+    {"ETag, 11:00", true, 11 * 60},
+};
+
+// API sans inscription avec et sans requêtes conditionnelles : octets reçus, temps
+// d'API et radio, et écrans identiques d'un scénario à l'autre
+static int conditional(int days, bool verbose)
+{
+  printf("%-18s %8s %8s %10s %10s %10s\n", "scénario", "req/j", "304/j", "Ko/j", "api ms/j", "radio s/j");
+  bool identical = true;
+  std::vector<std::string> shown[2];
+  for (size_t run = 0; run < sizeof(conditionalScenarios) / sizeof(conditionalScenarios[0]); run++)
+  {
+    const ConditionalScenario &scenario = conditionalScenarios[run];
+    Simulation simulation;
+    simulation.board.verbose = verbose;
+    simulation.world.apiValidators = scenario.validators;
+    simulation.world.tomorrowPublishedMinute = scenario.publishedMinute;
+    std::vector<std::string> &screens = shown[run % 2];
+    screens.clear();
+    simulation.afterWake = [&](time_t)
+    {
+      const char *content = simulation.panel.shownContent();
+      screens.push_back(std::string(simulation.panel.shownDay()) + " " + (content ? content : "(texte)"));
+    };
+    if (verbose)
+    {
+      printf("\n== %s\n", scenario.name);
+    }
+    SimulationReport report;
+    simulation.run(simulationStart(simulation.config.timeZone), days, verbose, report);
+    printf("%-18s %8.2f %8.2f %10.2f %10.0f %10.2f\n", scenario.name, 2.0 * report.apiCalls / days,
+           (double)report.apiNotModified / days, report.apiBytes / 1024.0 / days,
+           (double)report.phaseMs[PHASE_API] / days, report.radioMs / 1000.0 / days);
+    if (run % 2 == 1)
+    {
+      identical = identical && shown[0] == shown[1];
+    }
+  }
+  printf("écrans identiques avec et sans requêtes conditionnelles : %s\n", identical ? "oui" : "NON");
+  return identical ? 0 : 1;
+}
+
+struct SourceScenario
+{
+  const char *name;
+  bool bothApis;   // l'API avec compte en plus de celle sans inscription
+  bool race;       // course entre sources
+  bool hangs;      // pendant la panne, l'API sans inscription ne répond plus
+};
+
+static const SourceScenario sourceScenarios[] = {
+    {"libre seule, erreurs", false, true, false},
+    {"libre+compte, erreurs", true, true, false},
+    {"libre seule, muette", false, true, true},
+    {"libre+compte, muette", true, false, true},
+    {"libre+compte, muette, course", true, true, true},
+};
+
+// Panne de deux jours de la seule API sans inscription : réveils en échec et
+// sources des couleurs affichées, avec ou sans l'API avec compte et la course
+static int sources(int days, bool verbose)
+{
+  printf("%-30s %9s %7s %7s %7s %7s %9s %9s\n", "scénario", "réveils/j", "échecs", "libre", "compte", "cache",
+         "api s/j", "éveil s/j");
+  for (const SourceScenario &scenario : sourceScenarios)
+  {
+    Simulation simulation;
+    simulation.board.verbose = verbose;
+    simulation.config.bothApis = scenario.bothApis;
+    simulation.config.raceSources = scenario.race;
+    time_t start = simulationStart(simulation.config.timeZone);
+    simulation.world.apiDownFrom = start + 24 * 3600;
+    simulation.world.apiDownUntil = simulation.world.apiDownFrom + 48 * 3600;
+    simulation.world.apiDownSources = 1u << SOURCE_FREE;
+    simulation.world.apiHangs = scenario.hangs;
+    if (verbose)
+    {
+      printf("\n== %s\n", scenario.name);
+    }
+    SimulationReport report;
+    simulation.run(start, days, verbose, report);
+    printf("%-30s %9.2f %7d %7d %7d %7d %9.2f %9.2f\n", scenario.name, (double)report.cycles / days,
+           report.failedWakes, report.sourceWakes[SOURCE_FREE], report.sourceWakes[SOURCE_ACCOUNT],
+           report.sourceWakes[SOURCE_CACHE], report.phaseMs[PHASE_API] / 1000.0 / days,
+           report.awakeMs / 1000.0 / days);
+  }
+  return 0;
+}
+
+// Enregistrements comparés champ à champ, sans numéro, version ni CRC
+static bool sameEvent(const EventRecord &stored, EventRecord expected)
+{
+  expected.sequence = stored.sequence;
+  expected.version = stored.version;
+  expected.crc = stored.crc;
+  return memcmp(&stored, &expected, sizeof(stored)) == 0;
+}
+
+// Journal d'événements en flash après des pannes WiFi et API, des appuis sur le
+// bouton et une coupure de courant au milieu d'une écriture : enregistrements
+// relus, séquence et volume écrit. Assez de réveils pour effacer les plus anciens.
+static int events(int days, const char *path, bool verbose)
+{
+  Simulation simulation;
+  simulation.board.verbose = verbose;
+  time_t start = simulationStart(simulation.config.timeZone);
+  simulation.buttonPresses = buttonSchedule(start, days);
+  simulation.world.wifiDownFrom = start + 3 * 86400 + 6 * 3600;
+  simulation.world.wifiDownUntil = simulation.world.wifiDownFrom + 10 * 3600;
+  simulation.world.apiDownFrom = start + 6 * 86400 + 5 * 3600;
+  simulation.world.apiDownUntil = simulation.world.apiDownFrom + 30 * 3600;
+  simulation.world.apiHangs = true;
+  // Chaque réveil terminé, tel que le journal en flash devrait le garder
+  std::vector<EventRecord> expected;
+  simulation.afterWake = [&](time_t) {
+    EventRecord event;
+    eventRecordFromCycle(event, *cycleLogLast(simulation.rtc.cycles));
+    expected.push_back(event);
+  };
+
+  SimulationReport report;
+  int cutDay = days / 2;
+  time_t epoch = simulation.run(start, cutDay, verbose, report);
+  // Coupure pendant l'écriture : le dernier enregistrement est tronqué, l'avant-dernier
+  // abîmé, et la position d'écriture en mémoire RTC est perdue
+  simulation.logFiles.tear(simulation.rtc.events.file, EVENT_RECORD_SIZE * 3 / 2);
+  expected.resize(expected.size() - 2);
+  memset(&simulation.rtc, 0, sizeof(simulation.rtc));
+  simulation.world.rtcValid = false;
+  simulation.run(epoch, days - cutDay, verbose, report);
+
+  FILE *output = path ? fopen(path, "w") : nullptr;
+  if (path && !output)
+  {
+    fprintf(stderr, "impossible d'écrire %s\n", path);
+    return 1;
+  }
+  std::vector<EventRecord> stored;
+  EventLogReader reader;
+  EventRecord event;
+  eventLogRewind(simulation.logFiles, simulation.rtc.events, reader);
+  while (eventLogNext(simulation.logFiles, reader, event))
+  {
+    stored.push_back(event);
+    if (output)
+    {
+      char line[EVENT_HEX_LEN];
+      eventRecordHex(event, line, sizeof(line));
+      fprintf(output, "%s\n", line);
+    }
+  }
+  if (output)
+  {
+    fclose(output);
+  }
+
+  int disorders = 0;
+  for (size_t i = 1; i < stored.size(); i++)
+  {
+    disorders += stored[i].sequence <= stored[i - 1].sequence;
+  }
+  int mismatches = stored.size() > expected.size() ? (int)stored.size() : 0;
+  for (size_t i = 0; mismatches == 0 && i < stored.size(); i++)
+  {
+    mismatches += !sameEvent(stored[i], expected[expected.size() - stored.size() + i]);
+  }
+
+  printf("réveils simulés            %d (%.1f par jour)\n", report.cycles, (double)report.cycles / days);
+  printf("enregistrements relus      %zu, séquences %lu à %lu\n", stored.size(),
+         stored.empty() ? 0UL : (unsigned long)stored.front().sequence,
+         stored.empty() ? 0UL : (unsigned long)stored.back().sequence);
+  printf("CRC faux ignorés           %d\n", reader.skipped);
+  printf("séquences non croissantes  %d\n", disorders);
+  printf("différences avec le cycle  %d\n", mismatches);
+  printf("écritures par jour         %.1f, %.0f octets\n", (double)report.logAppends / days,
+         (double)report.logBytes / days);
+  printf("fichiers effacés           %d\n", report.logErases);
+  bool ok = !stored.empty() && disorders == 0 && mismatches == 0 && reader.skipped <= 1;
+  return ok ? 0 : 1;
+}
+
+// Mesure filtrée de la batterie, prévision d'autonomie et réveils espacés en fin de vie
+static int battery(int days, bool verbose)
+{
+  batteryNoise(20);
+
+  const double capacityMah = 250;
+  printf("\nbatterie de %.0f mAh, bruit de l'ADC +/-20 avec pics\n", capacityMah);
+  std::vector<DischargeDay> adaptive;
+  int adaptiveWakes;
+  double adaptiveLifetime =
+      discharge(days, nativeConfig().schedule.lowBatteryDays, capacityMah, adaptive, adaptiveWakes, verbose);
+  printf("%6s %8s %8s %10s %10s\n", "jour", "réel mV", "mesure", "prévision", "restant");
+  for (size_t i = 0; i < adaptive.size(); i++)
+  {
+    const DischargeDay &entry = adaptive[i];
+    if (verbose || i % 3 == 0 || i + 1 == adaptive.size())
+    {
+      printf("%6.1f %8d %8d %10d %10.1f\n", entry.day, entry.millivolts, entry.measured, entry.daysLeft,
+             adaptiveLifetime - entry.day);
+    }
+  }
+
+  std::vector<DischargeDay> fixed;
+  int fixedWakes;
+  double fixedLifetime = discharge(days, 0, capacityMah, fixed, fixedWakes, verbose);
+  printf("\n%-28s %11s %10s\n", "", "autonomie j", "réveils/j");
+  printf("%-28s %11.2f %10.2f\n", "réveils espacés (prévision)", adaptiveLifetime, adaptiveWakes / adaptiveLifetime);
+  printf("%-28s %11.2f %10.2f\n", "pourcentage seul", fixedLifetime, fixedWakes / fixedLifetime);
+  return 0;
+}
+
+// Réponse enregistrée, rejouée octet par octet
+class MemoryReader : public ByteReader
+{
+public:
+  explicit MemoryReader(const std::string &data) : data(data) {}
+
+  int read() override
+  {
+    return position < data.size() ? (unsigned char)data[position++] : -1;
+  }
+
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    size_t count = data.size() - position < length ? data.size() - position : length;
+    memcpy(buffer, data.data() + position, count);
+    position += count;
+    return count;
+  }
+
+  size_t position = 0;
+
+private:
+  const std::string &data;
+};
+
+// Calendrier au format RTE du 1er septembre 2025 sur days jours, le plus récent en premier
+static std::string rteCalendarPayload(int days, SeasonCounts &truth)
+{
+  static const char *rteColors[] = {"BLUE", "WHITE", "RED"};
+  truth = {0, 0, 0};
+  std::string values;
+  char day[256];
+  for (int i = 0; i < days; i++)
+  {
+    struct tm start = {};
+    start.tm_year = 2025 - 1900;
+    start.tm_mon = 8;
+    start.tm_mday = 1 + i;
+    start.tm_hour = 12;
+    start.tm_isdst = -1;
+    time_t noon = mktime(&start);
+    struct tm next = start;
+    next.tm_mday++;
+    mktime(&next);
+
+    DayColor color = dayColorFromName(FakeWorld::colorForDay(noon));
+    truth.blue += color == DAY_BLUE;
+    truth.white += color == DAY_WHITE;
+    truth.red += color == DAY_RED;
+    snprintf(day, sizeof(day),
+             "{\"start_date\":\"%04d-%02d-%02dT00:00:00%s\",\"end_date\":\"%04d-%02d-%02dT00:00:00%s\","
+             "\"value\":\"%s\",\"updated_date\":\"%04d-%02d-%02dT10:20:00%s\"}",
+             start.tm_year + 1900, start.tm_mon + 1, start.tm_mday, start.tm_isdst ? "+02:00" : "+01:00",
+             next.tm_year + 1900, next.tm_mon + 1, next.tm_mday, next.tm_isdst ? "+02:00" : "+01:00",
+             rteColors[color - 1],
+             start.tm_year + 1900, start.tm_mon + 1, start.tm_mday, start.tm_isdst ? "+02:00" : "+01:00");
+    values = std::string(day) + (i > 0 ? "," : "") + values;
+  }
+  return "{\"tempo_like_calendars\":{\"start_date\":\"2025-09-01T00:00:00+02:00\","
+         "\"end_date\":\"2026-09-01T00:00:00+02:00\",\"values\":[" + values + "]}}";
+}
+
+// Découpage en morceaux de 1 ko comme le serveur RTE, suivi du début de la réponse suivante
+static std::string chunked(const std::string &payload, size_t &bodyLength)
+{
+  std::string body;
+  char header[16];
+  for (size_t offset = 0; offset < payload.size(); offset += 1024)
+  {
+    std::string chunk = payload.substr(offset, 1024);
+    snprintf(header, sizeof(header), "%zx\r\n", chunk.size());
+    body += header + chunk + "\r\n";
+  }
+  body += "0\r\n\r\n";
+  bodyLength = body.size();
+  return body + "HTTP/1.1 200 OK\r\n";
+}
+
+static double microsSince(std::chrono::steady_clock::time_point start, int runs)
+{
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / runs;
+}
+
+// Réponse entière en mémoire puis document complet, contre lecture en flux filtrée
+static int json(bool verbose)
+{
+  static const int seasonLengths[] = {2, 7, 31, 92, 183, 366};
+  const int runs = 50;
+  printf("%6s %8s | %10s %10s | %9s %7s %10s | %s\n", "jours", "octets", "avant tas", "avant µs",
+         "flux pile", "allocs", "flux µs", "compteurs");
+  for (int days : seasonLengths)
+  {
+    SeasonCounts truth;
+    std::string payload = rteCalendarPayload(days, truth);
+    size_t bodyLength;
+    std::string response = chunked(payload, bodyLength);
+
+    // Avant : String du corps puis DynamicJsonDocument de sa taille
+    size_t bufferedHeap = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++)
+    {
+      std::string body = payload;
+      DynamicJsonDocument doc(body.size());
+      deserializeJson(doc, &body[0]);
+      JsonArray values = doc["tempo_like_calendars"]["values"];
+      int count = 0;
+      for (JsonObject value : values)
+      {
+        count += dayColorFromName(value["value"] | "") != DAY_UNKNOWN;
+      }
+      bufferedHeap = body.capacity() + doc.capacity();
+    }
+    double bufferedMicros = microsSince(start, runs);
+
+    // Après : lecture jour par jour sur le flux découpé en morceaux
+    RteCalendar calendar = {};
+    bool exact = true;
+    unsigned long before = fakeAllocations;
+    start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++)
+    {
+      MemoryReader connection(response);
+      HttpBodyReader body(connection, -1, true);
+      exact = rteCalendarParse(body, "2025-09-01", "2025-09-02", calendar) && exact;
+      body.drain();
+      // La réponse suivante doit rester intacte sur la connexion
+      exact = exact && connection.position == bodyLength && body.bytesRead() == payload.size();
+    }
+    double streamMicros = microsSince(start, runs);
+    double streamAllocations = (double)(fakeAllocations - before) / runs;
+    size_t stack = sizeof(HttpBodyReader) + sizeof(StaticJsonDocument<192>) + sizeof(StaticJsonDocument<64>);
+
+    exact = exact && calendar.days == days && calendar.counts.blue == truth.blue &&
+            calendar.counts.white == truth.white && calendar.counts.red == truth.red;
+    printf("%6d %8zu | %10zu %10.1f | %9zu %7.1f %10.1f | %s\n", days, payload.size(), bufferedHeap,
+           bufferedMicros, stack, streamAllocations, streamMicros, exact ? "exacts" : "FAUX");
+    if (verbose)
+    {
+      printf("       %d bleus, %d blancs, %d rouges\n", calendar.counts.blue, calendar.counts.white, calendar.counts.red);
+    }
+  }
+  return 0;
+}
+
+struct Recording
+{
+  std::string name;
+  int status = 0;
+  std::string expected; // "AAAA-MM-JJ couleur AAAA-MM-JJ couleur bleus blancs rouges jours"
+  std::string body;
+};
+
+// En-têtes "clé: valeur" jusqu'à la ligne vide, puis le corps
+static bool readRecording(const std::string &path, Recording &recording)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+  std::string data;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+  {
+    data.append(buffer, count);
+  }
+  fclose(file);
+
+  size_t end = data.find("\n\n");
+  if (end == std::string::npos)
+  {
+    return false;
+  }
+  recording.body = data.substr(end + 2);
+  size_t line = 0;
+  while (line < end)
+  {
+    size_t next = data.find('\n', line);
+    std::string header = data.substr(line, next - line);
+    if (header.compare(0, 8, "statut: ") == 0)
+    {
+      recording.status = atoi(header.c_str() + 8);
+    }
+    else if (header.compare(0, 9, "attendu: ") == 0)
+    {
+      recording.expected = header.substr(9);
+    }
+    line = next + 1;
+  }
+  return true;
+}
+
+// Rejoue les réponses de calendrier enregistrées : mêmes résultats que sur la
+// carte, échec propre sur une réponse coupée, et temps de lecture
+static int replay(const char *directory, bool verbose)
+{
+  DIR *dir = directory ? opendir(directory) : nullptr;
+  if (!dir)
+  {
+    fprintf(stderr, "dossier d'enregistrements introuvable : %s\n", directory ? directory : "(aucun)");
+    return 1;
+  }
+  std::vector<std::string> names;
+  while (struct dirent *entry = readdir(dir))
+  {
+    std::string name = entry->d_name;
+    if (name.size() > 5 && name.compare(name.size() - 5, 5, ".http") == 0)
+    {
+      names.push_back(name);
+    }
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+
+  const int runs = 50;
+  int failures = 0;
+  printf("%-24s %8s %10s %10s %8s\n", "enregistrement", "octets", "résultat", "coupée", "µs");
+  for (const std::string &name : names)
+  {
+    Recording recording;
+    if (!readRecording(std::string(directory) + "/" + name, recording) || recording.expected.empty())
+    {
+      continue; // jetons, erreurs HTTP : rien à relire
+    }
+    char today[11];
+    char tomorrow[11];
+    RteCalendar expected = {};
+    int todayColor;
+    int tomorrowColor;
+    if (sscanf(recording.expected.c_str(), "%10s %d %10s %d %d %d %d %d", today, &todayColor, tomorrow,
+               &tomorrowColor, &expected.counts.blue, &expected.counts.white, &expected.counts.red,
+               &expected.days) != 8)
+    {
+      printf("%-24s attendu illisible\n", name.c_str());
+      failures++;
+      continue;
+    }
+
+    RteCalendar calendar = {};
+    bool same = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++)
+    {
+      MemoryReader connection(recording.body);
+      HttpBodyReader body(connection, (long)recording.body.size(), false);
+      same = rteCalendarParse(body, today, tomorrow, calendar) && same;
+    }
+    double micros = microsSince(start, runs);
+    same = same && calendar.today == todayColor && calendar.tomorrow == tomorrowColor &&
+           calendar.counts.blue == expected.counts.blue && calendar.counts.white == expected.counts.white &&
+           calendar.counts.red == expected.counts.red && calendar.days == expected.days;
+
+    // Connexion coupée à mi-corps : la lecture doit échouer, pas rendre des compteurs partiels
+    std::string half = recording.body.substr(0, recording.body.size() / 2);
+    MemoryReader cut(half);
+    HttpBodyReader cutBody(cut, (long)recording.body.size(), false);
+    RteCalendar partial;
+    bool cutRejected = !rteCalendarParse(cutBody, today, tomorrow, partial);
+
+    failures += !same + !cutRejected;
+    printf("%-24s %8zu %10s %10s %8.1f\n", name.c_str(), recording.body.size(), same ? "identique" : "DIFFÉRENT",
+           cutRejected ? "rejetée" : "ACCEPTÉE", micros);
+    if (verbose)
+    {
+      printf("       %d bleus, %d blancs, %d rouges sur %d jours\n", calendar.counts.blue, calendar.counts.white,
+             calendar.counts.red, calendar.days);
+    }
+  }
+  printf("%d écart(s)\n", failures);
+  return failures == 0 ? 0 : 1;
+}
+
+// Fond et jauge de batterie tracés à chaque réveil, une colonne de pixels par trait
+static void drawFrameByPixels(FrameRaster &raster, int bars)
+{
+  raster.clear();
+  rasterizeLayout(raster, panelLayout, sizeof(panelLayout) / sizeof(panelLayout[0]));
+  for (int j = 0; j < bars; j++)
+  {
+    for (int i = 0; i < barWidth; i++)
+    {
+      int x = batteryTopLeftX + 2 + (j * (barWidth + 1)) + i;
+      raster.line(x, batteryTopLeftY + 2, x, batteryTopLeftY + 2 + barHeight);
+    }
+  }
+}
+
+// Fond précalculé copié d'un bloc, barres remplies par segments
+static void drawFrameFromBackground(FrameRaster &raster, int bars)
+{
+  raster.copy(panelBackground);
+  fillBatteryBars(raster, bars);
+}
+
+// Opérations d'écriture et durée du dessin des parties non textuelles de l'écran
+static int layout(bool verbose)
+{
+  int failures = 0;
+  FrameBitmap byPixels;
+  FrameBitmap fromBackground;
+  printf("%-20s %8s %8s %8s %10s\n", "tracé", "pixels", "segments", "octets", "us/image");
+  for (int bars = 0; bars <= nbBars; bars++)
+  {
+    const int runs = 20000;
+    FrameRaster old(byPixels.bytes);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++)
+    {
+      old.ops = {};
+      drawFrameByPixels(old, bars);
+    }
+    double oldMicros = microsSince(start, runs);
+
+    FrameRaster fast(fromBackground.bytes);
+    start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++)
+    {
+      fast.ops = {};
+      drawFrameFromBackground(fast, bars);
+    }
+    double fastMicros = microsSince(start, runs);
+
+    bool same = memcmp(byPixels.bytes, fromBackground.bytes, FRAME_BYTES) == 0;
+    failures += same ? 0 : 1;
+    if (verbose || bars == nbBars || !same)
+    {
+      char label[32];
+      snprintf(label, sizeof(label), "pixels, %d barres", bars);
+      printf("%-20s %8lu %8lu %8lu %10.2f\n", label, old.ops.pixels, old.ops.spans, old.ops.bytes, oldMicros);
+      snprintf(label, sizeof(label), "fond, %d barres", bars);
+      printf("%-20s %8lu %8lu %8lu %10.2f %s\n", label, fast.ops.pixels, fast.ops.spans, fast.ops.bytes, fastMicros,
+             same ? "identique" : "DIFFÉRENT");
+    }
+  }
+  printf("%d écart(s)\n", failures);
+  return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+  const char *mode = "bench";
+  const char *path = nullptr;
+  bool modeGiven = false;
+  int days = 7;
+  bool daysGiven = false;
+  bool verbose = false;
+  int granularity = 24 * 60;
+  double driftPpm = 20000;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-v") == 0)
+    {
+      verbose = true;
+    }
+    else if (strncmp(argv[i], "-g", 2) == 0)
+    {
+      granularity = atoi(argv[i] + 2);
+    }
+    else if (strncmp(argv[i], "-d", 2) == 0)
+    {
+      driftPpm = atof(argv[i] + 2);
+    }
+    else if (atoi(argv[i]) > 0)
+    {
+      days = atoi(argv[i]);
+      daysGiven = true;
+    }
+    else if (modeGiven)
+    {
+      path = argv[i];
+    }
+    else
+    {
+      mode = argv[i];
+      modeGiven = true;
+    }
+  }
+
+  if (strcmp(mode, "bench") == 0)
+  {
+    return bench(days, granularity, verbose);
+  }
+  if (strcmp(mode, "drift") == 0)
+  {
+    return drift(days, driftPpm, verbose);
+  }
+  if (strcmp(mode, "schedule") == 0)
+  {
+    return schedule(days, verbose);
+  }
+  if (strcmp(mode, "cycles") == 0)
+  {
+    return cycles(days, verbose);
+  }
+  if (strcmp(mode, "season") == 0)
+  {
+    return season(daysGiven ? days : 14, verbose);
+  }
+  if (strcmp(mode, "year") == 0)
+  {
+    return year(daysGiven ? days : 365, verbose);
+  }
+  if (strcmp(mode, "battery") == 0)
+  {
+    return battery(daysGiven ? days : 90, verbose);
+  }
+  if (strcmp(mode, "button") == 0)
+  {
+    return button(daysGiven ? days : 30, verbose);
+  }
+  if (strcmp(mode, "hub") == 0)
+  {
+    return hub(daysGiven ? days : 14, verbose);
+  }
+  if (strcmp(mode, "conditional") == 0)
+  {
+    return conditional(daysGiven ? days : 30, verbose);
+  }
+  if (strcmp(mode, "sources") == 0)
+  {
+    return sources(days, verbose);
+  }
+  if (strcmp(mode, "events") == 0)
+  {
+    return events(daysGiven ? days : 300, path, verbose);
+  }
+  if (strcmp(mode, "json") == 0)
+  {
+    return json(verbose);
+  }
+  if (strcmp(mode, "replay") == 0)
+  {
+    return replay(path, verbose);
+  }
+  if (strcmp(mode, "layout") == 0)
+  {
+    return layout(verbose);
+  }
+
+  fprintf(stderr, "mode inconnu : %s\n", mode);
+  return 1;
+}
+#endif
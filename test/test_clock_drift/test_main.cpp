@@ -0,0 +1,125 @@
+// Dérive de l'horloge RTC apprise sur plusieurs semaines : erreur bornée et NTP rare.
+//   pio test -e native -f test_clock_drift
+
+#include <math.h>
+#include <string.h>
+#include <unity.h>
+
+#include "ClockDrift.h"
+
+#define START 1761994800 // 1er novembre 2025, 11:00 UTC
+#define MAX_ERROR_SECONDS 30
+
+// Horloge RTC qui dérive de driftPpm, réveillée toutes les wakeHours heures réelles
+struct DriftRun
+{
+  int syncs;
+  int syncsLastWeek;
+  double maxError; // secondes, après correction, aux réveils sans NTP
+  ClockDrift drift;
+};
+
+static DriftRun run(double driftPpm, int days, int wakeHours, long maxAgeSeconds)
+{
+  DriftRun result = {};
+  memset(&result.drift, 0, sizeof(result.drift));
+  double d = driftPpm * 1e-6;
+  double trueTime = START;
+  double offset = 0; // avance de l'horloge RTC sur l'heure réelle
+  while (trueTime < START + days * 86400.0)
+  {
+    time_t rtcNow = (time_t)floor(trueTime + offset);
+    offset += clockDriftCorrection(result.drift, rtcNow);
+    rtcNow = (time_t)floor(trueTime + offset);
+    if (clockDriftNeedsSync(result.drift, rtcNow, MAX_ERROR_SECONDS, maxAgeSeconds))
+    {
+      clockDriftOnSync(result.drift, rtcNow, (time_t)trueTime);
+      offset = floor(trueTime) - trueTime;
+      result.syncs++;
+      result.syncsLastWeek += trueTime >= START + (days - 7) * 86400.0;
+    }
+    else if (fabs(offset) > result.maxError)
+    {
+      result.maxError = fabs(offset);
+    }
+    // Le timer de deep sleep compte sur l'horloge RTC
+    double realSeconds = clockDriftSleepSeconds(result.drift, (uint64_t)wakeHours * 3600) / (1 + d);
+    trueTime += realSeconds;
+    offset += realSeconds * d;
+  }
+  return result;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_unknown_drift_needs_sync()
+{
+  ClockDrift drift;
+  memset(&drift, 0, sizeof(drift));
+  TEST_ASSERT_TRUE(clockDriftNeedsSync(drift, START, MAX_ERROR_SECONDS, 86400));
+  TEST_ASSERT_EQUAL(0, clockDriftCorrection(drift, START));
+  TEST_ASSERT_EQUAL_UINT64(28800, clockDriftSleepSeconds(drift, 28800));
+
+  // Une seule synchro ne mesure rien : la suivante reste nécessaire
+  clockDriftOnSync(drift, START, START);
+  TEST_ASSERT_TRUE(clockDriftIsValid(drift));
+  TEST_ASSERT_TRUE(clockDriftNeedsSync(drift, START + 3600, MAX_ERROR_SECONDS, 86400));
+}
+
+static void test_second_sync_measures_drift()
+{
+  ClockDrift drift;
+  memset(&drift, 0, sizeof(drift));
+  clockDriftOnSync(drift, START, START);
+  // L'horloge a pris 864 s d'avance en un jour : 10000 ppm
+  clockDriftOnSync(drift, START + 86400 + 864, START + 86400);
+  TEST_ASSERT_FLOAT_WITHIN(1, 10000, drift.driftPpm);
+  TEST_ASSERT_EQUAL_UINT64(29088, clockDriftSleepSeconds(drift, 28800));
+  // Compensée au réveil suivant, huit heures plus tard
+  TEST_ASSERT_INT_WITHIN(1, -288, clockDriftCorrection(drift, START + 86400 + 28800 + 288));
+}
+
+static void test_fast_clock_over_four_weeks()
+{
+  DriftRun result = run(20000, 28, 8, 7 * 86400);
+  TEST_ASSERT_LESS_OR_EQUAL(MAX_ERROR_SECONDS, result.maxError);
+  // Dérive apprise : une synchro par semaine au plus, celle de l'âge maximal
+  TEST_ASSERT_FLOAT_WITHIN(50, 20000, result.drift.driftPpm);
+  TEST_ASSERT_LESS_OR_EQUAL(2, result.syncsLastWeek);
+}
+
+static void test_slow_quartz_skips_most_syncs()
+{
+  DriftRun result = run(-40, 28, 8, 86400);
+  TEST_ASSERT_LESS_OR_EQUAL(MAX_ERROR_SECONDS, result.maxError);
+  // Trois réveils par jour, une synchro par jour pour l'âge maximal
+  TEST_ASSERT_LESS_OR_EQUAL(8, result.syncsLastWeek);
+  TEST_ASSERT_LESS_OR_EQUAL(28 * 3 / 2, result.syncs);
+}
+
+static void test_damaged_state_forces_sync()
+{
+  DriftRun result = run(500, 7, 8, 7 * 86400);
+  ClockDrift drift = result.drift;
+  drift.driftPpm += 1;
+  TEST_ASSERT_FALSE(clockDriftIsValid(drift));
+  TEST_ASSERT_TRUE(clockDriftNeedsSync(drift, drift.lastSync + 60, MAX_ERROR_SECONDS, 7 * 86400));
+  TEST_ASSERT_EQUAL(0, clockDriftCorrection(drift, drift.lastSync + 86400));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_unknown_drift_needs_sync);
+  RUN_TEST(test_second_sync_measures_drift);
+  RUN_TEST(test_fast_clock_over_four_weeks);
+  RUN_TEST(test_slow_quartz_skips_most_syncs);
+  RUN_TEST(test_damaged_state_forces_sync);
+  return UNITY_END();
+}
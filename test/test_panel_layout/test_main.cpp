@@ -0,0 +1,64 @@
+// Fond de l'écran calculé à la compilation et jauge de batterie par segments :
+// mêmes pixels que le tracé trait par trait fait à chaque réveil auparavant.
+//   pio test -e native -f test_panel_layout
+
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "PanelLayout.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+static FrameBitmap byPixels;
+static FrameBitmap fromBackground;
+
+// Fond et jauge de batterie tracés à chaque réveil, une colonne de pixels par trait
+static void drawFrameByPixels(FrameRaster &raster, int bars)
+{
+  raster.clear();
+  rasterizeLayout(raster, panelLayout, sizeof(panelLayout) / sizeof(panelLayout[0]));
+  for (int j = 0; j < bars; j++)
+  {
+    for (int i = 0; i < barWidth; i++)
+    {
+      int x = batteryTopLeftX + 2 + (j * (barWidth + 1)) + i;
+      raster.line(x, batteryTopLeftY + 2, x, batteryTopLeftY + 2 + barHeight);
+    }
+  }
+}
+
+static void test_background_matches_pixel_drawing()
+{
+  for (int bars = 0; bars <= nbBars; bars++)
+  {
+    FrameRaster old(byPixels.bytes);
+    drawFrameByPixels(old, bars);
+    FrameRaster fast(fromBackground.bytes);
+    fast.copy(panelBackground);
+    fillBatteryBars(fast, bars);
+    TEST_ASSERT_EQUAL_MEMORY(byPixels.bytes, fromBackground.bytes, FRAME_BYTES);
+    // Une copie et quelques segments au lieu d'un trait par colonne
+    TEST_ASSERT_LESS_OR_EQUAL(old.ops.spans + old.ops.pixels, fast.ops.spans + fast.ops.pixels);
+  }
+}
+
+static void test_battery_bars_change_pixels()
+{
+  FrameRaster empty(byPixels.bytes);
+  empty.copy(panelBackground);
+  FrameRaster full(fromBackground.bytes);
+  full.copy(panelBackground);
+  fillBatteryBars(full, nbBars);
+  TEST_ASSERT_TRUE(memcmp(byPixels.bytes, fromBackground.bytes, FRAME_BYTES) != 0);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_background_matches_pixel_drawing);
+  RUN_TEST(test_battery_bars_change_pixels);
+  return UNITY_END();
+}
@@ -0,0 +1,308 @@
+// Cycle de réveil complet sur le matériel factice, en temps virtuel : les contrôles
+// des modes du programme natif, qui font échouer le build quand ils ne passent plus.
+//   pio test -e native -f test_simulation
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+
+#include "Simulation.h"
+#include "YearAudit.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+// Mode avec compte sur 14 jours, panne WiFi du jour 5 au jour 10 ou coupure de
+// courant au jour 10 : compteurs exacts une fois le réseau revenu
+static void run_season(int wifiDownFromDay, int wifiDownDays, int powerCutDay)
+{
+  const int days = 14;
+  Simulation simulation;
+  simulation.config.tempoSansCompte = false;
+  time_t epoch = simulationStart(simulation.config.timeZone);
+  simulation.world.wifiDownFrom = epoch + wifiDownFromDay * 86400;
+  simulation.world.wifiDownUntil = simulation.world.wifiDownFrom + wifiDownDays * 86400;
+  SimulationReport report;
+  if (powerCutDay > 0)
+  {
+    epoch = simulation.run(epoch, powerCutDay, false, report);
+    memset(&simulation.rtc, 0, sizeof(simulation.rtc));
+    simulation.world.rtcValid = false;
+    simulation.run(epoch, days - powerCutDay, false, report);
+  }
+  else
+  {
+    simulation.run(epoch, days, false, report);
+  }
+  TEST_ASSERT_TRUE(countsMatch(simulation, simulation.world.trueNow()));
+  // L'historique de saison évite de redemander tous les jours depuis septembre
+  TEST_ASSERT_GREATER_THAN(0, report.apiCalls);
+  TEST_ASSERT_LESS_THAN(8 * report.apiCalls, report.apiDays);
+}
+
+static void test_season_counts_exact_after_outages()
+{
+  run_season(0, 0, 0);
+  run_season(5, 5, 0);
+  run_season(0, 0, 10);
+}
+
+// Les deux API comptent les mêmes jours : jusqu'à demain une fois sa couleur publiée,
+// jusqu'à aujourd'hui avant. Compteurs relevés après chaque réveil servi par l'API.
+static std::vector<std::string> apiCounts(bool tempoSansCompte)
+{
+  Simulation simulation;
+  simulation.config.tempoSansCompte = tempoSansCompte;
+  TempoSource api = tempoSansCompte ? SOURCE_FREE : SOURCE_ACCOUNT;
+  std::vector<std::string> counts;
+  simulation.afterWake = [&](time_t)
+  {
+    if (cycleLogLast(simulation.rtc.cycles)->source != api)
+    {
+      return;
+    }
+    const TempoState &tempo = simulation.rtc.tempo;
+    TEST_ASSERT_TRUE(countsMatch(simulation, simulation.world.trueNow()));
+    char line[64];
+    snprintf(line, sizeof(line), "%d %s %d %d %d", (int)tempo.dateYmd, tempo.tomorrowColor, tempo.countBlue,
+             tempo.countWhite, tempo.countRed);
+    counts.push_back(line);
+  };
+  SimulationReport report;
+  simulation.run(simulationStart(simulation.config.timeZone), 14, false, report);
+  return counts;
+}
+
+static void test_both_apis_count_same_days()
+{
+  std::vector<std::string> free = apiCounts(true);
+  TEST_ASSERT_FALSE(free.empty());
+  TEST_ASSERT_TRUE(free == apiCounts(false));
+}
+
+// Saison entière, avec et sans compte, avec et sans pannes : aucun réveil hors
+// horaire, aucune date API fausse, aucune couleur fausse ni en retard
+static void run_year(bool tempoSansCompte, bool outages)
+{
+  Simulation simulation;
+  simulation.config.tempoSansCompte = tempoSansCompte;
+  time_t start = yearStart(simulation);
+  YearAudit audit(simulation, start, false);
+  SimulationReport report;
+  yearRun(simulation, audit, start, 365, outages, false, report);
+  for (int i = 0; i < ANOMALY_COUNT; i++)
+  {
+    TEST_ASSERT_EQUAL_MESSAGE(0, audit.counts[i], anomalyNames[i]);
+  }
+  TEST_ASSERT_GREATER_THAN(365 * 2, report.cycles);
+}
+
+static void test_year_without_anomalies()
+{
+  run_year(true, false);
+  run_year(false, false);
+  run_year(true, true);
+  run_year(false, true);
+}
+
+// Publication en fin de matinée, sur batterie normale ou faible, avec une horloge
+// RTC qui avance : la couleur du lendemain est reçue chaque jour
+static void test_late_publication_seen_every_day()
+{
+  for (int publishedMinute : {10 * 60 + 40, 11 * 60, 11 * 60 + 10})
+  {
+    for (int batteryRaw : {2400, 2100})
+    {
+      Simulation simulation;
+      simulation.world.tomorrowPublishedMinute = publishedMinute;
+      simulation.world.batteryRaw = batteryRaw;
+      simulation.world.rtcDriftPpm = 200;
+      SimulationReport report;
+      simulation.run(simulationStart(simulation.config.timeZone), 14, false, report);
+      TEST_ASSERT_EQUAL(0, report.daysWithoutTomorrow);
+    }
+  }
+}
+
+// Réveils programmés d'une simulation, appuis sur le bouton compris ou non
+static std::vector<time_t> timerWakes(int days, bool presses, SimulationReport &report)
+{
+  Simulation simulation;
+  time_t start = simulationStart(simulation.config.timeZone);
+  if (presses)
+  {
+    simulation.buttonPresses = buttonSchedule(start, days);
+  }
+  std::vector<time_t> wakes;
+  simulation.afterWake = [&](time_t wakeEpoch)
+  {
+    if (simulation.world.wakeCause == WAKE_CAUSE_TIMER)
+    {
+      wakes.push_back(wakeEpoch);
+    }
+  };
+  simulation.run(start, days, false, report);
+  return wakes;
+}
+
+static void test_button_keeps_timer_wakes()
+{
+  const int days = 30;
+  SimulationReport quiet;
+  SimulationReport pressed;
+  std::vector<time_t> reference = timerWakes(days, false, quiet);
+  std::vector<time_t> wakes = timerWakes(days, true, pressed);
+  TEST_ASSERT_GREATER_THAN(days * (BUTTON_PRESSES_PER_DAY - 1), pressed.buttonWakes);
+  // La plupart des appuis s'affichent depuis le cache, sans WiFi : seuls ceux
+  // d'avant la publication, le cache périmé, vont en ligne
+  TEST_ASSERT_LESS_THAN(pressed.buttonWakes / 4, pressed.buttonOnline);
+  // Les durées d'éveil différentes décalent les réveils de quelques secondes
+  TEST_ASSERT_EQUAL(reference.size(), wakes.size());
+  for (size_t i = 0; i < reference.size(); i++)
+  {
+    TEST_ASSERT_INT_WITHIN(WAKE_EARLY_TOLERANCE_SECONDS, reference[i], wakes[i]);
+  }
+}
+
+// Jour et contenu affichés à la fin de chaque réveil
+static std::vector<std::string> shownScreens(bool validators, int publishedMinute, SimulationReport &report)
+{
+  Simulation simulation;
+  simulation.world.apiValidators = validators;
+  simulation.world.tomorrowPublishedMinute = publishedMinute;
+  std::vector<std::string> screens;
+  simulation.afterWake = [&](time_t)
+  {
+    const char *content = simulation.panel.shownContent();
+    screens.push_back(std::string(simulation.panel.shownDay()) + " " + (content ? content : "(texte)"));
+  };
+  simulation.run(simulationStart(simulation.config.timeZone), 30, false, report);
+  return screens;
+}
+
+static void test_conditional_requests_show_same_screens()
+{
+  for (int publishedMinute : {7 * 60, 11 * 60})
+  {
+    SimulationReport plain;
+    SimulationReport conditional;
+    std::vector<std::string> reference = shownScreens(false, publishedMinute, plain);
+    TEST_ASSERT_TRUE(reference == shownScreens(true, publishedMinute, conditional));
+    TEST_ASSERT_GREATER_THAN(0, conditional.apiNotModified);
+    TEST_ASSERT_LESS_THAN(plain.apiBytes, conditional.apiBytes);
+  }
+}
+
+// Réglages par défaut : l'écran n'est alimenté que pour changer ce qu'il affiche,
+// et seulement les réveils où quelque chose change le rallument
+static void test_panel_powered_only_for_changes()
+{
+  Simulation simulation;
+  int wasted = 0;
+  simulation.afterWake = [&](time_t)
+  {
+    wasted += simulation.world.phaseMs[PHASE_PANEL_INIT] > 0 && simulation.world.panelUpdates == 0;
+  };
+  SimulationReport report;
+  simulation.run(simulationStart(simulation.config.timeZone), 14, false, report);
+  TEST_ASSERT_EQUAL(0, wasted);
+  TEST_ASSERT_LESS_THAN(report.cycles, report.panelUpdates);
+}
+
+// Course entre les deux API pendant deux jours où celle sans inscription ne répond
+// plus : la source abandonnée finit avant que le WiFi soit coupé ou que la carte dorme
+static void test_race_loser_finishes_before_disconnect()
+{
+  Simulation simulation;
+  simulation.config.bothApis = true;
+  simulation.config.raceSources = true;
+  time_t start = simulationStart(simulation.config.timeZone);
+  simulation.world.apiDownFrom = start + 24 * 3600;
+  simulation.world.apiDownUntil = simulation.world.apiDownFrom + 48 * 3600;
+  simulation.world.apiDownSources = 1u << SOURCE_FREE;
+  simulation.world.apiHangs = true;
+  SimulationReport report;
+  simulation.run(start, 7, false, report);
+  TEST_ASSERT_EQUAL(0, report.requestsCut);
+  TEST_ASSERT_EQUAL(0, report.failedWakes);
+  TEST_ASSERT_GREATER_THAN(0, report.sourceWakes[SOURCE_ACCOUNT]);
+}
+
+// Enregistrements comparés champ à champ, sans numéro, version ni CRC
+static bool sameEvent(const EventRecord &stored, EventRecord expected)
+{
+  expected.sequence = stored.sequence;
+  expected.version = stored.version;
+  expected.crc = stored.crc;
+  return memcmp(&stored, &expected, sizeof(stored)) == 0;
+}
+
+// Pannes, appuis et coupure de courant au milieu d'une écriture : le journal relu
+// est la fin de la suite des réveils, dans l'ordre, les plus anciens effacés
+static void test_event_log_survives_power_cut()
+{
+  const int days = 300;
+  Simulation simulation;
+  time_t start = simulationStart(simulation.config.timeZone);
+  simulation.buttonPresses = buttonSchedule(start, days);
+  simulation.world.wifiDownFrom = start + 3 * 86400 + 6 * 3600;
+  simulation.world.wifiDownUntil = simulation.world.wifiDownFrom + 10 * 3600;
+  simulation.world.apiDownFrom = start + 6 * 86400 + 5 * 3600;
+  simulation.world.apiDownUntil = simulation.world.apiDownFrom + 30 * 3600;
+  simulation.world.apiHangs = true;
+  std::vector<EventRecord> expected;
+  simulation.afterWake = [&](time_t)
+  {
+    EventRecord event;
+    eventRecordFromCycle(event, *cycleLogLast(simulation.rtc.cycles));
+    expected.push_back(event);
+  };
+
+  SimulationReport report;
+  time_t epoch = simulation.run(start, days / 2, false, report);
+  simulation.logFiles.tear(simulation.rtc.events.file, EVENT_RECORD_SIZE * 3 / 2);
+  expected.resize(expected.size() - 2);
+  memset(&simulation.rtc, 0, sizeof(simulation.rtc));
+  simulation.world.rtcValid = false;
+  simulation.run(epoch, days - days / 2, false, report);
+
+  std::vector<EventRecord> stored;
+  EventLogReader reader;
+  EventRecord event;
+  eventLogRewind(simulation.logFiles, simulation.rtc.events, reader);
+  while (eventLogNext(simulation.logFiles, reader, event))
+  {
+    stored.push_back(event);
+  }
+  TEST_ASSERT_GREATER_THAN(0, report.logErases);
+  TEST_ASSERT_FALSE(stored.empty());
+  TEST_ASSERT_LESS_THAN(expected.size(), stored.size());
+  TEST_ASSERT_LESS_OR_EQUAL(1, reader.skipped);
+  for (size_t i = 0; i < stored.size(); i++)
+  {
+    if (i > 0)
+    {
+      TEST_ASSERT_GREATER_THAN(stored[i - 1].sequence, stored[i].sequence);
+    }
+    TEST_ASSERT_TRUE(sameEvent(stored[i], expected[expected.size() - stored.size() + i]));
+  }
+}
+
+int main()
+{
+  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset();
+  UNITY_BEGIN();
+  RUN_TEST(test_season_counts_exact_after_outages);
+  RUN_TEST(test_both_apis_count_same_days);
+  RUN_TEST(test_year_without_anomalies);
+  RUN_TEST(test_late_publication_seen_every_day);
+  RUN_TEST(test_button_keeps_timer_wakes);
+  RUN_TEST(test_conditional_requests_show_same_screens);
+  RUN_TEST(test_panel_powered_only_for_changes);
+  RUN_TEST(test_race_loser_finishes_before_disconnect);
+  RUN_TEST(test_event_log_survives_power_cut);
+  return UNITY_END();
+}
@@ -0,0 +1,145 @@
+// Validité du cache Tempo en mémoire RTC : quand un réveil peut se passer du réseau.
+//   pio test -e native -f test_tempo_state
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+#include "TempoState.h"
+
+#define NOT_AVAILABLE "N/A"
+#define PUBLICATION_MINUTE (6 * 60 + 30)
+
+static struct tm localDate(int year, int month, int day, int hour, int minute)
+{
+  struct tm timeinfo = {};
+  timeinfo.tm_year = year - 1900;
+  timeinfo.tm_mon = month - 1;
+  timeinfo.tm_mday = day;
+  timeinfo.tm_hour = hour;
+  timeinfo.tm_min = minute;
+  timeinfo.tm_isdst = -1;
+  mktime(&timeinfo);
+  return timeinfo;
+}
+
+static TempoCacheStatus lookup(const TempoState &state, int year, int month, int day, int hour, int minute)
+{
+  return tempoStateLookup(state, localDate(year, month, day, hour, minute), PUBLICATION_MINUTE, NOT_AVAILABLE);
+}
+
+static TempoState stored(int dateYmd, const char *today, const char *tomorrow)
+{
+  TempoState state;
+  tempoStateStore(state, dateYmd, today, tomorrow, 40, 10, 3);
+  return state;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_today_with_tomorrow_is_fresh_all_day()
+{
+  TempoState state = stored(20251104, "BLEU", "BLANC");
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_FRESH, lookup(state, 2025, 11, 4, 0, 0));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_FRESH, lookup(state, 2025, 11, 4, 6, 30));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_FRESH, lookup(state, 2025, 11, 4, 23, 59));
+}
+
+static void test_tomorrow_unknown_is_fresh_until_publication()
+{
+  TempoState state = stored(20251104, "BLEU", NOT_AVAILABLE);
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_FRESH, lookup(state, 2025, 11, 4, 0, 0));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_FRESH, lookup(state, 2025, 11, 4, 6, 29));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 4, 6, 30));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 4, 23, 59));
+}
+
+static void test_yesterday_rolls_over_at_midnight_until_publication()
+{
+  TempoState state = stored(20251104, "BLEU", "ROUGE");
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_ROLLOVER, lookup(state, 2025, 11, 5, 0, 0));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_ROLLOVER, lookup(state, 2025, 11, 5, 6, 29));
+  // À partir de la publication, le nouveau demain est attendu : appel réseau
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 5, 6, 30));
+}
+
+static void test_yesterday_without_tomorrow_is_invalid()
+{
+  TempoState state = stored(20251104, "BLEU", NOT_AVAILABLE);
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 5, 0, 0));
+}
+
+static void test_older_than_yesterday_is_invalid()
+{
+  TempoState state = stored(20251104, "BLEU", "ROUGE");
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 6, 0, 0));
+  // Horloge revenue en arrière : le cache ne couvre pas ce jour
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 3, 12, 0));
+}
+
+static void test_rollover_across_month_year_and_dst()
+{
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_ROLLOVER, lookup(stored(20251130, "BLEU", "BLANC"), 2025, 12, 1, 0, 0));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_ROLLOVER, lookup(stored(20251231, "BLEU", "BLANC"), 2026, 1, 1, 0, 0));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_ROLLOVER, lookup(stored(20260228, "BLEU", "BLANC"), 2026, 3, 1, 0, 0));
+  // Nuits de 23 h et de 25 h
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_ROLLOVER, lookup(stored(20260328, "BLEU", "BLANC"), 2026, 3, 29, 0, 0));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_ROLLOVER, lookup(stored(20251025, "BLEU", "BLANC"), 2025, 10, 26, 0, 0));
+}
+
+static void test_roll_over_moves_tomorrow_to_today()
+{
+  TempoState state = stored(20251104, "BLEU", "ROUGE");
+  tempoStateRollOver(state, 20251105, NOT_AVAILABLE);
+  TEST_ASSERT_TRUE(tempoStateIsIntact(state));
+  TEST_ASSERT_EQUAL(20251105, state.dateYmd);
+  TEST_ASSERT_EQUAL_STRING("ROUGE", state.todayColor);
+  TEST_ASSERT_EQUAL_STRING(NOT_AVAILABLE, state.tomorrowColor);
+  TEST_ASSERT_EQUAL(40, state.countBlue);
+  TEST_ASSERT_EQUAL(10, state.countWhite);
+  TEST_ASSERT_EQUAL(3, state.countRed);
+  // Le même jour, le cache reste bon jusqu'à la publication
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_FRESH, lookup(state, 2025, 11, 5, 2, 0));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 5, 6, 30));
+}
+
+static void test_damaged_or_empty_state_is_invalid()
+{
+  TempoState state = stored(20251104, "BLEU", "BLANC");
+  state.countRed++;
+  TEST_ASSERT_FALSE(tempoStateIsIntact(state));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 4, 12, 0));
+
+  // Mémoire RTC remise à zéro par une mise sous tension
+  memset(&state, 0, sizeof(state));
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 4, 12, 0));
+
+  tempoStateInvalidate(state);
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(state, 2025, 11, 4, 12, 0));
+
+  // Couleur du jour jamais obtenue
+  TEST_ASSERT_EQUAL(TEMPO_CACHE_INVALID, lookup(stored(20251104, NOT_AVAILABLE, "BLANC"), 2025, 11, 4, 1, 0));
+}
+
+int main()
+{
+  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset();
+  UNITY_BEGIN();
+  RUN_TEST(test_today_with_tomorrow_is_fresh_all_day);
+  RUN_TEST(test_tomorrow_unknown_is_fresh_until_publication);
+  RUN_TEST(test_yesterday_rolls_over_at_midnight_until_publication);
+  RUN_TEST(test_yesterday_without_tomorrow_is_invalid);
+  RUN_TEST(test_older_than_yesterday_is_invalid);
+  RUN_TEST(test_rollover_across_month_year_and_dst);
+  RUN_TEST(test_roll_over_moves_tomorrow_to_today);
+  RUN_TEST(test_damaged_or_empty_state_is_invalid);
+  return UNITY_END();
+}
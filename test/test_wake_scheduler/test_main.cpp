@@ -0,0 +1,252 @@
+// Planificateur des réveils : horaires autour de la publication RTE, attente
+// après échec et réveils par jour selon des suites d'issues simulées.
+//   pio test -e native -f test_wake_scheduler
+
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+
+#include "WakeScheduler.h"
+
+// Mêmes réglages que le programme natif
+static const WakePolicy policy = {{6, 30}, {12, 0}, 90, 5, 60, 3600, 20, 2, 21};
+
+static time_t localTime(int year, int month, int day, int hour, int minute)
+{
+  struct tm timeinfo = {};
+  timeinfo.tm_year = year - 1900;
+  timeinfo.tm_mon = month - 1;
+  timeinfo.tm_mday = day;
+  timeinfo.tm_hour = hour;
+  timeinfo.tm_min = minute;
+  timeinfo.tm_isdst = -1;
+  return mktime(&timeinfo);
+}
+
+static WakeInputs inputs(time_t now, bool tomorrowKnown)
+{
+  WakeInputs result = {};
+  result.now = now;
+  result.todayKnown = true;
+  result.tomorrowKnown = tomorrowKnown;
+  return result;
+}
+
+static void assertWake(time_t expected, WakeReason reason, const WakeDecision &decision, time_t now)
+{
+  TEST_ASSERT_EQUAL(reason, decision.reason);
+  TEST_ASSERT_EQUAL(expected, decision.wakeAt);
+  TEST_ASSERT_EQUAL_UINT64((uint64_t)(expected - now), decision.sleepSeconds);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_tomorrow_known_sleeps_until_rollover()
+{
+  time_t now = localTime(2025, 11, 4, 7, 10);
+  assertWake(localTime(2025, 11, 5, 0, 5), WAKE_ROLLOVER, scheduleNextWake(policy, inputs(now, true)), now);
+  // Juste avant minuit, la bascule reste celle du lendemain et non celle d'après
+  now = localTime(2025, 11, 4, 23, 59);
+  assertWake(localTime(2025, 11, 5, 0, 5), WAKE_ROLLOVER, scheduleNextWake(policy, inputs(now, true)), now);
+}
+
+static void test_tomorrow_unknown_waits_for_publication_then_polls()
+{
+  time_t now = localTime(2025, 11, 5, 0, 5);
+  assertWake(localTime(2025, 11, 5, 6, 30), WAKE_PUBLICATION, scheduleNextWake(policy, inputs(now, false)), now);
+  now = localTime(2025, 11, 5, 6, 30);
+  assertWake(localTime(2025, 11, 5, 8, 0), WAKE_POLL, scheduleNextWake(policy, inputs(now, false)), now);
+  // Réveil un peu en avance : compte comme 06:30
+  now = localTime(2025, 11, 5, 6, 29);
+  assertWake(localTime(2025, 11, 5, 8, 0), WAKE_POLL, scheduleNextWake(policy, inputs(now, false)), now);
+  // Après le dernier essai de la grille, la fin de la fenêtre : après la publication
+  // officielle même si elle tarde un peu au-delà de 11:00
+  now = localTime(2025, 11, 5, 11, 0);
+  assertWake(localTime(2025, 11, 5, 12, 0), WAKE_POLL, scheduleNextWake(policy, inputs(now, false)), now);
+  now = localTime(2025, 11, 5, 10, 59);
+  assertWake(localTime(2025, 11, 5, 12, 0), WAKE_POLL, scheduleNextWake(policy, inputs(now, false)), now);
+}
+
+static void test_late_publication_keeps_polling()
+{
+  // Toujours rien à midi : essais espacés du double, puis le changement de jour
+  time_t now = localTime(2025, 11, 5, 11, 59);
+  assertWake(localTime(2025, 11, 5, 13, 30), WAKE_POLL, scheduleNextWake(policy, inputs(now, false)), now);
+  now = localTime(2025, 11, 5, 13, 30);
+  assertWake(localTime(2025, 11, 5, 16, 30), WAKE_POLL, scheduleNextWake(policy, inputs(now, false)), now);
+  now = localTime(2025, 11, 5, 16, 30);
+  assertWake(localTime(2025, 11, 5, 22, 30), WAKE_POLL, scheduleNextWake(policy, inputs(now, false)), now);
+  now = localTime(2025, 11, 5, 22, 30);
+  assertWake(localTime(2025, 11, 6, 0, 5), WAKE_ROLLOVER, scheduleNextWake(policy, inputs(now, false)), now);
+}
+
+static void test_low_battery_spaces_wakes()
+{
+  WakeInputs low = inputs(localTime(2025, 11, 5, 6, 30), false);
+  low.batteryLow = true;
+  assertWake(localTime(2025, 11, 5, 9, 30), WAKE_POLL, scheduleNextWake(policy, low), low.now);
+  // 12:30 serait hors de la fenêtre : sa fin reste essayée
+  low.now = localTime(2025, 11, 5, 9, 30);
+  assertWake(localTime(2025, 11, 5, 12, 0), WAKE_POLL, scheduleNextWake(policy, low), low.now);
+  low.now = localTime(2025, 11, 5, 12, 0);
+  assertWake(localTime(2025, 11, 5, 15, 0), WAKE_POLL, scheduleNextWake(policy, low), low.now);
+  low.now = localTime(2025, 11, 5, 6, 30);
+  low.tomorrowKnown = true;
+  assertWake(localTime(2025, 11, 6, 6, 30), WAKE_PUBLICATION, scheduleNextWake(policy, low), low.now);
+}
+
+static void test_retry_backs_off_with_jitter()
+{
+  for (uint32_t random = 0; random < 51; random++)
+  {
+    TEST_ASSERT_INT_WITHIN(15, 60, retryDelaySeconds(policy, 1, false, random));
+    TEST_ASSERT_INT_WITHIN(30, 120, retryDelaySeconds(policy, 2, false, random));
+    TEST_ASSERT_INT_WITHIN(900, 3600, retryDelaySeconds(policy, 20, false, random));
+    TEST_ASSERT_INT_WITHIN(60, 240, retryDelaySeconds(policy, 2, true, random));
+  }
+  // La gigue sépare des écrans en échec au même moment
+  TEST_ASSERT_TRUE(retryDelaySeconds(policy, 3, false, 0) != retryDelaySeconds(policy, 3, false, 50));
+}
+
+static void test_failure_keeps_regular_rhythm_when_today_is_shown()
+{
+  // Rien à l'écran : nouvel essai rapide
+  WakeInputs failed = inputs(localTime(2025, 11, 5, 8, 0), false);
+  failed.todayKnown = false;
+  failed.failures = 1;
+  WakeDecision decision = scheduleNextWake(policy, failed);
+  TEST_ASSERT_EQUAL(WAKE_RETRY, decision.reason);
+  TEST_ASSERT_INT_WITHIN(15, 60, decision.sleepSeconds);
+
+  // Couleur du jour affichée : l'essai suivant de la fenêtre suffit
+  failed.todayKnown = true;
+  assertWake(localTime(2025, 11, 5, 9, 30), WAKE_POLL, scheduleNextWake(policy, failed), failed.now);
+
+  // Mais jamais avant la fin de l'attente exponentielle
+  failed.failures = 12;
+  failed.now = localTime(2025, 11, 5, 9, 0);
+  decision = scheduleNextWake(policy, failed);
+  TEST_ASSERT_EQUAL(WAKE_RETRY, decision.reason);
+  TEST_ASSERT_INT_WITHIN(900, 3600, decision.sleepSeconds);
+
+  // Heure inconnue : seulement l'attente, sans heure de réveil
+  failed.now = 0;
+  decision = scheduleNextWake(policy, failed);
+  TEST_ASSERT_EQUAL(WAKE_RETRY, decision.reason);
+  TEST_ASSERT_EQUAL(0, decision.wakeAt);
+}
+
+static void test_dst_nights_keep_local_times()
+{
+  time_t now = localTime(2026, 3, 28, 20, 0);
+  assertWake(localTime(2026, 3, 29, 0, 5), WAKE_ROLLOVER, scheduleNextWake(policy, inputs(now, true)), now);
+  now = localTime(2026, 3, 29, 0, 5);
+  WakeDecision decision = scheduleNextWake(policy, inputs(now, false));
+  assertWake(localTime(2026, 3, 29, 6, 30), WAKE_PUBLICATION, decision, now);
+  TEST_ASSERT_EQUAL_UINT64(5 * 3600 + 25 * 60, decision.sleepSeconds); // nuit de 23 h
+  now = localTime(2025, 10, 26, 0, 5);
+  decision = scheduleNextWake(policy, inputs(now, false));
+  TEST_ASSERT_EQUAL_UINT64(7 * 3600 + 25 * 60, decision.sleepSeconds); // nuit de 25 h
+}
+
+// Réveils par jour sur days jours : demain publié à publishedMinute, API en
+// échec sur [failFrom, failUntil[ en heures depuis le début. missedDays : jours
+// finis sans la couleur du lendemain, s'il est donné.
+static double wakesPerDay(int publishedMinute, int days, int failFrom, int failUntil, bool batteryLow = false,
+                          int *missedDays = nullptr)
+{
+  time_t start = localTime(2025, 11, 1, 0, 5);
+  time_t now = start;
+  bool tomorrowKnown = false;
+  unsigned int failures = 0;
+  int wakes = 0;
+  int missed = 0;
+  int day = 0;
+  while (now < start + days * 86400)
+  {
+    wakes++;
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    // Premier réveil du jour : la veille a-t-elle vu la couleur de ce jour ?
+    missed += day != 0 && day != timeinfo.tm_mday && !tomorrowKnown;
+    day = timeinfo.tm_mday;
+    bool failing = now >= start + failFrom * 3600 && now < start + failUntil * 3600;
+    if (failing)
+    {
+      failures++;
+    }
+    else
+    {
+      failures = 0;
+      tomorrowKnown = timeinfo.tm_hour * 60 + timeinfo.tm_min >= publishedMinute;
+    }
+    WakeInputs wake = inputs(now, tomorrowKnown);
+    wake.failures = failures;
+    wake.batteryLow = batteryLow;
+    wake.random = (uint32_t)wakes * 7919;
+    WakeDecision decision = scheduleNextWake(policy, wake);
+    now += (time_t)decision.sleepSeconds;
+  }
+  if (missedDays != nullptr)
+  {
+    *missedDays = missed;
+  }
+  return (double)wakes / days;
+}
+
+static void test_wakes_per_day_under_outcome_sequences()
+{
+  // Publication à 7 h : bascule, ouverture de la fenêtre, un essai
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, 3.0, wakesPerDay(7 * 60, 14, 0, 0));
+  // Publication en fin de matinée, jusqu'à 11:00 : vue par le dernier essai de la grille
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, 5.0, wakesPerDay(10 * 60 + 40, 14, 0, 0));
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, 5.0, wakesPerDay(11 * 60, 14, 0, 0));
+  // Jamais publié : la fenêtre entière, puis les essais espacés de l'après-midi
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, 9.0, wakesPerDay(23 * 60, 14, 0, 0));
+  // Panne API de 36 h : l'attente exponentielle garde le surcoût borné
+  double outage = wakesPerDay(7 * 60, 14, 30, 66);
+  TEST_ASSERT_GREATER_THAN(3.0, outage);
+  TEST_ASSERT_LESS_THAN(5.0, outage);
+}
+
+// Publication juste après le dernier essai de la grille, batterie normale ou faible :
+// la couleur du lendemain est vue chaque jour, par l'essai de la fin de la fenêtre
+static void test_publication_after_11_is_seen_every_day()
+{
+  int missed = -1;
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, 6.0, wakesPerDay(11 * 60 + 10, 14, 0, 0, false, &missed));
+  TEST_ASSERT_EQUAL(0, missed);
+  TEST_ASSERT_DOUBLE_WITHIN(0.1, 2.0, wakesPerDay(7 * 60, 14, 0, 0, true, &missed));
+  TEST_ASSERT_EQUAL(0, missed);
+  // Sur batterie faible, les essais de 06:30 et 09:30 précèdent la publication
+  TEST_ASSERT_DOUBLE_WITHIN(0.1, 3.0, wakesPerDay(11 * 60, 14, 0, 0, true, &missed));
+  TEST_ASSERT_EQUAL(0, missed);
+  TEST_ASSERT_DOUBLE_WITHIN(0.1, 3.0, wakesPerDay(11 * 60 + 10, 14, 0, 0, true, &missed));
+  TEST_ASSERT_EQUAL(0, missed);
+  // Publication à 14:00 : vue par les essais de l'après-midi
+  wakesPerDay(14 * 60, 14, 0, 0, false, &missed);
+  TEST_ASSERT_EQUAL(0, missed);
+}
+
+int main()
+{
+  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset();
+  UNITY_BEGIN();
+  RUN_TEST(test_tomorrow_known_sleeps_until_rollover);
+  RUN_TEST(test_tomorrow_unknown_waits_for_publication_then_polls);
+  RUN_TEST(test_late_publication_keeps_polling);
+  RUN_TEST(test_low_battery_spaces_wakes);
+  RUN_TEST(test_retry_backs_off_with_jitter);
+  RUN_TEST(test_failure_keeps_regular_rhythm_when_today_is_shown);
+  RUN_TEST(test_dst_nights_keep_local_times);
+  RUN_TEST(test_wakes_per_day_under_outcome_sequences);
+  RUN_TEST(test_publication_after_11_is_seen_every_day);
+  return UNITY_END();
+}
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""Décode le journal d'événements en flash (include/EventLog.h) envoyé sur le port
+série par la commande 'e', et résume un ou plusieurs écrans.
+
+  python3 tools/event_log.py serie.log [autre_ecran.log ...] [--days 14] [--top 8]
+      un fichier par écran : les lignes "ev <hex>" y sont cherchées, le reste
+      du journal série est ignoré. Un même enregistrement envoyé deux fois
+      (deux commandes 'e') n'est compté qu'une fois.
+
+Affiche par jour les réveils, échecs, temps éveillé, octets reçus et sommeil
+programmé (plus de 24 h quand le bouton écourte des sommeils), puis des
+histogrammes (codes HTTP, durées d'éveil, sommeil, causes, sources, WiFi, NTP)
+et les issues de réveil qui coûtent le plus de temps éveillé sur l'ensemble du
+parc. Le programme natif produit un journal de test :
+  .pio/build/native/program events /tmp/ev.txt && python3 tools/event_log.py /tmp/ev.txt
+"""
+
+import argparse
+import collections
+import datetime
+import re
+import struct
+import sys
+import zlib
+
+# Même disposition que EventRecord, petit-boutiste
+RECORD = struct.Struct("<IIII4hHHBBBBBBBBI")
+RECORD_VERSION = 1
+LINE = re.compile(r"\bev ([0-9a-f]{%d})\b" % (2 * RECORD.size))
+
+# Noms des énumérations du firmware, dans l'ordre de leurs valeurs
+WAKE_CAUSES = ["mise sous tension", "programmé", "bouton"]
+WAKE_REASONS = ["changement de jour", "publication RTE", "nouvel essai", "après échec"]
+SOURCES = ["hub", "compte", "libre", "cache", "aucune"]
+NTP = ["sans WiFi", "pas nécessaire", "synchronisé", "échec"]
+WIFI_FAILED = 0xFF
+WIFI = ["pas tenté", "scan complet", "point d'accès connu", "IP connue"]
+
+
+class Event:
+    def __init__(self, screen, raw):
+        (self.sequence, self.wake_time, self.api_bytes, self.sleep_seconds, c0, c1, c2, c3,
+         self.awake_ms, self.battery_mv, self.version, self.wake_cause, self.failures, self.ntp,
+         self.wifi, self.source, self.next_wake, _reserved, self.crc) = RECORD.unpack(raw)
+        self.screen = screen
+        self.http_codes = (c0, c1, c2, c3)
+
+    def day(self):
+        if self.wake_time == 0:
+            return "heure inconnue"
+        return datetime.datetime.fromtimestamp(self.wake_time).strftime("%Y-%m-%d")
+
+    def failed(self):
+        """Réveil terminé sur un échec, même si l'écran a gardé les couleurs du cache"""
+        return self.failures > 0
+
+    def wifi_name(self):
+        if self.wifi == WIFI_FAILED:
+            return "échec"
+        return name(WIFI, self.wifi)
+
+    def outcome(self):
+        """Issue du réveil, regroupée sur tout le parc"""
+        codes = "/".join(str(code) for code in self.http_codes if code != 0) or "-"
+        return "WiFi %s, NTP %s, source %s, codes %s" % (
+            self.wifi_name(), name(NTP, self.ntp), name(SOURCES, self.source), codes)
+
+
+def name(names, value):
+    return names[value] if value < len(names) else "?%d" % value
+
+
+def read_screen(path, screen):
+    """Enregistrements valides du fichier, par séquence, et nombre de lignes rejetées"""
+    events = {}
+    rejected = 0
+    with open(path, encoding="utf-8", errors="replace") as log:
+        for line in log:
+            match = LINE.search(line)
+            if not match:
+                continue
+            raw = bytes.fromhex(match.group(1))
+            event = Event(screen, raw)
+            if event.version != RECORD_VERSION or zlib.crc32(raw[:-4]) != event.crc:
+                rejected += 1
+                continue
+            events[event.sequence] = event
+    return [events[sequence] for sequence in sorted(events)], rejected
+
+
+def histogram(title, counter, order=None, width=40):
+    print("\n%s" % title)
+    if not counter:
+        print("  (vide)")
+        return
+    keys = order if order is not None else sorted(counter, key=lambda key: -counter[key])
+    largest = max(counter.values())
+    for key in keys:
+        count = counter.get(key, 0)
+        if count == 0 and order is None:
+            continue
+        bar = "#" * max(1 if count else 0, round(count * width / largest))
+        print("  %-22s %6d %s" % (key, count, bar))
+
+
+def bucket(value, limits, unit):
+    """Tranche "< limite" de value, la dernière ouverte"""
+    for limit in limits:
+        if value < limit:
+            return "< %s %s" % (limit, unit)
+    return ">= %s %s" % (limits[-1], unit)
+
+
+AWAKE_LIMITS = [1000, 2000, 3000, 5000, 8000, 15000, 30000]
+SLEEP_LIMITS = [60, 600, 3600, 6 * 3600, 12 * 3600, 24 * 3600]
+
+
+def labels(limits, unit):
+    return ["< %s %s" % (limit, unit) for limit in limits] + [">= %s %s" % (limits[-1], unit)]
+
+
+def daily_summary(events, days):
+    by_day = collections.defaultdict(list)
+    for event in events:
+        by_day[event.day()].append(event)
+    print("%-14s %6s %7s %7s %9s %9s %9s %8s %7s" % (
+        "jour", "écrans", "réveils", "échecs", "éveil s", "éveil moy", "octets", "prévu h", "mV moy"))
+    for day in sorted(by_day)[-days:] if days else sorted(by_day):
+        wakes = by_day[day]
+        awake = sum(event.awake_ms for event in wakes) / 1000
+        battery = [event.battery_mv for event in wakes if event.battery_mv]
+        print("%-14s %6d %7d %7d %9.1f %9.2f %9d %8.1f %7s" % (
+            day, len({event.screen for event in wakes}), len(wakes), sum(event.failed() for event in wakes),
+            awake, awake / len(wakes), sum(event.api_bytes for event in wakes),
+            sum(event.sleep_seconds for event in wakes) / 3600,
+            "%.0f" % (sum(battery) / len(battery)) if battery else "-"))
+
+
+def costly_outcomes(events, top):
+    awake = collections.Counter()
+    count = collections.Counter()
+    for event in events:
+        awake[event.outcome()] += event.awake_ms
+        count[event.outcome()] += 1
+    total = sum(awake.values()) or 1
+    print("\nissues les plus coûteuses (temps éveillé sur tout le parc)")
+    print("  %8s %7s %8s %6s  %s" % ("éveil s", "part", "réveils", "moy s", "issue"))
+    for outcome, ms in awake.most_common(top):
+        print("  %8.1f %6.1f%% %8d %6.2f  %s" % (
+            ms / 1000, 100 * ms / total, count[outcome], ms / 1000 / count[outcome], outcome))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("logs", nargs="+", help="journal série d'un écran, un fichier par écran")
+    parser.add_argument("--days", type=int, default=14, help="derniers jours du résumé quotidien, 0 : tous")
+    parser.add_argument("--top", type=int, default=8, help="issues coûteuses affichées")
+    args = parser.parse_args()
+
+    events = []
+    for screen, path in enumerate(args.logs):
+        screen_events, rejected = read_screen(path, screen)
+        gaps = sum(1 for before, after in zip(screen_events, screen_events[1:])
+                   if after.sequence != before.sequence + 1)
+        print("%s : %d enregistrements, %d rejetés (CRC ou version), %d trous dans la séquence" % (
+            path, len(screen_events), rejected, gaps))
+        events.extend(screen_events)
+    if not events:
+        print("aucun enregistrement \"ev\" trouvé")
+        return 1
+
+    print()
+    daily_summary(events, args.days)
+    histogram("codes HTTP (premiers codes de la dernière source interrogée)",
+              collections.Counter(code for event in events for code in event.http_codes if code != 0))
+    histogram("durée d'éveil", collections.Counter(bucket(event.awake_ms, AWAKE_LIMITS, "ms") for event in events),
+              labels(AWAKE_LIMITS, "ms"))
+    histogram("sommeil programmé",
+              collections.Counter(bucket(event.sleep_seconds, SLEEP_LIMITS, "s") for event in events),
+              labels(SLEEP_LIMITS, "s"))
+    histogram("échecs consécutifs en fin de réveil", collections.Counter(event.failures for event in events),
+              sorted({event.failures for event in events}))
+    histogram("cause du réveil", collections.Counter(name(WAKE_CAUSES, event.wake_cause) for event in events))
+    histogram("réveil suivant", collections.Counter(name(WAKE_REASONS, event.next_wake) for event in events))
+    histogram("source des couleurs", collections.Counter(name(SOURCES, event.source) for event in events))
+    histogram("WiFi", collections.Counter(event.wifi_name() for event in events))
+    histogram("NTP", collections.Counter(name(NTP, event.ntp) for event in events))
+    costly_outcomes(events, args.top)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Écran hub simulé sur un PC, et client pour interroger un vrai hub.
+
+Le hub sert en HTTP simple une ligne de texte (include/TempoHub.h) :
+  tempo 1 <AAAAMMJJ> <couleur du jour> <couleur de demain> <bleus> <blancs> <rouges>
+
+  python3 tools/hub_standin.py serve [--port 8080] [--publish-hour 7] [--delay 0]
+      à indiquer dans adresseHub (TOCUSTOMIZE.h) avec HUB_PORT = 8080 dans
+      main.cpp : chaque requête d'un écran client est affichée. --down N coupe
+      le hub pendant les N premières secondes pour voir le repli sur l'API.
+  python3 tools/hub_standin.py get HOTE[:PORT]
+      interroge un hub (écran ou stand-in), vérifie la ligne et mesure le
+      temps de réponse, comme le fait un écran client.
+
+Les couleurs suivent la même répartition que rte_standin.py et le monde simulé
+du programme natif. --not-available doit valoir le DAY_NOT_AVAILABLE de la
+librairie TempoLikeSupplyContractAPI.
+"""
+
+import argparse
+import datetime
+import http.client
+import http.server
+import re
+import sys
+import time
+
+HUB_PATH = "/tempo"
+HUB_VERSION = 1
+# Même délai que HUB_TIMEOUT_MS de WakeCycle.cpp
+CLIENT_TIMEOUT = 1.5
+
+FRENCH = {"BLUE": "BLEU", "WHITE": "BLANC", "RED": "ROUGE"}
+LINE = re.compile(r"^tempo (\d+) (\d{8}) (\S+) (\S+) (\d+) (\d+) (\d+)\n?$")
+
+
+def color_for_day(day):
+    # Même répartition que rte_standin.py : surtout du bleu
+    index = day.toordinal()
+    if day.month in (11, 12, 1, 2, 3) and day.weekday() < 5 and index % 7 == 3:
+        return "RED"
+    if index % 5 == 1:
+        return "WHITE"
+    return "BLUE"
+
+
+def season_start(day):
+    year = day.year if day.month >= 9 else day.year - 1
+    return datetime.date(year, 9, 1)
+
+
+def hub_line(now, publish_hour, not_available):
+    today = now.date()
+    tomorrow = FRENCH[color_for_day(today + datetime.timedelta(days=1))] if now.hour >= publish_hour else not_available
+    counts = {"BLUE": 0, "WHITE": 0, "RED": 0}
+    day = season_start(today)
+    while day <= today:
+        counts[color_for_day(day)] += 1
+        day += datetime.timedelta(days=1)
+    return "tempo %d %s %s %s %d %d %d\n" % (HUB_VERSION, today.strftime("%Y%m%d"), FRENCH[color_for_day(today)],
+                                             tomorrow, counts["BLUE"], counts["WHITE"], counts["RED"])
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    def log_message(self, format, *args):
+        pass
+
+    def reply(self, code, body=b""):
+        self.send_response(code)
+        self.send_header("Content-Type", "text/plain")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_GET(self):
+        args = self.server.args
+        if time.monotonic() - self.server.started < args.down:
+            # Hub en plein réveil : la requête reste sans réponse jusqu'au délai du client
+            time.sleep(CLIENT_TIMEOUT + 0.5)
+            return
+        if self.path != HUB_PATH:
+            self.reply(404)
+            print("%s %s : 404" % (self.client_address[0], self.path))
+            return
+        time.sleep(args.delay / 1000.0)
+        line = hub_line(datetime.datetime.now(), args.publish_hour, args.not_available)
+        self.reply(200, line.encode())
+        print("%s : %s" % (self.client_address[0], line.strip()))
+
+
+def serve(args):
+    server = http.server.ThreadingHTTPServer(("", args.port), Handler)
+    server.args = args
+    server.started = time.monotonic()
+    print("Hub simulé sur le port %d, Ctrl-C pour arrêter" % args.port)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    server.server_close()
+
+
+def get(address):
+    host, _, port = address.partition(":")
+    connection = http.client.HTTPConnection(host, int(port or 80), timeout=CLIENT_TIMEOUT)
+    start = time.monotonic()
+    try:
+        connection.request("GET", HUB_PATH)
+        response = connection.getresponse()
+        body = response.read().decode()
+    except OSError as error:
+        print("hub injoignable après %.0f ms : %s" % ((time.monotonic() - start) * 1000, error))
+        return 1
+    elapsed = (time.monotonic() - start) * 1000
+    if response.status != 200:
+        print("statut %d en %.0f ms" % (response.status, elapsed))
+        return 1
+    match = LINE.match(body)
+    if not match or int(match.group(1)) != HUB_VERSION:
+        print("ligne illisible en %.0f ms : %r" % (elapsed, body))
+        return 1
+    today = datetime.date.today().strftime("%Y%m%d")
+    print("%s en %.0f ms%s" % (body.strip(), elapsed, "" if match.group(2) == today else " (pas la date du jour)"))
+    return 0 if match.group(2) == today else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=["serve", "get"])
+    parser.add_argument("address", nargs="?", help="get : HOTE[:PORT] du hub")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--publish-hour", type=int, default=7, help="heure de publication de demain")
+    parser.add_argument("--not-available", default="N/A", help="couleur de demain avant sa publication")
+    parser.add_argument("--delay", type=float, default=0, help="temps de réponse ajouté en ms")
+    parser.add_argument("--down", type=float, default=0, help="secondes sans réponse au démarrage")
+    args = parser.parse_args()
+
+    if args.mode == "get":
+        if not args.address:
+            parser.error("get attend l'adresse du hub")
+        return get(args.address)
+    serve(args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
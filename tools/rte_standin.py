@@ -0,0 +1,534 @@
+#!/usr/bin/env python3
+"""Serveur HTTPS local qui imite l'API RTE avec compte (jeton OAuth et calendrier
+Tempo) et l'API sans inscription (jours et saison, avec ETag, Last-Modified et
+réponses 304), pour compter les poignées de main TLS et mesurer les échanges
+sans dépendre du service RTE.
+
+  python3 tools/rte_standin.py serve [--port 8443] [--rtt 40] [--replay DIR]
+      à indiquer dans rteApiHost / rteApiPort de main.cpp : chaque connexion
+      et chaque requête de la carte sont affichées.
+  python3 tools/rte_standin.py bench [--rtt 40] [--replay DIR]
+      compare sur le PC une connexion par requête (la librairie) avec une
+      connexion gardée ouverte (RteClient), avec et sans jeton en cache, puis
+      l'API sans inscription avec et sans requêtes conditionnelles.
+  python3 tools/rte_standin.py capture serie.log DIR
+      découpe le journal série d'une carte compilée avec DEBUG_API en un
+      fichier par échange, rejoué par --replay et par le mode replay du
+      programme natif.
+
+--rtt simule la latence du réseau : deux allers-retours par poignée de main
+TLS 1.2, un par requête. --fail-rate, --fail-code et --truncate injectent des
+erreurs HTTP et des réponses coupées en cours de route. --no-validators retire
+ETag et Last-Modified des réponses sans inscription, comme un serveur qui n'en
+donne pas. --free-delay et --free-down ralentissent ou coupent la seule API sans
+inscription : avec un compte renseigné, la carte doit passer à l'autre API
+(lancée en parallèle au-delà de deux fois le temps de réponse habituel).
+"""
+
+import argparse
+import datetime
+import email.utils
+import hashlib
+import http.client
+import http.server
+import json
+import glob
+import os
+import random
+import re
+import secrets
+import ssl
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import urllib.parse
+
+TOKEN_URI = "/token/oauth/"
+CALENDAR_URI = "/open_api/tempo_like_supply_contract/v1/tempo_like_calendars"
+# API sans inscription, mêmes chemins que RTE_FREE_*_URI de RteClient.cpp
+FREE_DAYS_URI = "/cms/open_data/v1/tempoLight"
+FREE_SEASON_URI = "/cms/open_data/v1/tempo"
+TOKEN_LIFETIME = 7200
+TIMEZONE = datetime.timezone(datetime.timedelta(hours=1))
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.handshakes = 0
+        self.resumed = 0
+        self.requests = 0
+        self.not_modified = 0
+
+    def snapshot(self):
+        with self.lock:
+            return self.handshakes, self.resumed, self.requests
+
+
+def read_recording(path):
+    """En-têtes "clé: valeur" jusqu'à la ligne vide, puis le corps tel quel."""
+    with open(path, "rb") as f:
+        data = f.read()
+    head, _, body = data.partition(b"\n\n")
+    fields = {}
+    for line in head.decode().splitlines():
+        key, _, value = line.partition(": ")
+        fields[key] = value
+    method, _, uri = fields["requete"].partition(" ")
+    return {"method": method, "uri": uri, "status": int(fields["statut"]),
+            "expected": fields.get("attendu"), "body": body, "name": os.path.basename(path)}
+
+
+def load_recordings(directory):
+    recordings = {}
+    for path in sorted(glob.glob(os.path.join(directory, "*.http"))):
+        recording = read_recording(path)
+        key = (recording["method"], urllib.parse.urlsplit(recording["uri"]).path)
+        recordings.setdefault(key, []).append(recording)
+    return recordings
+
+
+def capture(log_path, directory):
+    """Journal série -> un fichier .http par échange ">>> ... <<< fin"."""
+    with open(log_path, "rb") as f:
+        log = f.read()
+    os.makedirs(directory, exist_ok=True)
+    pattern = re.compile(rb">>> (\w+) (\S+)\r?\n<<< (-?\d+)\r?\n(.*?)(?:\n<<< attendu ([^\r\n]*))?\r?\n<<< fin", re.S)
+    count = 0
+    for match in pattern.finditer(log):
+        method, uri, status, body, expected = match.groups()
+        # Le jeton ne doit pas se retrouver dans un fichier partagé
+        body = re.sub(rb'"access_token"\s*:\s*"[^"]*"', b'"access_token":"masque"', body)
+        count += 1
+        kind = "token" if uri.decode().startswith(TOKEN_URI) else \
+            "calendrier" if uri.decode().startswith(CALENDAR_URI) else "sans-compte"
+        path = os.path.join(directory, "%03d-%s.http" % (count, kind))
+        with open(path, "wb") as f:
+            f.write(b"requete: %s %s\nstatut: %s\n" % (method, uri, status))
+            if expected:
+                f.write(b"attendu: %s\n" % expected)
+            f.write(b"\n" + body)
+        print(path)
+    print("%d échanges enregistrés" % count)
+
+
+def color_for_day(day):
+    # Même répartition que le monde simulé du programme natif : surtout du bleu
+    index = day.toordinal()
+    if day.month in (11, 12, 1, 2, 3) and day.weekday() < 5 and index % 7 == 3:
+        return "RED"
+    if index % 5 == 1:
+        return "WHITE"
+    return "BLUE"
+
+
+def parse_date(text):
+    return datetime.date.fromisoformat(text[:10])
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive tant que le client ne ferme pas
+
+    def setup(self):
+        super().setup()
+        server = self.server
+        self.connection.do_handshake()
+        time.sleep(2 * server.rtt)
+        reused = self.connection.session_reused
+        with server.stats.lock:
+            server.stats.handshakes += 1
+            server.stats.resumed += reused
+            number = server.stats.handshakes
+        self.requests_here = 0
+        if server.verbose:
+            print("connexion %d depuis %s%s" % (number, self.client_address[0],
+                                                 ", session TLS reprise" if reused else ""))
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            sys.stdout.write("  %s\n" % (format % args))
+
+    def reply(self, code, payload):
+        self.send_body(code, payload if isinstance(payload, bytes) else json.dumps(payload).encode())
+
+    def send_body(self, code, body, headers=()):
+        server = self.server
+        truncated = server.random.random() < server.truncate
+        self.send_response(code)
+        for key, value in headers:
+            self.send_header(key, value)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if truncated:
+            # Coupure en cours de réponse : la moitié du corps puis fermeture
+            self.wfile.write(body[:len(body) // 2])
+            self.wfile.flush()
+            self.close_connection = True
+            if server.verbose:
+                print("  réponse coupée après %d octets" % (len(body) // 2))
+        else:
+            self.wfile.write(body)
+
+    def count_request(self):
+        time.sleep(self.server.rtt)
+        self.requests_here += 1
+        with self.server.stats.lock:
+            self.server.stats.requests += 1
+
+    def injected_failure(self):
+        server = self.server
+        if server.random.random() < server.fail_rate:
+            self.reply(server.fail_code, {"error": "injected", "error_description": "erreur simulée"})
+            return True
+        return False
+
+    def replayed(self, method):
+        """Réponse enregistrée : même requête si possible, sinon la suivante du même chemin."""
+        candidates = self.server.recordings.get((method, urllib.parse.urlsplit(self.path).path))
+        if not candidates:
+            return False
+        exact = [r for r in candidates if r["uri"] == self.path]
+        if exact:
+            recording = exact[0]
+        else:
+            with self.server.stats.lock:
+                recording = candidates[self.server.replay_index % len(candidates)]
+                self.server.replay_index += 1
+        if self.server.verbose:
+            print("  rejoue %s" % recording["name"])
+        if method == "POST" and recording["status"] == 200:
+            # Les jetons enregistrés ne sont pas ceux que ce serveur accepte
+            token = secrets.token_urlsafe(40)
+            self.server.tokens.add(token)
+            self.reply(200, {"access_token": token, "token_type": "Bearer", "expires_in": TOKEN_LIFETIME})
+        else:
+            self.send_body(recording["status"], recording["body"])
+        return True
+
+    def do_POST(self):
+        self.count_request()
+        length = int(self.headers.get("Content-Length", 0))
+        self.rfile.read(length)
+        if self.injected_failure() or self.replayed("POST"):
+            return
+        if self.path != TOKEN_URI:
+            return self.reply(404, {"error": "not_found"})
+        if not self.headers.get("Authorization", "").startswith("Basic "):
+            return self.reply(401, {"error": "invalid_client"})
+        token = secrets.token_urlsafe(40)
+        self.server.tokens.add(token)
+        self.reply(200, {"access_token": token, "token_type": "Bearer", "expires_in": TOKEN_LIFETIME})
+
+    def last_day(self):
+        # Demain n'est connu qu'après la publication
+        now = datetime.datetime.now(TIMEZONE)
+        return now, now.date() + datetime.timedelta(days=1 if now.hour >= self.server.publish_hour else 0)
+
+    def free_values(self, url):
+        """Jours et couleurs de la réponse sans inscription, None si la requête est invalide."""
+        now, last = self.last_day()
+        if url.path == FREE_DAYS_URI:
+            first = now.date()
+        else:
+            season = urllib.parse.parse_qs(url.query).get("season", [""])[0]
+            if not re.fullmatch(r"\d{4}-\d{4}", season):
+                return None
+            first = datetime.date(int(season[:4]), 9, 1)
+            last = min(last, datetime.date(int(season[:4]) + 1, 8, 31))
+        values = {}
+        day = first
+        while day <= last:
+            values[day.isoformat()] = color_for_day(day)
+            day += datetime.timedelta(days=1)
+        return values
+
+    def reply_free(self, url):
+        values = self.free_values(url)
+        if values is None:
+            return self.reply(400, {"error": "season"})
+        body = json.dumps({"values": values}, separators=(",", ":")).encode()
+        if self.server.no_validators:
+            return self.send_body(200, body)
+        # Le contenu change à minuit et à la publication de demain
+        now, last = self.last_day()
+        changed = datetime.datetime.combine(now.date(), datetime.time(
+            self.server.publish_hour if last > now.date() else 0), TIMEZONE)
+        validators = (("ETag", '"%s"' % hashlib.sha1(body).hexdigest()[:16]),
+                      ("Last-Modified", email.utils.format_datetime(changed.astimezone(datetime.timezone.utc),
+                                                                    usegmt=True)))
+        since = self.headers.get("If-Modified-Since")
+        match = self.headers.get("If-None-Match")
+        try:
+            fresh = match == validators[0][1] if match else \
+                since is not None and email.utils.parsedate_to_datetime(since) >= changed
+        except (TypeError, ValueError):
+            fresh = False
+        if fresh:
+            with self.server.stats.lock:
+                self.server.stats.not_modified += 1
+            self.send_response(304)
+            for key, value in validators:
+                self.send_header(key, value)
+            self.end_headers()
+            return
+        self.send_body(200, body, validators)
+
+    def do_GET(self):
+        self.count_request()
+        url = urllib.parse.urlsplit(self.path)
+        if url.path in (FREE_DAYS_URI, FREE_SEASON_URI):
+            time.sleep(self.server.free_delay)
+            if self.server.free_down:
+                return self.reply(self.server.fail_code, {"error": "down", "error_description": "panne simulée"})
+            if self.injected_failure() or self.replayed("GET"):
+                return
+            return self.reply_free(url)
+        if url.path != CALENDAR_URI:
+            return self.reply(404, {"error": "not_found"})
+        authorization = self.headers.get("Authorization", "")
+        if authorization[len("Bearer "):] not in self.server.tokens:
+            return self.reply(401, {"error": "invalid_token"})
+        if self.injected_failure() or self.replayed("GET"):
+            return
+        query = urllib.parse.parse_qs(url.query)
+        try:
+            start = parse_date(query["start_date"][0])
+            end = parse_date(query["end_date"][0])
+        except (KeyError, ValueError):
+            return self.reply(400, {"error": "TMPLIKSUPCON_TMPLIKCAL_F01"})
+
+        now, last = self.last_day()
+        values = []
+        day = start
+        while day < end and day <= last:
+            following = day + datetime.timedelta(days=1)
+            values.append({
+                "start_date": day.isoformat() + "T00:00:00+01:00",
+                "end_date": following.isoformat() + "T00:00:00+01:00",
+                "value": color_for_day(day),
+                "updated_date": day.isoformat() + "T10:20:00+01:00",
+            })
+            day = following
+        values.reverse()  # RTE renvoie les jours les plus récents en premier
+        self.reply(200, {"tempo_like_calendars": {
+            "start_date": query["start_date"][0], "end_date": query["end_date"][0], "values": values}})
+
+
+class StandinServer(http.server.ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, address, context, args, verbose):
+        super().__init__(address, Handler)
+        # La poignée de main est faite dans le fil de la connexion, pas dans accept()
+        self.socket = context.wrap_socket(self.socket, server_side=True, do_handshake_on_connect=False)
+        self.rtt = args.rtt / 1000
+        self.publish_hour = args.publish_hour
+        self.fail_rate = args.fail_rate
+        self.fail_code = args.fail_code
+        self.truncate = args.truncate
+        self.no_validators = args.no_validators
+        self.free_delay = args.free_delay / 1000
+        self.free_down = args.free_down
+        self.random = random.Random(args.seed)
+        self.recordings = load_recordings(args.replay) if args.replay else {}
+        self.replay_index = 0
+        self.verbose = verbose
+        self.stats = Stats()
+        self.tokens = set()
+
+
+def make_certificate(directory):
+    cert = os.path.join(directory, "standin.pem")
+    key = os.path.join(directory, "standin.key")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "30",
+                    "-subj", "/CN=rte-standin", "-keyout", key, "-out", cert],
+                   check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return cert, key
+
+
+def start_server(args, verbose, directory):
+    cert, key = make_certificate(directory)
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.minimum_version = ssl.TLSVersion.TLSv1_2
+    context.load_cert_chain(cert, key)
+    server = StandinServer(("0.0.0.0", args.port), context, args, verbose)
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    return server
+
+
+class Client:
+    """Requêtes de la carte rejouées depuis le PC."""
+
+    def __init__(self, port):
+        self.port = port
+        self.context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+        self.context.check_hostname = False
+        self.context.verify_mode = ssl.CERT_NONE
+        self.connection = None
+        self.received = 0  # octets de corps reçus
+        self.validators = {}  # requêtes conditionnelles : chemin -> ETag
+
+    def request(self, method, uri, authorization, keep):
+        if self.connection is None:
+            self.connection = http.client.HTTPSConnection("127.0.0.1", self.port, context=self.context)
+        headers = {"Accept": "application/json"}
+        if authorization:
+            headers["Authorization"] = authorization
+        if uri in self.validators:
+            headers["If-None-Match"] = self.validators[uri]
+        self.connection.request(method, uri, body=b"" if method == "POST" else None, headers=headers)
+        response = self.connection.getresponse()
+        body = response.read()
+        self.received += len(body)
+        if response.status == 200 and response.getheader("ETag") and urllib.parse.urlsplit(uri).path in (FREE_DAYS_URI, FREE_SEASON_URI):
+            self.validators[uri] = response.getheader("ETag")
+        if not keep:
+            self.connection.close()
+            self.connection = None
+        return response.status, body
+
+    def close(self):
+        if self.connection is not None:
+            self.connection.close()
+            self.connection = None
+
+    def token(self, keep):
+        status, body = self.request("POST", TOKEN_URI, "Basic aWQ6c2VjcmV0", keep)
+        return json.loads(body)["access_token"] if status == 200 else None
+
+    def calendar(self, token, start, end, keep):
+        uri = "%s?start_date=%s&end_date=%s" % (CALENDAR_URI, urllib.parse.quote(start), urllib.parse.quote(end))
+        return self.request("GET", uri, "Bearer " + token, keep)
+
+    def replay(self, token, uri, keep):
+        return self.request("GET", uri, "Bearer " + token, keep)
+
+
+def rte_date(day):
+    return day.isoformat() + "T00:00:00+01:00"
+
+
+def bench(server, port, runs):
+    if server.recordings:
+        return bench_replay(server, port, runs)
+    today = datetime.date.today()
+    season = datetime.date(today.year if today.month >= 9 else today.year - 1, 9, 1)
+    tomorrow = today + datetime.timedelta(days=1)
+    after = today + datetime.timedelta(days=2)
+
+    def one_per_request(client, cached):
+        # La librairie : jeton puis une requête par plage, chacune sur sa connexion
+        token = client.token(False)
+        for start, end in ((today, tomorrow), (tomorrow, after), (season, tomorrow), (season, after)):
+            client.calendar(token, rte_date(start), rte_date(end), False)
+
+    def keep_alive(client, cached):
+        token = cached if cached else client.token(True)
+        client.calendar(token, rte_date(season), rte_date(after), True)
+        client.close()
+
+    season_label = "%d-%d" % (season.year, season.year + 1)
+
+    def free(client, conditional):
+        # Comme RteClient sans inscription : jours puis saison sur une connexion,
+        # avec les ETag du réveil précédent si conditional
+        if conditional:
+            client.validators = dict(free_validators)
+        for uri in (FREE_DAYS_URI, FREE_SEASON_URI + "?season=" + season_label):
+            client.request("GET", uri, None, True)
+        free_validators.update(client.validators)
+        client.close()
+
+    free_validators = {}
+    cached = Client(port).token(False)
+    scenarios = [
+        ("une connexion par requête", one_per_request, None),
+        ("keep-alive, nouveau jeton", keep_alive, None),
+        ("keep-alive, jeton en cache", keep_alive, cached),
+        ("sans inscription", free, False),
+        ("sans inscription, 304", free, True),
+    ]
+    print("%-28s %8s %10s %12s %10s" % ("scénario", "requêtes", "poignées", "ms/réveil", "octets"))
+    for name, scenario, argument in scenarios:
+        before = server.stats.snapshot()
+        received = 0
+        started = time.perf_counter()
+        for _ in range(runs):
+            client = Client(port)
+            scenario(client, argument)
+            received += client.received
+        elapsed = (time.perf_counter() - started) * 1000 / runs
+        after_stats = server.stats.snapshot()
+        print("%-28s %8.1f %10.1f %12.1f %10.0f" % (name, (after_stats[2] - before[2]) / runs,
+                                                    (after_stats[0] - before[0]) / runs, elapsed, received / runs))
+
+
+def bench_replay(server, port, runs):
+    """Requêtes de calendrier enregistrées, rejouées à l'identique sur une connexion gardée ouverte."""
+    recordings = server.recordings.get(("GET", CALENDAR_URI), [])
+    print("%-24s %8s %8s %10s %8s" % ("enregistrement", "octets", "statut", "ms", "échecs"))
+    for recording in recordings:
+        failures = 0
+        elapsed = 0.0
+        for _ in range(runs):
+            client = Client(port)
+            started = time.perf_counter()
+            try:
+                token = client.token(True)
+                status, body = client.replay(token, recording["uri"], True)
+                failures += status != recording["status"] or body != recording["body"]
+            except (http.client.HTTPException, OSError, TypeError, ValueError):
+                failures += 1
+            elapsed += time.perf_counter() - started
+            client.close()
+        print("%-24s %8d %8d %10.1f %8d" % (recording["name"], len(recording["body"]), recording["status"],
+                                             elapsed * 1000 / runs, failures))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=["serve", "bench", "capture"])
+    parser.add_argument("paths", nargs="*", help="capture : journal série et dossier des enregistrements")
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--rtt", type=float, default=40, help="latence aller-retour simulée en ms")
+    parser.add_argument("--publish-hour", type=int, default=7, help="heure de publication de demain")
+    parser.add_argument("--runs", type=int, default=10)
+    parser.add_argument("--replay", help="dossier d'échanges enregistrés à rejouer")
+    parser.add_argument("--fail-rate", type=float, default=0, help="part des requêtes en erreur")
+    parser.add_argument("--fail-code", type=int, default=503)
+    parser.add_argument("--truncate", type=float, default=0, help="part des réponses coupées")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--no-validators", action="store_true", help="réponses sans inscription sans ETag ni Last-Modified")
+    parser.add_argument("--free-delay", type=float, default=0, help="attente ajoutée aux réponses sans inscription, en ms")
+    parser.add_argument("--free-down", action="store_true", help="API sans inscription en erreur (--fail-code)")
+    args = parser.parse_args()
+
+    if args.mode == "capture":
+        if len(args.paths) != 2:
+            parser.error("capture attend le journal série et le dossier de sortie")
+        return capture(*args.paths)
+
+    with tempfile.TemporaryDirectory() as directory:
+        if args.mode == "serve":
+            server = start_server(args, True, directory)
+            print("API RTE simulée sur le port %d, Ctrl-C pour arrêter" % args.port)
+            try:
+                while True:
+                    time.sleep(60)
+                    handshakes, resumed, requests = server.stats.snapshot()
+                    print("%d connexions (%d reprises), %d requêtes dont %d non modifiées (304)" %
+                          (handshakes, resumed, requests, server.stats.not_modified))
+            except KeyboardInterrupt:
+                pass
+        else:
+            server = start_server(args, False, directory)
+            bench(server, args.port, args.runs)
+        server.shutdown()
+
+
+if __name__ == "__main__":
+    main()